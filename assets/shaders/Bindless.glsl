@@ -0,0 +1,22 @@
+#extension GL_EXT_nonuniform_qualifier : require
+
+// The bindless heap slots of the scene resources (see RayTracingPipeline::SceneSlots).
+layout(push_constant) uniform SceneSlotArray
+{
+	uint TextureBase;
+	uint MaterialBuffer;
+	uint TextureFrameOffset;
+	uint TextureResidencyBuffer;
+	uint TextureFeedbackBuffer;
+} SceneSlots;
+
+// The bindless heap (see BindlessHeap.hpp). Its storage buffer array is declared once per buffer content.
+layout(set = 1, binding = 0) uniform sampler2D TextureSamplers[];
+layout(set = 1, binding = 1) readonly buffer MaterialArray { Material Materials[]; } MaterialArrays[];
+layout(set = 1, binding = 1) readonly buffer ResidencyArray { uint ResidentLevels[]; } ResidencyArrays[];
+layout(set = 1, binding = 1) buffer FeedbackArray { uint RequestedLevels[]; } FeedbackArrays[];
+
+// The scene buffers, their slots being dynamically uniform. The geometry is reached through the hit records (see HitRecord.glsl).
+#define Materials MaterialArrays[SceneSlots.MaterialBuffer].Materials
+#define TextureResidentLevels ResidencyArrays[SceneSlots.TextureResidencyBuffer].ResidentLevels
+#define TextureRequestedLevels FeedbackArrays[SceneSlots.TextureFeedbackBuffer].RequestedLevels
@@ -0,0 +1,62 @@
+#extension GL_ARB_gpu_shader_int64 : require
+#extension GL_ARB_shader_clock : require
+
+// Per frame cost of the hit and intersection shaders, see Vulkan::RayTracing::CostBucket for the layout.
+// One bucket per material model, followed by one bucket per instance. Only touched when the ProfileCosts
+// specialization constant is set (see Specialization.glsl, which must be included first).
+struct CostBucket
+{
+	uint ClocksLow;
+	uint ClocksHigh;
+	uint Hits;
+	uint Intersections;
+};
+
+layout(binding = 11) buffer CostBucketArray { CostBucket[] CostBuckets; };
+
+const uint NumberOfMaterialModels = 5;
+
+// 64-bit accumulation out of 32-bit atomics, so that the modules do not require shaderBufferInt64Atomics.
+// The invocation whose addition wraps the low word carries into the high word.
+void AddClocks(const uint bucket, const uint64_t clocks)
+{
+	const uint low = uint(clocks);
+	const uint previous = atomicAdd(CostBuckets[bucket].ClocksLow, low);
+	const uint high = uint(clocks >> 32) + (previous + low < previous ? 1 : 0);
+
+	if (high != 0)
+	{
+		atomicAdd(CostBuckets[bucket].ClocksHigh, high);
+	}
+}
+
+uint64_t BeginCost()
+{
+	return ProfileCosts ? clockARB() : 0;
+}
+
+void AddHitCost(const uint64_t begin, const uint materialModel, const uint instance)
+{
+	if (ProfileCosts)
+	{
+		const uint64_t clocks = clockARB() - begin;
+
+		AddClocks(materialModel, clocks);
+		atomicAdd(CostBuckets[materialModel].Hits, 1);
+		AddClocks(NumberOfMaterialModels + instance, clocks);
+		atomicAdd(CostBuckets[NumberOfMaterialModels + instance].Hits, 1);
+	}
+}
+
+void AddIntersectionCost(const uint64_t begin, const uint materialModel, const uint instance)
+{
+	if (ProfileCosts)
+	{
+		const uint64_t clocks = clockARB() - begin;
+
+		AddClocks(materialModel, clocks);
+		atomicAdd(CostBuckets[materialModel].Intersections, 1);
+		AddClocks(NumberOfMaterialModels + instance, clocks);
+		atomicAdd(CostBuckets[NumberOfMaterialModels + instance].Intersections, 1);
+	}
+}
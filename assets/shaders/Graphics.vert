@@ -11,6 +11,8 @@ layout(location = 0) in vec3 InPosition;
 layout(location = 1) in vec3 InNormal;
 layout(location = 2) in vec2 InTexCoord;
 layout(location = 3) in int InMaterialIndex;
+layout(location = 4) in vec4 InInstanceCenterAndRadius;
+layout(location = 5) in int InInstanceMaterialIndex;
 
 layout(location = 0) out vec3 FragColor;
 layout(location = 1) out vec3 FragNormal;
@@ -24,11 +26,15 @@ out gl_PerVertex
 
 void main() 
 {
-	Material m = Materials[InMaterialIndex];
+	// Procedural primitives are drawn as instances of a unit proxy mesh, regular meshes use an identity instance.
+	const int materialIndex = InInstanceMaterialIndex >= 0 ? InInstanceMaterialIndex : InMaterialIndex;
+	const vec3 position = InInstanceCenterAndRadius.xyz + InInstanceCenterAndRadius.w * InPosition;
 
-    gl_Position = Camera.Projection * Camera.ModelView * vec4(InPosition, 1.0);
+	Material m = Materials[materialIndex];
+
+    gl_Position = Camera.Projection * Camera.ModelView * vec4(position, 1.0);
     FragColor = m.Diffuse.xyz;
 	FragNormal = vec3(Camera.ModelView * vec4(InNormal, 0.0)); // technically not correct, should be ModelInverseTranspose
 	FragTexCoord = InTexCoord;
-	FragMaterialIndex = InMaterialIndex;
+	FragMaterialIndex = materialIndex;
 }
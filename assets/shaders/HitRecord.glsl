@@ -0,0 +1,12 @@
+
+// The hit group record of the instance, see Vulkan::RayTracing::RayTracingPipeline::HitRecord for the layout.
+// Its material and geometry come along with the shader handle, so the hit shaders do not have to look them up.
+// Requires Material.glsl and Vertex.glsl.
+layout(shaderRecordEXT, std430) buffer HitRecordBuffer
+{
+	Material ModelMaterial; // The model material, unless PerVertexMaterials.
+	VertexArray Vertices;   // The model vertices and indices, for triangles only.
+	IndexArray Indices;
+	vec4 Sphere;            // The sphere center and radius, for procedurals only.
+	uint PerVertexMaterials;
+} HitRecord;
@@ -0,0 +1,32 @@
+#extension GL_KHR_shader_subgroup_arithmetic : require
+#extension GL_KHR_shader_subgroup_basic : require
+
+// Per frame ray statistics, see Vulkan::RayTracing::RayStatistics for the layout.
+// Only touched when the CountRays specialization constant is set.
+// Each counter is 64-bit, a low then a high word, as large frames overflow 32 bits.
+layout(binding = 10) buffer RayCounterArray { uint RayCounters[]; };
+
+const uint RayCounterPrimaryRays = 0;
+const uint RayCounterSecondaryRays = 1;
+const uint RayCounterIntersections = 2;
+const uint RayCounterMisses = 3;
+const uint RayCounterEmissions = 4;
+const uint RayCounterAbsorptions = 5;
+const uint RayCounterBounceLimits = 6;
+
+// Sum the value over the active invocations of the subgroup, a single atomic per subgroup then reaches memory.
+void AddRayCounter(const uint counter, const uint value)
+{
+	const uint total = subgroupAdd(value);
+
+	if (subgroupElect() && total != 0)
+	{
+		// The invocation whose addition wraps the low word carries into the high word (no 64-bit atomics required).
+		const uint previous = atomicAdd(RayCounters[2 * counter], total);
+
+		if (previous + total < previous)
+		{
+			atomicAdd(RayCounters[2 * counter + 1], 1);
+		}
+	}
+}
@@ -2,6 +2,6 @@
 struct RayPayload
 {
 	vec4 ColorAndDistance; // rgb + t
-	vec4 ScatterDirection; // xyz + w (is scatter needed)
+	vec4 ScatterDirection; // xyz + w (is scatter needed, negative when the path ends on a light)
 	uint RandomSeed;
 };
@@ -2,6 +2,8 @@
 
 #include "Random.glsl"
 #include "RayPayload.glsl"
+#include "Specialization.glsl"
+#include "TextureStreaming.glsl"
 
 // Polynomial approximation by Christophe Schlick
 float Schlick(const float cosine, const float refractionIndex)
@@ -12,10 +14,10 @@ float Schlick(const float cosine, const float refractionIndex)
 }
 
 // Lambertian
-RayPayload ScatterLambertian(const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord, const float t, inout uint seed)
+RayPayload ScatterLambertian(const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord, const float footprint, const float t, inout uint seed)
 {
 	const bool isScattered = dot(direction, normal) < 0;
-	const vec4 texColor = m.DiffuseTextureId >= 0 ? texture(TextureSamplers[nonuniformEXT(m.DiffuseTextureId)], texCoord) : vec4(1);
+	const vec4 texColor = HasTextures && m.DiffuseTextureId >= 0 ? SampleTexture(m.DiffuseTextureId, texCoord, footprint) : vec4(1);
 	const vec4 colorAndDistance = vec4(m.Diffuse.rgb * texColor.rgb, t);
 	const vec4 scatter = vec4(normal + RandomInUnitSphere(seed), isScattered ? 1 : 0);
 
@@ -23,12 +25,12 @@ RayPayload ScatterLambertian(const Material m, const vec3 direction, const vec3
 }
 
 // Metallic
-RayPayload ScatterMetallic(const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord, const float t, inout uint seed)
+RayPayload ScatterMetallic(const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord, const float footprint, const float t, inout uint seed)
 {
 	const vec3 reflected = reflect(direction, normal);
 	const bool isScattered = dot(reflected, normal) > 0;
 
-	const vec4 texColor = m.DiffuseTextureId >= 0 ? texture(TextureSamplers[nonuniformEXT(m.DiffuseTextureId)], texCoord) : vec4(1);
+	const vec4 texColor = HasTextures && m.DiffuseTextureId >= 0 ? SampleTexture(m.DiffuseTextureId, texCoord, footprint) : vec4(1);
 	const vec4 colorAndDistance = vec4(m.Diffuse.rgb * texColor.rgb, t);
 	const vec4 scatter = vec4(reflected + m.Fuzziness*RandomInUnitSphere(seed), isScattered ? 1 : 0);
 
@@ -36,7 +38,7 @@ RayPayload ScatterMetallic(const Material m, const vec3 direction, const vec3 no
 }
 
 // Dielectric
-RayPayload ScatterDieletric(const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord, const float t, inout uint seed)
+RayPayload ScatterDieletric(const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord, const float footprint, const float t, inout uint seed)
 {
 	const float dot = dot(direction, normal);
 	const vec3 outwardNormal = dot > 0 ? -normal : normal;
@@ -46,34 +48,47 @@ RayPayload ScatterDieletric(const Material m, const vec3 direction, const vec3 n
 	const vec3 refracted = refract(direction, outwardNormal, niOverNt);
 	const float reflectProb = refracted != vec3(0) ? Schlick(cosine, m.RefractionIndex) : 1;
 
-	const vec4 texColor = m.DiffuseTextureId >= 0 ? texture(TextureSamplers[nonuniformEXT(m.DiffuseTextureId)], texCoord) : vec4(1);
+	const vec4 texColor = HasTextures && m.DiffuseTextureId >= 0 ? SampleTexture(m.DiffuseTextureId, texCoord, footprint) : vec4(1);
 	
 	return RandomFloat(seed) < reflectProb
 		? RayPayload(vec4(texColor.rgb, t), vec4(reflect(direction, normal), 1), seed)
 		: RayPayload(vec4(texColor.rgb, t), vec4(refracted, 1), seed);
 }
 
+// Isotropic
+RayPayload ScatterIsotropic(const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord, const float footprint, const float t, inout uint seed)
+{
+	const vec4 texColor = HasTextures && m.DiffuseTextureId >= 0 ? SampleTexture(m.DiffuseTextureId, texCoord, footprint) : vec4(1);
+	const vec4 colorAndDistance = vec4(m.Diffuse.rgb * texColor.rgb, t);
+	const vec4 scatter = vec4(RandomInUnitSphere(seed), 1);
+
+	return RayPayload(colorAndDistance, scatter, seed);
+}
+
 // Diffuse Light
 RayPayload ScatterDiffuseLight(const Material m, const float t, inout uint seed)
 {
 	const vec4 colorAndDistance = vec4(m.Diffuse.rgb, t);
-	const vec4 scatter = vec4(1, 0, 0, 0);
+	const vec4 scatter = vec4(1, 0, 0, -1);
 
 	return RayPayload(colorAndDistance, scatter, seed);
 }
 
-RayPayload Scatter(const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord, const float t, inout uint seed)
+RayPayload Scatter(const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord, const float footprint, const float t, inout uint seed)
 {
 	const vec3 normDirection = normalize(direction);
 
-	switch (m.MaterialModel)
+	// Specialized hit groups only compile their own material model.
+	switch (HitGroupMaterialModel != MaterialModelAny ? HitGroupMaterialModel : m.MaterialModel)
 	{
 	case MaterialLambertian:
-		return ScatterLambertian(m, normDirection, normal, texCoord, t, seed);
+		return ScatterLambertian(m, normDirection, normal, texCoord, footprint, t, seed);
 	case MaterialMetallic:
-		return ScatterMetallic(m, normDirection, normal, texCoord, t, seed);
+		return ScatterMetallic(m, normDirection, normal, texCoord, footprint, t, seed);
 	case MaterialDielectric:
-		return ScatterDieletric(m, normDirection, normal, texCoord, t, seed);
+		return ScatterDieletric(m, normDirection, normal, texCoord, footprint, t, seed);
+	case MaterialIsotropic:
+		return ScatterIsotropic(m, normDirection, normal, texCoord, footprint, t, seed);
 	case MaterialDiffuseLight:
 		return ScatterDiffuseLight(m, t, seed);
 	}
@@ -0,0 +1,14 @@
+
+// Features baked into the ray tracing pipeline, see Vulkan::RayTracing::ShaderVariant.
+// Disabled features are compiled out by the driver instead of being tested at runtime.
+layout(constant_id = 0) const bool ShowHeatmap = false;
+layout(constant_id = 1) const bool HasSky = true;
+layout(constant_id = 2) const bool HasTextures = true;
+layout(constant_id = 3) const uint NumberOfBounces = 10;
+layout(constant_id = 4) const bool CountRays = false;
+layout(constant_id = 5) const bool ProfileCosts = false;
+
+// The material model the closest-hit shader is specialized for, there is one hit group per material model
+// (see Vulkan::RayTracing::RayTracingPipeline). MaterialModelAny switches on the hit material instead.
+const uint MaterialModelAny = 0xffffffffu;
+layout(constant_id = 6) const uint HitGroupMaterialModel = 0xffffffffu;
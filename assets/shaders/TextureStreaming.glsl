@@ -0,0 +1,40 @@
+
+// Texture streaming (see Assets::TextureStreamer). The hit shaders estimate the level of detail of each lookup from the
+// ray footprint, record the finest level requested per texture, and clamp the lookup to the resident levels.
+// Requires Bindless.glsl and the camera uniform buffer.
+
+// The requested levels are stored as MaxTextureLevels - level, so that zero means none.
+const uint MaxTextureLevels = 16;
+
+// The ray cone spread angle of a pixel (see "Texture Level of Detail Strategies for Real-Time Ray Tracing", Akenine-Moller et al. 2019).
+float PixelSpreadAngle()
+{
+	return atan(2.0 / (abs(Camera.Projection[1][1]) * float(Camera.ImageHeight)));
+}
+
+// The width of the ray cone at the hit, projected onto the surface. Only the last segment of the path is accounted for.
+float RayConeWidth(const float t, const vec3 direction, const vec3 normal)
+{
+	return t * PixelSpreadAngle() / max(abs(dot(normalize(direction), normal)), 0.25);
+}
+
+// Sample a texture over the given footprint (in texture coordinates units).
+vec4 SampleTexture(const int textureId, const vec2 texCoord, const float footprint)
+{
+	const uint index = SceneSlots.TextureFrameOffset + uint(textureId);
+	const uint slot = SceneSlots.TextureBase + uint(textureId);
+	const uint residentLevel = TextureResidentLevels[index];
+
+	// The resident image starts at the resident level, scale it back to the full texture size.
+	const vec2 size = vec2(textureSize(TextureSamplers[nonuniformEXT(slot)], 0) << residentLevel);
+	const float lod = max(log2(footprint * sqrt(size.x * size.y)), 0.0);
+	const uint request = MaxTextureLevels - min(uint(lod), MaxTextureLevels - 1);
+
+	// Most lookups request no finer level than already recorded, skip their atomics.
+	if (TextureRequestedLevels[index] < request)
+	{
+		atomicMax(TextureRequestedLevels[index], request);
+	}
+
+	return textureLod(TextureSamplers[nonuniformEXT(slot)], texCoord, max(lod - float(residentLevel), 0.0));
+}
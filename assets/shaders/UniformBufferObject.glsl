@@ -5,6 +5,8 @@ struct UniformBufferObject
 	mat4 Projection;
 	mat4 ModelViewInverse;
 	mat4 ProjectionInverse;
+	mat4 PreviousModelView;
+	mat4 PreviousProjection;
 	float Aperture;
 	float FocusDistance;
 	float HeatmapScale;
@@ -12,6 +14,13 @@ struct UniformBufferObject
 	uint NumberOfSamples;
 	uint NumberOfBounces;
 	uint RandomSeed;
-	bool HasSky;
-	bool ShowHeatmap;
+
+	uint TileOffsetX;
+	uint TileOffsetY;
+	uint ImageWidth;
+	uint ImageHeight;
+
+	uint InterleaveMode;
+	uint InterleaveFrame;
+	uint HistoryIndex;
 };
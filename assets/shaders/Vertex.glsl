@@ -1,3 +1,4 @@
+#extension GL_EXT_buffer_reference : require
 
 struct Vertex
 {
@@ -7,17 +8,21 @@ struct Vertex
   int MaterialIndex;
 };
 
-Vertex UnpackVertex(uint index)
+// The vertices and indices of a model, through their device addresses (see HitRecord.glsl).
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer VertexArray { float Vertices[]; };
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer IndexArray { uint Indices[]; };
+
+Vertex UnpackVertex(const VertexArray vertices, const uint index)
 {
 	const uint vertexSize = 9;
 	const uint offset = index * vertexSize;
 	
 	Vertex v;
 	
-	v.Position = vec3(Vertices[offset + 0], Vertices[offset + 1], Vertices[offset + 2]);
-	v.Normal = vec3(Vertices[offset + 3], Vertices[offset + 4], Vertices[offset + 5]);
-	v.TexCoord = vec2(Vertices[offset + 6], Vertices[offset + 7]);
-	v.MaterialIndex = floatBitsToInt(Vertices[offset + 8]);
+	v.Position = vec3(vertices.Vertices[offset + 0], vertices.Vertices[offset + 1], vertices.Vertices[offset + 2]);
+	v.Normal = vec3(vertices.Vertices[offset + 3], vertices.Vertices[offset + 4], vertices.Vertices[offset + 5]);
+	v.TexCoord = vec2(vertices.Vertices[offset + 6], vertices.Vertices[offset + 7]);
+	v.MaterialIndex = floatBitsToInt(vertices.Vertices[offset + 8]);
 
 	return v;
 }
@@ -41,6 +41,8 @@ namespace Assets
 			DiffuseLight = 4
 		};
 
+		static constexpr uint32_t NumberOfModels = 5;
+
 		// Note: vec3 and vec4 gets aligned on 16 bytes in Vulkan shaders. 
 
 		// Base material
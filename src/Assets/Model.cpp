@@ -2,12 +2,12 @@
 #include "CornellBox.hpp"
 #include "Procedural.hpp"
 #include "Sphere.hpp"
+#include "VertexHash.hpp"
 #include "Utilities/Exception.hpp"
 #include "Utilities/Console.hpp"
+#include "Utilities/Tracer.hpp"
 
-#define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/matrix_inverse.hpp>
-#include <glm/gtx/hash.hpp>
 
 #include <tiny_obj_loader.h>
 #include <chrono>
@@ -18,32 +18,12 @@
 
 using namespace glm;
 
-namespace std
-{
-	template<> struct hash<Assets::Vertex> final
-	{
-		size_t operator()(Assets::Vertex const& vertex) const noexcept
-		{
-			return
-				Combine(hash<vec3>()(vertex.Position),
-					Combine(hash<vec3>()(vertex.Normal),
-						Combine(hash<vec2>()(vertex.TexCoord),
-							hash<int>()(vertex.MaterialIndex))));
-		}
-
-	private:
-
-		static size_t Combine(size_t hash0, size_t hash1)
-		{
-			return hash0 ^ (hash1 + 0x9e3779b9 + (hash0 << 6) + (hash0 >> 2));
-		}
-	};
-}
-
 namespace Assets {
 
 Model Model::LoadModel(const std::string& filename)
 {
+	Utilities::Tracer::Zone zone("Model::LoadModel", filename);
+
 	std::cout << "- loading '" << filename << "'... " << std::flush;
 
 	const auto timer = std::chrono::high_resolution_clock::now();
@@ -243,6 +223,17 @@ Model Model::CreateBox(const vec3& p0, const vec3& p1, const Material& material)
 
 Model Model::CreateSphere(const vec3& center, float radius, const Material& material, const bool isProcedural)
 {
+	// Procedural spheres are intersected analytically by the ray tracer, there is no need for triangles.
+	// The rasterizer draws them using a shared unit sphere proxy instead (see Scene::CreateRasterProxy()).
+	if (isProcedural)
+	{
+		return Model(
+			std::vector<Vertex>(),
+			std::vector<uint32_t>(),
+			std::vector<Material>{material},
+			new Sphere(center, radius));
+	}
+
 	const int slices = 32;
 	const int stacks = 16;
 	
@@ -308,7 +299,7 @@ Model Model::CreateSphere(const vec3& center, float radius, const Material& mate
 		std::move(vertices),
 		std::move(indices),
 		std::vector<Material>{material},
-		isProcedural ? new Sphere(center, radius) : nullptr);
+		nullptr);
 }
 
 void Model::SetMaterial(const Material& material)
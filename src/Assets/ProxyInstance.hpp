@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Utilities/Glm.hpp"
+
+namespace Assets
+{
+
+	// Per-instance data used by the rasterizer to draw procedural primitives using a shared proxy mesh.
+	struct ProxyInstance final
+	{
+		glm::vec4 CenterAndRadius;
+		int32_t MaterialIndex; // Overrides the vertex material index when not negative.
+	};
+
+}
@@ -1,75 +1,84 @@
 #include "Scene.hpp"
 #include "Model.hpp"
-#include "Sphere.hpp"
+#include "SceneGeometry.hpp"
 #include "Texture.hpp"
 #include "TextureImage.hpp"
 #include "Vulkan/BufferUtil.hpp"
+#include "Vulkan/CommandQueue.hpp"
 #include "Vulkan/ImageView.hpp"
+#include "Vulkan/QueueOwnership.hpp"
 #include "Vulkan/Sampler.hpp"
 #include "Utilities/Exception.hpp"
-#include "Vulkan/SingleTimeCommands.hpp"
-
+#include <algorithm>
+#include <chrono>
+#include <iostream>
 
 namespace Assets {
 
-Scene::Scene(Vulkan::CommandPool& commandPool, std::vector<Model>&& models, std::vector<Texture>&& textures) :
+namespace
+{
+	// Everything reading the scene buffers on the graphics queue, be it rasterizing or ray tracing.
+	const VkPipelineStageFlags GraphicsStages =
+		VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+		VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+		VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
+
+	const VkAccessFlags GraphicsAccesses =
+		VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+		VK_ACCESS_INDEX_READ_BIT |
+		VK_ACCESS_SHADER_READ_BIT;
+
+	// The AABBs are uploaded as is as the acceleration structure build input.
+	static_assert(sizeof(Aabb) == sizeof(VkAabbPositionsKHR), "Aabb must match the VkAabbPositionsKHR layout");
+}
+
+Scene::Scene(
+	Vulkan::CommandQueue& transferQueue, const uint32_t buildQueueFamilyIndex, const uint32_t graphicsQueueFamilyIndex,
+	std::vector<Model>&& models, std::vector<Texture>&& textures) :
 	models_(std::move(models)),
-	textures_(std::move(textures))
+	textures_(std::move(textures)),
+	transferQueueFamilyIndex_(transferQueue.FamilyIndex()),
+	buildQueueFamilyIndex_(buildQueueFamilyIndex),
+	graphicsQueueFamilyIndex_(graphicsQueueFamilyIndex)
 {
+	std::cout << "- uploading scene... " << std::flush;
+	const auto timer = std::chrono::high_resolution_clock::now();
+
 	// Concatenate all the models
-	std::vector<Vertex> vertices;
-	std::vector<uint32_t> indices;
-	std::vector<Material> materials;
-	std::vector<glm::vec4> procedurals;
-	std::vector<VkAabbPositionsKHR> aabbs;
-	std::vector<glm::uvec2> offsets;
-
-	for (const auto& model : models_)
+	auto geometry = SceneGeometry::Concatenate(models_);
+	auto& vertices = geometry.Vertices;
+	auto& indices = geometry.Indices;
+	const auto& materials = geometry.Materials;
+	const auto& aabbs = geometry.Aabbs;
+
+	offsets_ = std::move(geometry.Offsets);
+	procedurals_ = std::move(geometry.Procedurals);
+	proxyInstances_ = std::move(geometry.ProxyInstances);
+
+	// Materials may not use any texture, even though there is always at least one (see SceneLoader::Load()).
+	hasTextures_ = std::any_of(materials.begin(), materials.end(), [](const Material& material) { return material.DiffuseTextureId >= 0; });
+
+	// Procedural models have no triangles. Vulkan does not allow empty buffers, so make sure there is always something to upload.
+	if (vertices.empty())
 	{
-		// Remember the index, vertex offsets.
-		const auto indexOffset = static_cast<uint32_t>(indices.size());
-		const auto vertexOffset = static_cast<uint32_t>(vertices.size());
-		const auto materialOffset = static_cast<uint32_t>(materials.size());
-
-		offsets.emplace_back(indexOffset, vertexOffset);
-
-		// Copy model data one after the other.
-		vertices.insert(vertices.end(), model.Vertices().begin(), model.Vertices().end());
-		indices.insert(indices.end(), model.Indices().begin(), model.Indices().end());
-		materials.insert(materials.end(), model.Materials().begin(), model.Materials().end());
-
-		// Adjust the material id.
-		for (size_t i = vertexOffset; i != vertices.size(); ++i)
-		{
-			vertices[i].MaterialIndex += materialOffset;
-		}
-
-		// Add optional procedurals.
-		const auto* const sphere = dynamic_cast<const Sphere*>(model.Procedural());
-		if (sphere != nullptr)
-		{
-			const auto aabb = sphere->BoundingBox();
-			aabbs.push_back({aabb.first.x, aabb.first.y, aabb.first.z, aabb.second.x, aabb.second.y, aabb.second.z});
-			procedurals.emplace_back(sphere->Center, sphere->Radius);
-		}
-		else
-		{
-			aabbs.emplace_back();
-			procedurals.emplace_back();
-		}
+		vertices.emplace_back();
+	}
+
+	if (indices.empty())
+	{
+		indices.resize(3, 0);
 	}
 
 	constexpr auto flags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
 
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Vertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags, vertices, vertexBuffer_, vertexBufferMemory_);
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Indices", VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags, indices, indexBuffer_, indexBufferMemory_);
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Materials", flags, materials, materialBuffer_, materialBufferMemory_);
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Offsets", flags, offsets, offsetBuffer_, offsetBufferMemory_);
+	// The build inputs go first, so that the acceleration structure builds can start while the rest is uploading.
+	Vulkan::BufferUtil::CreateDeviceBuffer(transferQueue, buildQueueFamilyIndex_, "Vertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags, vertices, vertexBuffer_, vertexBufferMemory_);
+	Vulkan::BufferUtil::CreateDeviceBuffer(transferQueue, buildQueueFamilyIndex_, "Indices", VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags, indices, indexBuffer_, indexBufferMemory_);
+	buildInputsUploaded_ = Vulkan::BufferUtil::CreateDeviceBuffer(transferQueue, buildQueueFamilyIndex_, "AABBs", VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags, aabbs, aabbBuffer_, aabbBufferMemory_);
 
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "AABBs", VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags, aabbs, aabbBuffer_, aabbBufferMemory_);
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Procedurals", flags, procedurals, proceduralBuffer_, proceduralBufferMemory_);
+	Vulkan::BufferUtil::CreateDeviceBuffer(transferQueue, graphicsQueueFamilyIndex_, "Materials", flags, materials, materialBuffer_, materialBufferMemory_);
 
-	
 	// Upload all textures
 	textureImages_.reserve(textures_.size());
 	textureImageViewHandles_.resize(textures_.size());
@@ -77,23 +86,37 @@ Scene::Scene(Vulkan::CommandPool& commandPool, std::vector<Model>&& models, std:
 
 	for (size_t i = 0; i != textures_.size(); ++i)
 	{
-	   textureImages_.emplace_back(new TextureImage(commandPool, textures_[i]));
+	   textureImages_.emplace_back(new TextureImage(transferQueue, graphicsQueueFamilyIndex_, textures_[i]));
 	   textureImageViewHandles_[i] = textureImages_[i]->ImageView().Handle();
 	   textureSamplerHandles_[i] = textureImages_[i]->Sampler().Handle();
 	}
+
+	uploaded_ = transferQueue.LastSubmitted();
+
+	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+	const auto bufferSize = 
+		sizeof(vertices[0]) * vertices.size() + 
+		sizeof(indices[0]) * indices.size() + 
+		sizeof(materials[0]) * materials.size() + 
+		sizeof(aabbs[0]) * aabbs.size();
+
+	std::cout << "(" << vertices.size() << " vertices, " << indices.size() / 3 << " triangles, " << proxyInstances_.size() << " procedurals, ";
+	std::cout << bufferSize / 1024 << " KB) " << elapsed << "s" << std::endl;
 }
 
 Scene::~Scene()
 {
+	proxyInstanceBuffer_.reset();
+	proxyInstanceBufferMemory_.reset(); // release memory after bound buffer has been destroyed
+	proxyIndexBuffer_.reset();
+	proxyIndexBufferMemory_.reset(); // release memory after bound buffer has been destroyed
+	proxyVertexBuffer_.reset();
+	proxyVertexBufferMemory_.reset(); // release memory after bound buffer has been destroyed
 	textureSamplerHandles_.clear();
 	textureImageViewHandles_.clear();
 	textureImages_.clear();
-	proceduralBuffer_.reset();
-	proceduralBufferMemory_.reset(); // release memory after bound buffer has been destroyed
 	aabbBuffer_.reset();
 	aabbBufferMemory_.reset(); // release memory after bound buffer has been destroyed
-	offsetBuffer_.reset();
-	offsetBufferMemory_.reset(); // release memory after bound buffer has been destroyed
 	materialBuffer_.reset();
 	materialBufferMemory_.reset(); // release memory after bound buffer has been destroyed
 	indexBuffer_.reset();
@@ -102,4 +125,55 @@ Scene::~Scene()
 	vertexBufferMemory_.reset(); // release memory after bound buffer has been destroyed
 }
 
+void Scene::AcquireBuildInputs(VkCommandBuffer commandBuffer) const
+{
+	for (const auto* buffer : { vertexBuffer_.get(), indexBuffer_.get(), aabbBuffer_.get() })
+	{
+		Vulkan::QueueOwnership::AcquireBuffer(commandBuffer, buffer->Handle(), transferQueueFamilyIndex_, buildQueueFamilyIndex_,
+			VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_ACCESS_SHADER_READ_BIT);
+	}
+}
+
+void Scene::ReleaseBuildInputs(VkCommandBuffer commandBuffer) const
+{
+	for (const auto* buffer : { vertexBuffer_.get(), indexBuffer_.get(), aabbBuffer_.get() })
+	{
+		Vulkan::QueueOwnership::ReleaseBuffer(commandBuffer, buffer->Handle(), buildQueueFamilyIndex_, graphicsQueueFamilyIndex_,
+			VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0);
+	}
+}
+
+void Scene::Acquire(VkCommandBuffer commandBuffer) const
+{
+	for (const auto* buffer : { vertexBuffer_.get(), indexBuffer_.get(), aabbBuffer_.get() })
+	{
+		Vulkan::QueueOwnership::AcquireBuffer(commandBuffer, buffer->Handle(), buildQueueFamilyIndex_, graphicsQueueFamilyIndex_, GraphicsStages, GraphicsAccesses);
+	}
+
+	Vulkan::QueueOwnership::AcquireBuffer(commandBuffer, materialBuffer_->Handle(), transferQueueFamilyIndex_, graphicsQueueFamilyIndex_, GraphicsStages, GraphicsAccesses);
+
+	for (const auto& textureImage : textureImages_)
+	{
+		textureImage->Acquire(commandBuffer);
+	}
+}
+
+void Scene::CreateRasterProxy(Vulkan::CommandPool& commandPool)
+{
+	// All procedural spheres share the same unit sphere mesh, scaled and offset by their instance data.
+	// The first instance is an identity transform used when drawing regular meshes.
+	const auto unitSphere = Model::CreateSphere(glm::vec3(0), 1.0f, Material::Lambertian(glm::vec3(1)), false);
+
+	std::vector<ProxyInstance> instances;
+	instances.reserve(proxyInstances_.size() + 1);
+	instances.push_back({glm::vec4(0, 0, 0, 1), -1});
+	instances.insert(instances.end(), proxyInstances_.begin(), proxyInstances_.end());
+
+	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "ProxyVertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, unitSphere.Vertices(), proxyVertexBuffer_, proxyVertexBufferMemory_);
+	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "ProxyIndices", VK_BUFFER_USAGE_INDEX_BUFFER_BIT, unitSphere.Indices(), proxyIndexBuffer_, proxyIndexBufferMemory_);
+	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "ProxyInstances", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, instances, proxyInstanceBuffer_, proxyInstanceBufferMemory_);
+
+	proxyIndexCount_ = unitSphere.NumberOfIndices();
+}
+
 }
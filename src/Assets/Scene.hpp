@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ProxyInstance.hpp"
 #include "Vulkan/Vulkan.hpp"
 #include <memory>
 #include <vector>
@@ -8,6 +9,7 @@ namespace Vulkan
 {
 	class Buffer;
 	class CommandPool;
+	class CommandQueue;
 	class DeviceMemory;
 	class Image;
 }
@@ -27,25 +29,63 @@ namespace Assets
 		Scene& operator = (const Scene&) = delete;
 		Scene& operator = (Scene&&) = delete;
 
-		Scene(Vulkan::CommandPool& commandPool, std::vector<Model>&& models, std::vector<Texture>&& textures);
+		// The resources are uploaded on the transfer queue without waiting for it. The acceleration structure build inputs
+		// (vertices, indices and AABBs) are handed over to the build queue family, then to the graphics one once built
+		// (see AcquireBuildInputs() and ReleaseBuildInputs()), the other resources go straight to the graphics family.
+		Scene(
+			Vulkan::CommandQueue& transferQueue, uint32_t buildQueueFamilyIndex, uint32_t graphicsQueueFamilyIndex,
+			std::vector<Model>&& models, std::vector<Texture>&& textures);
 		~Scene();
 
+		// Transfer queue timeline values once the build inputs, then all the resources, are uploaded.
+		uint64_t BuildInputsUploaded() const { return buildInputsUploaded_; }
+		uint64_t Uploaded() const { return uploaded_; }
+
+		// Complete the ownership transfers, on the build queue then on the graphics queue.
+		void AcquireBuildInputs(VkCommandBuffer commandBuffer) const;
+		void ReleaseBuildInputs(VkCommandBuffer commandBuffer) const;
+		void Acquire(VkCommandBuffer commandBuffer) const;
+
 		const std::vector<Model>& Models() const { return models_; }
-		bool HasProcedurals() const { return static_cast<bool>(proceduralBuffer_); }
+		const std::vector<Texture>& Textures() const { return textures_; }
+		bool HasTextures() const { return hasTextures_; }
+
+		// Per model, the (index, vertex, material) offsets into the scene buffers and the procedural sphere (center, radius).
+		// Only kept on the host, the ray tracer embeds them in its shader binding table.
+		const std::vector<glm::uvec4>& Offsets() const { return offsets_; }
+		const std::vector<glm::vec4>& Procedurals() const { return procedurals_; }
 
 		const Vulkan::Buffer& VertexBuffer() const { return *vertexBuffer_; }
 		const Vulkan::Buffer& IndexBuffer() const { return *indexBuffer_; }
 		const Vulkan::Buffer& MaterialBuffer() const { return *materialBuffer_; }
-		const Vulkan::Buffer& OffsetsBuffer() const { return *offsetBuffer_; }
 		const Vulkan::Buffer& AabbBuffer() const { return *aabbBuffer_; }
-		const Vulkan::Buffer& ProceduralBuffer() const { return *proceduralBuffer_; }
 		const std::vector<VkImageView> TextureImageViews() const { return textureImageViewHandles_; }
 		const std::vector<VkSampler> TextureSamplers() const { return textureSamplerHandles_; }
 
+		// Procedural primitives are not tessellated, the rasterizer uses an instanced proxy mesh instead.
+		// It is only created on demand, as the ray tracer does not need it.
+		bool HasRasterProxy() const { return static_cast<bool>(proxyInstanceBuffer_); }
+		void CreateRasterProxy(Vulkan::CommandPool& commandPool);
+
+		const Vulkan::Buffer& ProxyVertexBuffer() const { return *proxyVertexBuffer_; }
+		const Vulkan::Buffer& ProxyIndexBuffer() const { return *proxyIndexBuffer_; }
+		const Vulkan::Buffer& ProxyInstanceBuffer() const { return *proxyInstanceBuffer_; }
+		uint32_t ProxyIndexCount() const { return proxyIndexCount_; }
+		uint32_t ProxyInstanceCount() const { return static_cast<uint32_t>(proxyInstances_.size()); }
+
 	private:
 
 		const std::vector<Model> models_;
 		const std::vector<Texture> textures_;
+		std::vector<glm::uvec4> offsets_;
+		std::vector<glm::vec4> procedurals_;
+		bool hasTextures_{};
+
+		const uint32_t transferQueueFamilyIndex_;
+		const uint32_t buildQueueFamilyIndex_;
+		const uint32_t graphicsQueueFamilyIndex_;
+		uint64_t buildInputsUploaded_{};
+		uint64_t uploaded_{};
 
 		std::unique_ptr<Vulkan::Buffer> vertexBuffer_;
 		std::unique_ptr<Vulkan::DeviceMemory> vertexBufferMemory_;
@@ -56,18 +96,24 @@ namespace Assets
 		std::unique_ptr<Vulkan::Buffer> materialBuffer_;
 		std::unique_ptr<Vulkan::DeviceMemory> materialBufferMemory_;
 
-		std::unique_ptr<Vulkan::Buffer> offsetBuffer_;
-		std::unique_ptr<Vulkan::DeviceMemory> offsetBufferMemory_;
-
 		std::unique_ptr<Vulkan::Buffer> aabbBuffer_;
 		std::unique_ptr<Vulkan::DeviceMemory> aabbBufferMemory_;
 
-		std::unique_ptr<Vulkan::Buffer> proceduralBuffer_;
-		std::unique_ptr<Vulkan::DeviceMemory> proceduralBufferMemory_;
-
 		std::vector<std::unique_ptr<TextureImage>> textureImages_;
 		std::vector<VkImageView> textureImageViewHandles_;
 		std::vector<VkSampler> textureSamplerHandles_;
+
+		std::vector<ProxyInstance> proxyInstances_;
+		uint32_t proxyIndexCount_{};
+
+		std::unique_ptr<Vulkan::Buffer> proxyVertexBuffer_;
+		std::unique_ptr<Vulkan::DeviceMemory> proxyVertexBufferMemory_;
+
+		std::unique_ptr<Vulkan::Buffer> proxyIndexBuffer_;
+		std::unique_ptr<Vulkan::DeviceMemory> proxyIndexBufferMemory_;
+
+		std::unique_ptr<Vulkan::Buffer> proxyInstanceBuffer_;
+		std::unique_ptr<Vulkan::DeviceMemory> proxyInstanceBufferMemory_;
 	};
 
 }
@@ -0,0 +1,69 @@
+#include "SceneGeometry.hpp"
+#include "Model.hpp"
+#include "Sphere.hpp"
+
+namespace Assets {
+
+SceneGeometry SceneGeometry::Concatenate(const std::vector<Model>& models)
+{
+	SceneGeometry geometry;
+
+	// Size everything upfront, scenes can have millions of vertices.
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	size_t materialCount = 0;
+
+	for (const auto& model : models)
+	{
+		vertexCount += model.Vertices().size();
+		indexCount += model.Indices().size();
+		materialCount += model.Materials().size();
+	}
+
+	geometry.Vertices.reserve(vertexCount);
+	geometry.Indices.reserve(indexCount);
+	geometry.Materials.reserve(materialCount);
+	geometry.Procedurals.reserve(models.size());
+	geometry.Aabbs.reserve(models.size());
+	geometry.Offsets.reserve(models.size());
+
+	for (const auto& model : models)
+	{
+		// Remember the index, vertex and material offsets.
+		const auto indexOffset = static_cast<uint32_t>(geometry.Indices.size());
+		const auto vertexOffset = static_cast<uint32_t>(geometry.Vertices.size());
+		const auto materialOffset = static_cast<uint32_t>(geometry.Materials.size());
+
+		geometry.Offsets.emplace_back(indexOffset, vertexOffset, materialOffset, 0);
+
+		// Copy model data one after the other.
+		geometry.Vertices.insert(geometry.Vertices.end(), model.Vertices().begin(), model.Vertices().end());
+		geometry.Indices.insert(geometry.Indices.end(), model.Indices().begin(), model.Indices().end());
+		geometry.Materials.insert(geometry.Materials.end(), model.Materials().begin(), model.Materials().end());
+
+		// Adjust the material id.
+		for (size_t i = vertexOffset; i != geometry.Vertices.size(); ++i)
+		{
+			geometry.Vertices[i].MaterialIndex += materialOffset;
+		}
+
+		// Add optional procedurals.
+		const auto* const sphere = dynamic_cast<const Sphere*>(model.Procedural());
+		if (sphere != nullptr)
+		{
+			const auto aabb = sphere->BoundingBox();
+			geometry.Aabbs.push_back({aabb.first.x, aabb.first.y, aabb.first.z, aabb.second.x, aabb.second.y, aabb.second.z});
+			geometry.Procedurals.emplace_back(sphere->Center, sphere->Radius);
+			geometry.ProxyInstances.push_back({glm::vec4(sphere->Center, sphere->Radius), static_cast<int32_t>(materialOffset)});
+		}
+		else
+		{
+			geometry.Aabbs.emplace_back();
+			geometry.Procedurals.emplace_back();
+		}
+	}
+
+	return geometry;
+}
+
+}
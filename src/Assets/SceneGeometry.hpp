@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Material.hpp"
+#include "ProxyInstance.hpp"
+#include "Vertex.hpp"
+#include <vector>
+
+namespace Assets
+{
+	class Model;
+
+	// Same layout as VkAabbPositionsKHR, kept Vulkan-free so that the CPU benchmarks build without the Vulkan SDK.
+	struct Aabb final
+	{
+		float MinX, MinY, MinZ;
+		float MaxX, MaxY, MaxZ;
+	};
+
+	// The models of a scene concatenated into the flat arrays uploaded to the GPU by Scene.
+	// Kept separate from Scene so that it can be built (and benchmarked) without a Vulkan device.
+	struct SceneGeometry final
+	{
+		std::vector<Vertex> Vertices;
+		std::vector<uint32_t> Indices;
+		std::vector<Material> Materials;
+		std::vector<glm::vec4> Procedurals;
+		std::vector<Aabb> Aabbs;
+		std::vector<glm::uvec4> Offsets;
+		std::vector<ProxyInstance> ProxyInstances;
+
+		// Concatenate all the models, offsetting the vertex material indices into the scene material array.
+		static SceneGeometry Concatenate(const std::vector<Model>& models);
+	};
+
+}
@@ -1,38 +1,284 @@
 #include "Texture.hpp"
 #include "Utilities/StbImage.hpp"
 #include "Utilities/Exception.hpp"
+#include "Utilities/Tracer.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <sstream>
 
 namespace Assets {
 
+namespace
+{
+	// The levels no larger than this stay in memory.
+	const uint32_t MaxTailSize = 256;
+
+	// The cooked file is this header followed by the levels, finest first.
+	struct CookedHeader final
+	{
+		char Magic[4];
+		uint32_t Version;
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t MipLevels;
+	};
+
+	const char CookedMagic[4] = { 'R', 'T', 'M', 'C' };
+	const uint32_t CookedVersion = 1;
+
+	uint32_t LevelSize(const uint32_t size, const uint32_t level)
+	{
+		return std::max(size >> level, 1u);
+	}
+
+	uint64_t LevelBytes(const uint32_t width, const uint32_t height, const uint32_t level)
+	{
+		return static_cast<uint64_t>(LevelSize(width, level)) * LevelSize(height, level) * 4;
+	}
+
+	uint64_t LevelOffset(const uint32_t width, const uint32_t height, const uint32_t level)
+	{
+		uint64_t offset = sizeof(CookedHeader);
+
+		for (uint32_t i = 0; i != level; ++i)
+		{
+			offset += LevelBytes(width, height, i);
+		}
+
+		return offset;
+	}
+
+	// In the temporary directory, named after the image and a hash of its full path.
+	std::string CookedFilename(const std::string& filename)
+	{
+		const auto path = std::filesystem::absolute(filename);
+		const auto directory = std::filesystem::temp_directory_path() / "RayTracingInVulkan";
+
+		std::filesystem::create_directories(directory);
+
+		std::ostringstream name;
+		name << path.stem().string() << '-' << std::hex << std::hash<std::string>()(path.string()) << ".mips";
+
+		return (directory / name.str()).string();
+	}
+
+	bool IsCooked(const std::string& filename, const std::string& cookedFilename)
+	{
+		std::error_code error;
+		const auto imageTime = std::filesystem::last_write_time(filename, error);
+
+		if (error)
+		{
+			return false;
+		}
+
+		const auto cookedTime = std::filesystem::last_write_time(cookedFilename, error);
+
+		return !error && cookedTime >= imageTime;
+	}
+
+	// 2x2 box filter, the last row and column being repeated for odd sizes.
+	Texture::MipLevel Downsample(const Texture::MipLevel& source)
+	{
+		Texture::MipLevel level{ std::max(source.Width / 2, 1u), std::max(source.Height / 2, 1u), {} };
+		level.Pixels.resize(static_cast<size_t>(level.Width) * level.Height * 4);
+
+		for (uint32_t y = 0; y != level.Height; ++y)
+		{
+			const uint32_t y0 = std::min(2 * y, source.Height - 1);
+			const uint32_t y1 = std::min(2 * y + 1, source.Height - 1);
+
+			for (uint32_t x = 0; x != level.Width; ++x)
+			{
+				const uint32_t x0 = std::min(2 * x, source.Width - 1);
+				const uint32_t x1 = std::min(2 * x + 1, source.Width - 1);
+
+				for (uint32_t c = 0; c != 4; ++c)
+				{
+					const auto texel = [&](const uint32_t sx, const uint32_t sy) { return source.Pixels[(static_cast<size_t>(sy) * source.Width + sx) * 4 + c]; };
+					const uint32_t sum = texel(x0, y0) + texel(x1, y0) + texel(x0, y1) + texel(x1, y1);
+
+					level.Pixels[(static_cast<size_t>(y) * level.Width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+				}
+			}
+		}
+
+		return level;
+	}
+
+	void Cook(const std::string& filename, const std::string& cookedFilename)
+	{
+		Utilities::Tracer::Zone zone("Texture::Cook", filename);
+
+		std::cout << "- cooking '" << filename << "'... " << std::flush;
+		const auto timer = std::chrono::high_resolution_clock::now();
+
+		int width, height, channels;
+		const auto pixels = stbi_load(filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+		if (!pixels)
+		{
+			Throw(std::runtime_error("failed to load texture image '" + filename + "'"));
+		}
+
+		Texture::MipLevel level{ static_cast<uint32_t>(width), static_cast<uint32_t>(height), {} };
+		level.Pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+		stbi_image_free(pixels);
+
+		CookedHeader header = {};
+		std::memcpy(header.Magic, CookedMagic, sizeof(CookedMagic));
+		header.Version = CookedVersion;
+		header.Width = level.Width;
+		header.Height = level.Height;
+		header.MipLevels = 0;
+
+		for (auto size = std::max(level.Width, level.Height); size != 0; size /= 2)
+		{
+			++header.MipLevels;
+		}
+
+		// Written aside then renamed, so that an interrupted cook is never mistaken for a complete one.
+		const auto partialFilename = cookedFilename + ".partial";
+
+		{
+			std::ofstream file(partialFilename, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+			for (uint32_t i = 0; i != header.MipLevels; ++i)
+			{
+				if (i != 0)
+				{
+					level = Downsample(level);
+				}
+
+				file.write(reinterpret_cast<const char*>(level.Pixels.data()), level.Pixels.size());
+			}
+
+			if (!file)
+			{
+				Throw(std::runtime_error("failed to write cooked texture '" + partialFilename + "'"));
+			}
+		}
+
+		std::filesystem::rename(partialFilename, cookedFilename);
+
+		const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+		std::cout << "(" << header.MipLevels << " levels) " << elapsed << "s" << std::endl;
+	}
+}
+
 Texture Texture::LoadTexture(const std::string& filename, const Vulkan::SamplerConfig& samplerConfig)
 {
+	Utilities::Tracer::Zone zone("Texture::LoadTexture", filename);
+
+	auto cookedFilename = CookedFilename(filename);
+
+	if (!IsCooked(filename, cookedFilename))
+	{
+		Cook(filename, cookedFilename);
+	}
+
 	std::cout << "- loading '" << filename << "'... " << std::flush;
 	const auto timer = std::chrono::high_resolution_clock::now();
 
-	// Load the texture in normal host memory.
-	int width, height, channels;
-	const auto pixels = stbi_load(filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+	// Load the tail in normal host memory.
+	std::ifstream file(cookedFilename, std::ios::binary);
+	CookedHeader header = {};
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	if (!file || std::memcmp(header.Magic, CookedMagic, sizeof(CookedMagic)) != 0 || header.Version != CookedVersion || header.MipLevels == 0)
+	{
+		Throw(std::runtime_error("invalid cooked texture '" + cookedFilename + "'"));
+	}
+
+	uint32_t tailLevel = 0;
+
+	while (tailLevel + 1 != header.MipLevels && std::max(LevelSize(header.Width, tailLevel), LevelSize(header.Height, tailLevel)) > MaxTailSize)
+	{
+		++tailLevel;
+	}
+
+	std::vector<MipLevel> tailLevels;
+	file.seekg(LevelOffset(header.Width, header.Height, tailLevel));
 
-	if (!pixels)
+	for (uint32_t i = tailLevel; i != header.MipLevels; ++i)
 	{
-		Throw(std::runtime_error("failed to load texture image '" + filename + "'"));
+		MipLevel level{ LevelSize(header.Width, i), LevelSize(header.Height, i), {} };
+		level.Pixels.resize(LevelBytes(header.Width, header.Height, i));
+		file.read(reinterpret_cast<char*>(level.Pixels.data()), level.Pixels.size());
+		tailLevels.push_back(std::move(level));
+	}
+
+	if (!file)
+	{
+		Throw(std::runtime_error("failed to read cooked texture '" + cookedFilename + "'"));
 	}
 
 	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
-	std::cout << "(" << width << " x " << height << " x " << channels << ") ";
+	std::cout << "(" << header.Width << " x " << header.Height << ", " << tailLevel << " streamed levels) ";
 	std::cout << elapsed << "s" << std::endl;
 
-	return Texture(width, height, channels, pixels);
+	return Texture(std::move(cookedFilename), header.Width, header.Height, header.MipLevels, tailLevel, std::move(tailLevels));
+}
+
+uint64_t Texture::Size(const uint32_t firstLevel) const
+{
+	uint64_t size = 0;
+
+	for (uint32_t i = firstLevel; i < mipLevels_; ++i)
+	{
+		size += LevelBytes(width_, height_, i);
+	}
+
+	return size;
+}
+
+std::vector<Texture::MipLevel> Texture::ReadLevels(const uint32_t firstLevel) const
+{
+	Utilities::Tracer::Zone zone("Texture::ReadLevels");
+
+	std::vector<MipLevel> levels;
+
+	if (firstLevel < tailLevel_)
+	{
+		std::ifstream file(cookedFilename_, std::ios::binary);
+		file.seekg(LevelOffset(width_, height_, firstLevel));
+
+		for (uint32_t i = firstLevel; i != tailLevel_; ++i)
+		{
+			MipLevel level{ LevelSize(width_, i), LevelSize(height_, i), {} };
+			level.Pixels.resize(LevelBytes(width_, height_, i));
+			file.read(reinterpret_cast<char*>(level.Pixels.data()), level.Pixels.size());
+			levels.push_back(std::move(level));
+		}
+
+		if (!file)
+		{
+			Throw(std::runtime_error("failed to read cooked texture '" + cookedFilename_ + "'"));
+		}
+	}
+
+	const auto& tail = *tailLevels_;
+	levels.insert(levels.end(), tail.begin() + (std::max(firstLevel, tailLevel_) - tailLevel_), tail.end());
+
+	return levels;
 }
 
-Texture::Texture(int width, int height, int channels, unsigned char* const pixels) :
+Texture::Texture(
+	std::string cookedFilename, const uint32_t width, const uint32_t height, const uint32_t mipLevels, const uint32_t tailLevel,
+	std::vector<MipLevel>&& tailLevels) :
+	cookedFilename_(std::move(cookedFilename)),
 	width_(width),
 	height_(height),
-	channels_(channels),
-	pixels_(pixels, stbi_image_free)
+	mipLevels_(mipLevels),
+	tailLevel_(tailLevel),
+	tailLevels_(std::make_shared<const std::vector<MipLevel>>(std::move(tailLevels)))
 {
 }
-	
+
 }
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "Vulkan/Sampler.hpp"
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace Assets
 {
@@ -10,6 +12,16 @@ namespace Assets
 	{
 	public:
 
+		// The RGBA pixels of a mip level.
+		struct MipLevel final
+		{
+			uint32_t Width;
+			uint32_t Height;
+			std::vector<unsigned char> Pixels;
+		};
+
+		// The image is first cooked into its full mip chain on disk (once, or whenever the image is newer), of which only
+		// the coarsest levels (the tail) are loaded in memory. The finer levels are streamed in on demand (see ReadLevels()).
 		static Texture LoadTexture(const std::string& filename, const Vulkan::SamplerConfig& samplerConfig);
 
 		Texture& operator = (const Texture&) = delete;
@@ -20,19 +32,32 @@ namespace Assets
 		Texture(Texture&&) = default;
 		~Texture() = default;
 
-		const unsigned char* Pixels() const { return pixels_.get(); }
-		int Width() const { return width_; }
-		int Height() const { return height_; }
+		uint32_t Width() const { return width_; }
+		uint32_t Height() const { return height_; }
+		uint32_t MipLevels() const { return mipLevels_; }
+
+		// The first level of the tail, which is always in memory.
+		uint32_t TailLevel() const { return tailLevel_; }
+		const std::vector<MipLevel>& TailLevels() const { return *tailLevels_; }
+
+		// The size of the levels from the given one down to the last one.
+		uint64_t Size(uint32_t firstLevel) const;
+
+		// Read the levels from the given one down to the last one, the finer than the tail from the cooked file.
+		// Safe to call from any thread.
+		std::vector<MipLevel> ReadLevels(uint32_t firstLevel) const;
 
 	private:
 
-		Texture(int width, int height, int channels, unsigned char* pixels);
+		Texture(std::string cookedFilename, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t tailLevel, std::vector<MipLevel>&& tailLevels);
 
 		Vulkan::SamplerConfig samplerConfig_;
-		int width_;
-		int height_;
-		int channels_;
-		std::unique_ptr<unsigned char, void (*) (void*)> pixels_;
+		std::string cookedFilename_;
+		uint32_t width_{};
+		uint32_t height_{};
+		uint32_t mipLevels_{};
+		uint32_t tailLevel_{};
+		std::shared_ptr<const std::vector<MipLevel>> tailLevels_; // Shared by the copies, e.g. the streaming ones.
 	};
 
 }
@@ -1,40 +1,104 @@
 #include "TextureImage.hpp"
 #include "Texture.hpp"
 #include "Vulkan/Buffer.hpp"
-#include "Vulkan/CommandPool.hpp"
+#include "Vulkan/CommandQueue.hpp"
+#include "Vulkan/ImageMemoryBarrier.hpp"
 #include "Vulkan/ImageView.hpp"
 #include "Vulkan/Image.hpp"
+#include "Vulkan/QueueOwnership.hpp"
 #include "Vulkan/Sampler.hpp"
+#include "Utilities/Exception.hpp"
 #include <cstring>
 
 namespace Assets {
 
-TextureImage::TextureImage(Vulkan::CommandPool& commandPool, const Texture& texture)
+namespace
 {
-	// Create a host staging buffer and copy the image into it.
-	const VkDeviceSize imageSize = texture.Width() * texture.Height() * 4;
-	const auto& device = commandPool.Device();
+	VkImageSubresourceRange ColorSubresourceRange(const uint32_t mipLevels)
+	{
+		VkImageSubresourceRange subresourceRange = {};
+		subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		subresourceRange.baseMipLevel = 0;
+		subresourceRange.levelCount = mipLevels;
+		subresourceRange.baseArrayLayer = 0;
+		subresourceRange.layerCount = 1;
+
+		return subresourceRange;
+	}
+}
+
+TextureImage::TextureImage(Vulkan::CommandQueue& transferQueue, const uint32_t dstQueueFamilyIndex, const Texture& texture) :
+	TextureImage(transferQueue, dstQueueFamilyIndex, texture.TailLevels())
+{
+}
+
+TextureImage::TextureImage(Vulkan::CommandQueue& transferQueue, const uint32_t dstQueueFamilyIndex, const std::vector<Texture::MipLevel>& levels) :
+	srcQueueFamilyIndex_(transferQueue.FamilyIndex()),
+	dstQueueFamilyIndex_(dstQueueFamilyIndex),
+	mipLevels_(static_cast<uint32_t>(levels.size()))
+{
+	if (levels.empty())
+	{
+		Throw(std::invalid_argument("texture image has no mip level"));
+	}
+
+	// Create a host staging buffer and copy the levels into it, one after the other.
+	std::vector<VkBufferImageCopy> regions(levels.size());
+	VkDeviceSize imageSize = 0;
+
+	for (uint32_t i = 0; i != mipLevels_; ++i)
+	{
+		auto& region = regions[i];
+		region.bufferOffset = imageSize;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = i;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = { levels[i].Width, levels[i].Height, 1 };
+
+		imageSize += levels[i].Pixels.size();
+	}
+
+	const auto& device = transferQueue.Device();
 
 	auto stagingBuffer = std::make_unique<Vulkan::Buffer>(device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-	auto stagingBufferMemory = stagingBuffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	auto stagingBufferMemory = std::make_unique<Vulkan::DeviceMemory>(stagingBuffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+
+	const auto data = static_cast<unsigned char*>(stagingBufferMemory->Map(0, imageSize));
+
+	for (uint32_t i = 0; i != mipLevels_; ++i)
+	{
+		std::memcpy(data + regions[i].bufferOffset, levels[i].Pixels.data(), levels[i].Pixels.size());
+	}
 
-	const auto data = stagingBufferMemory.Map(0, imageSize);
-	std::memcpy(data, texture.Pixels(), imageSize);
-	stagingBufferMemory.Unmap();
+	stagingBufferMemory->Unmap();
 
-	// Create the device side image, memory, view and sampler.
-	image_.reset(new Vulkan::Image(device, VkExtent2D{ static_cast<uint32_t>(texture.Width()), static_cast<uint32_t>(texture.Height()) }, VK_FORMAT_R8G8B8A8_UNORM));
+	// Create the device side image, memory, view and sampler. The sampler does not clamp the level of detail.
+	Vulkan::SamplerConfig samplerConfig;
+	samplerConfig.MaxLod = static_cast<float>(mipLevels_);
+
+	image_.reset(new Vulkan::Image(device, VkExtent2D{ levels[0].Width, levels[0].Height }, mipLevels_, VK_FORMAT_R8G8B8A8_UNORM,
+		VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT));
 	imageMemory_.reset(new Vulkan::DeviceMemory(image_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
-	imageView_.reset(new Vulkan::ImageView(device, image_->Handle(), image_->Format(), VK_IMAGE_ASPECT_COLOR_BIT));
-	sampler_.reset(new Vulkan::Sampler(device, Vulkan::SamplerConfig()));
+	imageView_.reset(new Vulkan::ImageView(device, image_->Handle(), image_->Format(), VK_IMAGE_ASPECT_COLOR_BIT, mipLevels_));
+	sampler_.reset(new Vulkan::Sampler(device, samplerConfig));
+
+	// Transfer the data to device side. The staging buffer is kept alive by the queue until the copy completes.
+	transferQueue.Submit({}, [&](VkCommandBuffer commandBuffer)
+	{
+		const auto subresourceRange = ColorSubresourceRange(mipLevels_);
 
-	// Transfer the data to device side.
-	image_->TransitionImageLayout(commandPool, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	image_->CopyFrom(commandPool, *stagingBuffer);
-	image_->TransitionImageLayout(commandPool, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		Vulkan::ImageMemoryBarrier::Insert(commandBuffer, image_->Handle(), subresourceRange,
+			0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-	// Delete the buffer before the memory
-	stagingBuffer.reset();
+		vkCmdCopyBufferToImage(commandBuffer, stagingBuffer->Handle(), image_->Handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			static_cast<uint32_t>(regions.size()), regions.data());
+
+		Vulkan::QueueOwnership::ReleaseImage(commandBuffer, image_->Handle(), subresourceRange, srcQueueFamilyIndex_, dstQueueFamilyIndex_,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+		transferQueue.Retain(std::move(stagingBuffer), std::move(stagingBufferMemory));
+	});
 }
 
 TextureImage::~TextureImage()
@@ -45,4 +109,11 @@ TextureImage::~TextureImage()
 	imageMemory_.reset();
 }
 
+void TextureImage::Acquire(VkCommandBuffer commandBuffer) const
+{
+	Vulkan::QueueOwnership::AcquireImage(commandBuffer, image_->Handle(), ColorSubresourceRange(mipLevels_), srcQueueFamilyIndex_, dstQueueFamilyIndex_,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_ACCESS_SHADER_READ_BIT,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
 }
@@ -1,10 +1,13 @@
 #pragma once
 
+#include "Texture.hpp"
+#include "Vulkan/Vulkan.hpp"
 #include <memory>
+#include <vector>
 
 namespace Vulkan
 {
-	class CommandPool;
+	class CommandQueue;
 	class DeviceMemory;
 	class Image;
 	class ImageView;
@@ -13,8 +16,6 @@ namespace Vulkan
 
 namespace Assets
 {
-	class Texture;
-	
 	class TextureImage final
 	{
 	public:
@@ -24,14 +25,24 @@ namespace Assets
 		TextureImage& operator = (const TextureImage&) = delete;
 		TextureImage& operator = (TextureImage&&) = delete;
 
-		TextureImage(Vulkan::CommandPool& commandPool, const Texture& texture);
+		// Uploads on the given queue without waiting for it, then releases the image to the queue family sampling it.
+		// The texture tail (see Texture::TailLevels()), or the given levels down to the last one.
+		TextureImage(Vulkan::CommandQueue& transferQueue, uint32_t dstQueueFamilyIndex, const Texture& texture);
+		TextureImage(Vulkan::CommandQueue& transferQueue, uint32_t dstQueueFamilyIndex, const std::vector<Texture::MipLevel>& levels);
 		~TextureImage();
 
 		const Vulkan::ImageView& ImageView() const { return *imageView_; }
 		const Vulkan::Sampler& Sampler() const { return *sampler_; }
 
+		// Complete the ownership transfer on the sampling queue, once the upload has completed.
+		void Acquire(VkCommandBuffer commandBuffer) const;
+
 	private:
 
+		uint32_t srcQueueFamilyIndex_{};
+		uint32_t dstQueueFamilyIndex_{};
+		uint32_t mipLevels_{};
+
 		std::unique_ptr<Vulkan::Image> image_;
 		std::unique_ptr<Vulkan::DeviceMemory> imageMemory_;
 		std::unique_ptr<Vulkan::ImageView> imageView_;
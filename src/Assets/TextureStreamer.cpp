@@ -0,0 +1,327 @@
+#include "TextureStreamer.hpp"
+#include "Scene.hpp"
+#include "TextureImage.hpp"
+#include "Vulkan/BindlessHeap.hpp"
+#include "Vulkan/Buffer.hpp"
+#include "Vulkan/CommandQueue.hpp"
+#include "Vulkan/Device.hpp"
+#include "Vulkan/ImageView.hpp"
+#include "Vulkan/Sampler.hpp"
+#include "Vulkan/TimelineSemaphore.hpp"
+#include "Utilities/Tracer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+namespace Assets {
+
+namespace
+{
+	// The shaders store the requested levels as MaxTextureLevels - level, so that zero means none (see TextureStreaming.glsl).
+	const uint32_t MaxTextureLevels = 16;
+}
+
+TextureStreamer::TextureStreamer(
+	Vulkan::CommandQueue& transferQueue, Vulkan::CommandQueue& graphicsQueue, Vulkan::BindlessHeap& bindlessHeap,
+	const Scene& scene, const uint32_t framesInFlight, const VkDeviceSize budget) :
+	transferQueue_(transferQueue),
+	graphicsQueue_(graphicsQueue),
+	bindlessHeap_(bindlessHeap),
+	framesInFlight_(framesInFlight),
+	budget_(budget),
+	tailImageViews_(scene.TextureImageViews()),
+	tailSamplers_(scene.TextureSamplers())
+{
+	const auto& device = transferQueue.Device();
+	const auto count = static_cast<uint32_t>(scene.Textures().size());
+
+	// Only the tails are resident to begin with.
+	textures_.reserve(count);
+
+	for (uint32_t i = 0; i != count; ++i)
+	{
+		const auto& source = scene.Textures()[i];
+		textures_.push_back({ source, source.TailLevel(), source.TailLevel(), 0, 0, tailImageViews_[i], tailSamplers_[i], nullptr });
+	}
+
+	std::vector<VkImageView> imageViews;
+	std::vector<VkSampler> samplers;
+
+	for (uint32_t i = 0; i != framesInFlight; ++i)
+	{
+		imageViews.insert(imageViews.end(), tailImageViews_.begin(), tailImageViews_.end());
+		samplers.insert(samplers.end(), tailSamplers_.begin(), tailSamplers_.end());
+	}
+
+	textureBase_ = bindlessHeap.AddTextures(imageViews, samplers);
+	frameVersions_.assign(framesInFlight, std::vector<uint32_t>(count, 0));
+
+	// Small and read or written once per texture lookup at most, host-visible memory saves the copies.
+	const auto size = std::max<VkDeviceSize>(sizeof(uint32_t) * count * framesInFlight, sizeof(uint32_t));
+
+	residencyBuffer_.reset(new Vulkan::Buffer(device, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+	residencyBufferMemory_.reset(new Vulkan::DeviceMemory(residencyBuffer_->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+	residencyData_ = static_cast<uint32_t*>(residencyBufferMemory_->Map(0, size));
+
+	feedbackBuffer_.reset(new Vulkan::Buffer(device, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+	feedbackBufferMemory_.reset(new Vulkan::DeviceMemory(feedbackBuffer_->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+	feedbackData_ = static_cast<uint32_t*>(feedbackBufferMemory_->Map(0, size));
+
+	for (uint32_t i = 0; i != framesInFlight; ++i)
+	{
+		for (uint32_t j = 0; j != count; ++j)
+		{
+			residencyData_[FrameOffset(i) + j] = textures_[j].ResidentLevel;
+			feedbackData_[FrameOffset(i) + j] = 0;
+		}
+	}
+
+	residencySlot_ = bindlessHeap.AddBuffer(residencyBuffer_->Handle());
+	feedbackSlot_ = bindlessHeap.AddBuffer(feedbackBuffer_->Handle());
+
+	const auto& debugUtils = device.DebugUtils();
+
+	debugUtils.SetObjectName(residencyBuffer_->Handle(), "Texture Residency Buffer");
+	debugUtils.SetObjectName(feedbackBuffer_->Handle(), "Texture Feedback Buffer");
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	if (load_.Levels.valid())
+	{
+		load_.Levels.wait();
+	}
+
+	if (upload_.Image)
+	{
+		transferQueue_.WaitFor(upload_.Uploaded);
+	}
+
+	bindlessHeap_.RemoveBuffer(feedbackSlot_);
+	bindlessHeap_.RemoveBuffer(residencySlot_);
+	bindlessHeap_.RemoveTextures(textureBase_, TextureCount() * framesInFlight_);
+
+	feedbackBufferMemory_->Unmap();
+	residencyBufferMemory_->Unmap();
+
+	retired_.clear();
+	upload_.Image.reset();
+	textures_.clear();
+	feedbackBuffer_.reset();
+	feedbackBufferMemory_.reset(); // release memory after bound buffer has been destroyed
+	residencyBuffer_.reset();
+	residencyBufferMemory_.reset(); // release memory after bound buffer has been destroyed
+}
+
+VkDeviceSize TextureStreamer::ResidentSize() const
+{
+	VkDeviceSize size = 0;
+
+	for (uint32_t i = 0; i != TextureCount(); ++i)
+	{
+		size += StreamedSize(i, textures_[i].ResidentLevel);
+	}
+
+	return size;
+}
+
+void TextureStreamer::Update(const uint32_t frameIndex)
+{
+	Utilities::Tracer::Zone zone("TextureStreamer::Update");
+
+	++frame_;
+
+	// The requests of the previous use of this frame slot (none when the trace was skipped), cleared for the next one.
+	auto* const feedback = feedbackData_ + FrameOffset(frameIndex);
+
+	for (uint32_t i = 0; i != TextureCount(); ++i)
+	{
+		if (feedback[i] != 0)
+		{
+			auto& texture = textures_[i];
+			texture.RequestedLevel = std::min(MaxTextureLevels - std::min(feedback[i], MaxTextureLevels), texture.Source.TailLevel());
+			texture.LastRequested = frame_;
+			feedback[i] = 0;
+		}
+	}
+
+	CompleteLoad();
+	CompleteUpload();
+	StartLoad();
+
+	// Bring this frame copy up to date.
+	auto* const residency = residencyData_ + FrameOffset(frameIndex);
+	auto& versions = frameVersions_[frameIndex];
+
+	for (uint32_t i = 0; i != TextureCount(); ++i)
+	{
+		const auto& texture = textures_[i];
+
+		if (versions[i] != texture.Version)
+		{
+			bindlessHeap_.UpdateTexture(TextureBase(frameIndex) + i, texture.ImageView, texture.Sampler);
+			residency[i] = texture.ResidentLevel;
+			versions[i] = texture.Version;
+		}
+	}
+
+	// A replaced image is no longer in any frame copy after frames in flight, nor read once those frames have completed.
+	while (!retired_.empty() && retired_.front().Frame + 2 * framesInFlight_ <= frame_)
+	{
+		retired_.pop_front();
+	}
+}
+
+void TextureStreamer::RequestFinestLevels()
+{
+	for (auto& texture : textures_)
+	{
+		texture.RequestedLevel = 0;
+		texture.LastRequested = frame_ + 1;
+	}
+}
+
+void TextureStreamer::RecordFeedbackBarrier(VkCommandBuffer commandBuffer) const
+{
+	VkMemoryBarrier memoryBarrier = {};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+}
+
+uint64_t TextureStreamer::StreamedSize(const uint32_t index, const uint32_t level) const
+{
+	const auto& source = textures_[index].Source;
+	return level < source.TailLevel() ? source.Size(level) : 0;
+}
+
+void TextureStreamer::CompleteLoad()
+{
+	if (!load_.Levels.valid() || load_.Levels.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		return;
+	}
+
+	// Rethrows the read errors.
+	const auto levels = load_.Levels.get();
+
+	upload_.Index = load_.Index;
+	upload_.FirstLevel = load_.FirstLevel;
+	upload_.Image.reset(new TextureImage(transferQueue_, graphicsQueue_.FamilyIndex(), levels));
+	upload_.Uploaded = transferQueue_.LastSubmitted();
+}
+
+void TextureStreamer::CompleteUpload()
+{
+	if (!upload_.Image || transferQueue_.Timeline().Value() < upload_.Uploaded)
+	{
+		return;
+	}
+
+	// The upload has completed, the acquire does not hold back the frames submitted after it on the graphics queue.
+	const auto& image = *upload_.Image;
+
+	graphicsQueue_.Submit({ { transferQueue_, upload_.Uploaded } }, [&](VkCommandBuffer commandBuffer)
+	{
+		image.Acquire(commandBuffer);
+	});
+
+	Swap(upload_.Index, upload_.FirstLevel, std::move(upload_.Image), image.ImageView().Handle(), image.Sampler().Handle());
+}
+
+void TextureStreamer::StartLoad()
+{
+	if (load_.Levels.valid() || upload_.Image)
+	{
+		return;
+	}
+
+	// Fit the requested levels in the budget, coarsening the least recently requested textures first.
+	std::vector<uint32_t> targets(TextureCount());
+	std::vector<uint32_t> order(TextureCount());
+	uint64_t total = 0;
+
+	for (uint32_t i = 0; i != TextureCount(); ++i)
+	{
+		targets[i] = textures_[i].RequestedLevel;
+		total += StreamedSize(i, targets[i]);
+	}
+
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [this](const uint32_t lhs, const uint32_t rhs)
+	{
+		return textures_[lhs].LastRequested < textures_[rhs].LastRequested;
+	});
+
+	for (const auto i : order)
+	{
+		while (total > budget_ && targets[i] < textures_[i].Source.TailLevel())
+		{
+			total -= StreamedSize(i, targets[i]) - StreamedSize(i, targets[i] + 1);
+			++targets[i];
+		}
+	}
+
+	// Free memory before taking more, then refine the most recently requested textures first.
+	auto next = order.rend();
+
+	for (auto it = order.rbegin(); it != order.rend(); ++it)
+	{
+		const auto& texture = textures_[*it];
+
+		if (targets[*it] > texture.ResidentLevel)
+		{
+			next = it;
+			break;
+		}
+
+		if (targets[*it] < texture.ResidentLevel && next == order.rend())
+		{
+			next = it;
+		}
+	}
+
+	if (next == order.rend())
+	{
+		return;
+	}
+
+	const auto index = *next;
+	const auto level = targets[index];
+	const auto& source = textures_[index].Source;
+
+	// Back to the tail, no need to read anything.
+	if (level == source.TailLevel())
+	{
+		Swap(index, level, nullptr, tailImageViews_[index], tailSamplers_[index]);
+		return;
+	}
+
+	load_.Index = index;
+	load_.FirstLevel = level;
+	load_.Levels = std::async(std::launch::async, [source, level]()
+	{
+		return source.ReadLevels(level);
+	});
+}
+
+void TextureStreamer::Swap(
+	const uint32_t index, const uint32_t level, std::unique_ptr<TextureImage> image, const VkImageView imageView, const VkSampler sampler)
+{
+	auto& texture = textures_[index];
+
+	if (texture.Image)
+	{
+		retired_.push_back({ frame_, std::move(texture.Image) });
+	}
+
+	texture.ResidentLevel = level;
+	texture.Image = std::move(image);
+	texture.ImageView = imageView;
+	texture.Sampler = sampler;
+	++texture.Version;
+}
+
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Texture.hpp"
+#include "Vulkan/Vulkan.hpp"
+#include <deque>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace Vulkan
+{
+	class BindlessHeap;
+	class Buffer;
+	class CommandQueue;
+	class DeviceMemory;
+}
+
+namespace Assets
+{
+	class Scene;
+	class TextureImage;
+
+	// Pages the mip levels of the scene textures in and out of device memory, as requested by the ray tracing shaders
+	// (see TextureStreaming.glsl). The hit shaders record the finest level they sample per texture into a feedback buffer.
+	// The finest levels requested that fit in the memory budget are then read from the cooked files on a worker thread
+	// (see Texture::ReadLevels()), uploaded on the transfer queue, and swapped in for the previous image once uploaded.
+	// When over budget, the least recently requested textures are coarsened first. The tail levels are always resident
+	// (the scene texture images), and do not count towards the budget.
+	//
+	// The heap holds one copy of the scene textures per frame in flight, along with their resident levels, so that the
+	// copy of a frame slot is only updated once its previous use has completed. The shaders clamp their level of detail
+	// to the resident levels.
+	class TextureStreamer final
+	{
+	public:
+
+		TextureStreamer(const TextureStreamer&) = delete;
+		TextureStreamer(TextureStreamer&&) = delete;
+		TextureStreamer& operator = (const TextureStreamer&) = delete;
+		TextureStreamer& operator = (TextureStreamer&&) = delete;
+
+		TextureStreamer(
+			Vulkan::CommandQueue& transferQueue, Vulkan::CommandQueue& graphicsQueue, Vulkan::BindlessHeap& bindlessHeap,
+			const Scene& scene, uint32_t framesInFlight, VkDeviceSize budget);
+		~TextureStreamer(); // Waits for the pending read and upload. The frames sampling the textures must have completed.
+
+		uint32_t TextureCount() const { return static_cast<uint32_t>(textures_.size()); }
+
+		// The heap slot of the first texture of the frame copy, and the index of its first texture in the residency
+		// and feedback buffers.
+		uint32_t TextureBase(uint32_t frameIndex) const { return textureBase_ + FrameOffset(frameIndex); }
+		uint32_t FrameOffset(uint32_t frameIndex) const { return frameIndex * TextureCount(); }
+
+		// The heap slots of the resident levels and requested levels buffers (see TextureStreaming.glsl).
+		uint32_t ResidencyBuffer() const { return residencySlot_; }
+		uint32_t FeedbackBuffer() const { return feedbackSlot_; }
+
+		// Device memory taken by the streamed levels.
+		VkDeviceSize ResidentSize() const;
+
+		// Once per frame, when the previous use of the frame slot has completed and before recording it: read the requests
+		// of that use, make progress on the reads and uploads, then update the frame copy of the textures.
+		void Update(uint32_t frameIndex);
+
+		// The rasterizer does not record any feedback, request the finest level of every texture instead (see Update()).
+		void RequestFinestLevels();
+
+		// The image currently resident for a texture, swapped in by Update().
+		VkImageView ImageView(uint32_t index) const { return textures_[index].ImageView; }
+		VkSampler Sampler(uint32_t index) const { return textures_[index].Sampler; }
+
+		// Make the requests written by the trace visible to the host once the frame fence is signaled.
+		void RecordFeedbackBarrier(VkCommandBuffer commandBuffer) const;
+
+	private:
+
+		struct StreamedTexture final
+		{
+			Texture Source;
+			uint32_t ResidentLevel;
+			uint32_t RequestedLevel;
+			uint64_t LastRequested;
+			uint32_t Version;
+			VkImageView ImageView;
+			VkSampler Sampler;
+			std::unique_ptr<TextureImage> Image; // Empty while only the tail is resident.
+		};
+
+		struct Load final
+		{
+			uint32_t Index;
+			uint32_t FirstLevel;
+			std::future<std::vector<Texture::MipLevel>> Levels;
+		};
+
+		struct Upload final
+		{
+			uint32_t Index;
+			uint32_t FirstLevel;
+			uint64_t Uploaded;
+			std::unique_ptr<TextureImage> Image;
+		};
+
+		struct Retirement final
+		{
+			uint64_t Frame;
+			std::unique_ptr<TextureImage> Image;
+		};
+
+		uint64_t StreamedSize(uint32_t index, uint32_t level) const;
+		void CompleteLoad();
+		void CompleteUpload();
+		void StartLoad();
+		void Swap(uint32_t index, uint32_t level, std::unique_ptr<TextureImage> image, VkImageView imageView, VkSampler sampler);
+
+		Vulkan::CommandQueue& transferQueue_;
+		Vulkan::CommandQueue& graphicsQueue_;
+		Vulkan::BindlessHeap& bindlessHeap_;
+		const uint32_t framesInFlight_;
+		const VkDeviceSize budget_;
+
+		std::vector<StreamedTexture> textures_;
+		std::vector<VkImageView> tailImageViews_;
+		std::vector<VkSampler> tailSamplers_;
+
+		uint32_t textureBase_{};
+		uint32_t residencySlot_{};
+		uint32_t feedbackSlot_{};
+
+		// Host-visible, one section per frame in flight.
+		std::unique_ptr<Vulkan::Buffer> residencyBuffer_;
+		std::unique_ptr<Vulkan::DeviceMemory> residencyBufferMemory_;
+		uint32_t* residencyData_{};
+		std::unique_ptr<Vulkan::Buffer> feedbackBuffer_;
+		std::unique_ptr<Vulkan::DeviceMemory> feedbackBufferMemory_;
+		uint32_t* feedbackData_{};
+
+		// The texture versions written to each frame copy.
+		std::vector<std::vector<uint32_t>> frameVersions_;
+
+		Load load_{};
+		Upload upload_{};
+		std::deque<Retirement> retired_;
+		uint64_t frame_{};
+	};
+
+}
@@ -10,25 +10,32 @@ UniformBuffer::UniformBuffer(const Vulkan::Device& device)
 
 	buffer_.reset(new Vulkan::Buffer(device, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT));
 	memory_.reset(new Vulkan::DeviceMemory(buffer_->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+	mappedData_ = memory_->Map(0, bufferSize);
 }
 
 UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept :
 	buffer_(other.buffer_.release()),
-	memory_(other.memory_.release())
+	memory_(other.memory_.release()),
+	mappedData_(other.mappedData_)
 {
+	other.mappedData_ = nullptr;
 }
 
 UniformBuffer::~UniformBuffer()
 {
+	if (mappedData_ != nullptr)
+	{
+		memory_->Unmap();
+		mappedData_ = nullptr;
+	}
+
 	buffer_.reset();
 	memory_.reset(); // release memory after bound buffer has been destroyed
 }
 
 void UniformBuffer::SetValue(const UniformBufferObject& ubo)
 {
-	const auto data = memory_->Map(0, sizeof(UniformBufferObject));
-	std::memcpy(data, &ubo, sizeof(ubo));
-	memory_->Unmap();
+	std::memcpy(mappedData_, &ubo, sizeof(ubo));
 }
 
 }
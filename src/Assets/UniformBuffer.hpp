@@ -20,6 +20,8 @@ namespace Assets
 		glm::mat4 Projection;
 		glm::mat4 ModelViewInverse;
 		glm::mat4 ProjectionInverse;
+		glm::mat4 PreviousModelView; // The camera of the previous frame, for reprojection.
+		glm::mat4 PreviousProjection;
 		float Aperture;
 		float FocusDistance;
 		float HeatmapScale;
@@ -27,8 +29,18 @@ namespace Assets
 		uint32_t NumberOfSamples;
 		uint32_t NumberOfBounces;
 		uint32_t RandomSeed;
-		uint32_t HasSky; // bool
-		uint32_t ShowHeatmap; // bool
+
+		// The ray tracing launch covers the tile at this offset within the full image.
+		uint32_t TileOffsetX;
+		uint32_t TileOffsetY;
+		uint32_t ImageWidth;
+		uint32_t ImageHeight;
+
+		// Only trace a subset of the pixels (0: all, 1: checkerboard, 2: one pixel per 2x2 quad), this frame's
+		// phase of the pattern, and which of the two history images is written (the other one being read).
+		uint32_t InterleaveMode;
+		uint32_t InterleaveFrame;
+		uint32_t HistoryIndex;
 	};
 
 	class UniformBuffer
@@ -51,6 +63,7 @@ namespace Assets
 
 		std::unique_ptr<Vulkan::Buffer> buffer_;
 		std::unique_ptr<Vulkan::DeviceMemory> memory_;
+		void* mappedData_{}; // Persistently mapped, host coherent.
 	};
 
 }
\ No newline at end of file
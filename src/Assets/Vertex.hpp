@@ -1,8 +1,6 @@
 #pragma once
 
 #include "Utilities/Glm.hpp"
-#include "Vulkan/Vulkan.hpp"
-#include <array>
 
 namespace Assets
 {
@@ -22,42 +20,6 @@ namespace Assets
 				TexCoord == other.TexCoord &&
 				MaterialIndex == other.MaterialIndex;
 		}
-
-		static VkVertexInputBindingDescription GetBindingDescription()
-		{
-			VkVertexInputBindingDescription bindingDescription = {};
-			bindingDescription.binding = 0;
-			bindingDescription.stride = sizeof(Vertex);
-			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-			return bindingDescription;
-		}
-
-		static std::array<VkVertexInputAttributeDescription, 4> GetAttributeDescriptions()
-		{
-			std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions = {};
-
-			attributeDescriptions[0].binding = 0;
-			attributeDescriptions[0].location = 0;
-			attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-			attributeDescriptions[0].offset = offsetof(Vertex, Position);
-
-			attributeDescriptions[1].binding = 0;
-			attributeDescriptions[1].location = 1;
-			attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-			attributeDescriptions[1].offset = offsetof(Vertex, Normal);
-
-			attributeDescriptions[2].binding = 0;
-			attributeDescriptions[2].location = 2;
-			attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-			attributeDescriptions[2].offset = offsetof(Vertex, TexCoord);
-
-			attributeDescriptions[3].binding = 0;
-			attributeDescriptions[3].location = 3;
-			attributeDescriptions[3].format = VK_FORMAT_R32_SINT;
-			attributeDescriptions[3].offset = offsetof(Vertex, MaterialIndex);
-
-			return attributeDescriptions;
-		}
 	};
 
 }
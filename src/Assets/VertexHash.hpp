@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Vertex.hpp"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#include <functional>
+
+namespace std
+{
+	template<> struct hash<Assets::Vertex> final
+	{
+		size_t operator()(Assets::Vertex const& vertex) const noexcept
+		{
+			return
+				Combine(hash<glm::vec3>()(vertex.Position),
+					Combine(hash<glm::vec3>()(vertex.Normal),
+						Combine(hash<glm::vec2>()(vertex.TexCoord),
+							hash<int>()(vertex.MaterialIndex))));
+		}
+
+	private:
+
+		static size_t Combine(size_t hash0, size_t hash1)
+		{
+			return hash0 ^ (hash1 + 0x9e3779b9 + (hash0 << 6) + (hash0 >> 2));
+		}
+	};
+}
@@ -0,0 +1,380 @@
+#include "BenchmarkSweep.hpp"
+#include "SceneList.hpp"
+#include "Utilities/Exception.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+
+namespace
+{
+	// Two-sided 95% Student's t critical values, by degrees of freedom.
+	double StudentT95(const double degreesOfFreedom)
+	{
+		static const double table[] =
+		{
+			12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+			2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+			2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+		};
+
+		// Round down the (Welch) degrees of freedom, which is conservative.
+		const auto df = static_cast<size_t>(std::max(std::floor(degreesOfFreedom), 1.0));
+		return df <= std::size(table) ? table[df - 1] : 1.960;
+	}
+
+	BenchmarkSweep::Statistics ComputeStatistics(const std::vector<double>& values)
+	{
+		const auto n = values.size();
+		const auto mean = std::accumulate(values.begin(), values.end(), 0.0) / n;
+
+		double sumOfSquares = 0;
+		for (const auto value : values)
+		{
+			sumOfSquares += (value - mean) * (value - mean);
+		}
+
+		return { mean, n > 1 ? std::sqrt(sumOfSquares / (n - 1)) : 0.0, static_cast<uint32_t>(n) };
+	}
+
+	double ConfidenceInterval95(const BenchmarkSweep::Statistics& stats)
+	{
+		return StudentT95(stats.Count - 1.0) * stats.StandardDeviation / std::sqrt(static_cast<double>(stats.Count));
+	}
+
+	bool IsSignificantChange(const BenchmarkSweep::Statistics& a, const BenchmarkSweep::Statistics& b)
+	{
+		// Welch's unequal variances t-test.
+		const auto va = a.StandardDeviation * a.StandardDeviation / a.Count;
+		const auto vb = b.StandardDeviation * b.StandardDeviation / b.Count;
+
+		if (va + vb == 0)
+		{
+			return a.Mean != b.Mean;
+		}
+
+		const auto t = std::abs(a.Mean - b.Mean) / std::sqrt(va + vb);
+		const auto df = (va + vb) * (va + vb) / (va * va / std::max(a.Count - 1, 1u) + vb * vb / std::max(b.Count - 1, 1u));
+
+		return t > StudentT95(df);
+	}
+
+	std::vector<uint32_t> ParseValues(std::istream& in, const std::string& key)
+	{
+		std::vector<uint32_t> values;
+		uint32_t value;
+
+		while (in >> value)
+		{
+			values.push_back(value);
+		}
+
+		if (values.empty() || !in.eof())
+		{
+			Throw(std::runtime_error("invalid benchmark sweep values for '" + key + "'"));
+		}
+
+		return values;
+	}
+
+	std::vector<std::pair<uint32_t, uint32_t>> ParseResolutions(std::istream& in)
+	{
+		std::vector<std::pair<uint32_t, uint32_t>> resolutions;
+		std::string token;
+
+		while (in >> token)
+		{
+			uint32_t width, height;
+			char x;
+			std::istringstream resolution(token);
+
+			if (!(resolution >> width >> x >> height) || x != 'x' || width == 0 || height == 0)
+			{
+				Throw(std::runtime_error("invalid benchmark sweep resolution '" + token + "'"));
+			}
+
+			resolutions.emplace_back(width, height);
+		}
+
+		return resolutions;
+	}
+
+	std::string FormatMilliseconds(const BenchmarkSweep::Statistics& stats)
+	{
+		std::ostringstream out;
+		out << std::fixed << std::setprecision(3) << stats.Mean * 1000 << " +/- " << ConfidenceInterval95(stats) * 1000 << " ms";
+		return out.str();
+	}
+
+	std::string FormatChange(const char* const label, const BenchmarkSweep::Statistics& current, const BenchmarkSweep::Statistics& baseline, const bool significant)
+	{
+		std::ostringstream out;
+		out << label << " " << std::showpos << std::fixed << std::setprecision(1) << 100 * (current.Mean / baseline.Mean - 1) << "%" << std::noshowpos;
+		out << (significant ? " (SIGNIFICANT)" : " (not significant)");
+		return out.str();
+	}
+}
+
+std::string BenchmarkSweep::Configuration::Name() const
+{
+	std::ostringstream out;
+	out << "scene" << SceneIndex << "-" << Width << "x" << Height << "-" << NumberOfSamples << "spp-" << NumberOfBounces << "bounces-present" << PresentMode;
+
+	// Material hit groups are the default, keep the names of the results from before them.
+	if (MaterialHitGroups == 0)
+	{
+		out << "-megashader";
+	}
+
+	return out.str();
+}
+
+BenchmarkSweep::BenchmarkSweep(const std::string& specFilename, const std::string& baselineFilename, std::string resultsFilename) :
+	resultsFilename_(std::move(resultsFilename))
+{
+	LoadSpec(specFilename);
+
+	if (!baselineFilename.empty())
+	{
+		LoadBaseline(baselineFilename);
+	}
+
+	std::cout << "Benchmark: sweep of " << configurations_.size() << " configurations, " << warmupFrames_ << " warmup frames and "
+		<< repetitions_ << " repetitions of " << framesPerRepetition_ << " frames each" << std::endl;
+}
+
+bool BenchmarkSweep::AddFrame(const float frameTime, const float gpuFrameTime)
+{
+	if (IsComplete())
+	{
+		return false;
+	}
+
+	if (frame_ == 0)
+	{
+		std::cout << std::endl << "Benchmark: configuration " << configurationIndex_ + 1 << "/" << configurations_.size()
+			<< " '" << CurrentConfiguration().Name() << "'" << std::endl;
+	}
+
+	// Warmup frames absorb the scene loading and swap chain recreation, and the GPU timestamps lagging behind.
+	if (frame_++ < warmupFrames_)
+	{
+		return false;
+	}
+
+	repetitionFrameTime_ += frameTime;
+	repetitionGpuFrameTime_ += gpuFrameTime;
+
+	if ((frame_ - warmupFrames_) % framesPerRepetition_ != 0)
+	{
+		return false;
+	}
+
+	repetitionFrameTimes_.push_back(repetitionFrameTime_ / framesPerRepetition_);
+	repetitionGpuFrameTimes_.push_back(repetitionGpuFrameTime_ / framesPerRepetition_);
+	repetitionFrameTime_ = 0;
+	repetitionGpuFrameTime_ = 0;
+
+	if (repetitionFrameTimes_.size() != repetitions_)
+	{
+		return false;
+	}
+
+	FinishConfiguration();
+
+	frame_ = 0;
+	repetitionFrameTimes_.clear();
+	repetitionGpuFrameTimes_.clear();
+	++configurationIndex_;
+
+	if (IsComplete())
+	{
+		WriteResults();
+	}
+
+	return true;
+}
+
+void BenchmarkSweep::LoadSpec(const std::string& filename)
+{
+	std::ifstream file(filename);
+
+	if (!file)
+	{
+		Throw(std::runtime_error("cannot open benchmark sweep spec '" + filename + "'"));
+	}
+
+	std::vector<uint32_t> scenes{ 1 };
+	std::vector<std::pair<uint32_t, uint32_t>> resolutions{ { 1280, 720 } };
+	std::vector<uint32_t> samples{ 8 };
+	std::vector<uint32_t> bounces{ 16 };
+	std::vector<uint32_t> presentModes{ 0 };
+	std::vector<uint32_t> materialHitGroups{ 1 };
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		line = line.substr(0, line.find('#'));
+
+		const auto separator = line.find('=');
+
+		if (separator == std::string::npos)
+		{
+			if (line.find_first_not_of(" \t\r") != std::string::npos)
+			{
+				Throw(std::runtime_error("invalid benchmark sweep spec line '" + line + "'"));
+			}
+
+			continue;
+		}
+
+		std::string key;
+		std::istringstream(line.substr(0, separator)) >> key;
+		std::istringstream values(line.substr(separator + 1));
+
+		if (key == "scenes") scenes = ParseValues(values, key);
+		else if (key == "resolutions") resolutions = ParseResolutions(values);
+		else if (key == "samples") samples = ParseValues(values, key);
+		else if (key == "bounces") bounces = ParseValues(values, key);
+		else if (key == "present-modes") presentModes = ParseValues(values, key);
+		else if (key == "material-hit-groups") materialHitGroups = ParseValues(values, key);
+		else if (key == "warmup-frames") warmupFrames_ = ParseValues(values, key).front();
+		else if (key == "repetitions") repetitions_ = ParseValues(values, key).front();
+		else if (key == "frames") framesPerRepetition_ = ParseValues(values, key).front();
+		else Throw(std::runtime_error("unknown benchmark sweep key '" + key + "'"));
+	}
+
+	if (repetitions_ < 2 || framesPerRepetition_ == 0 || resolutions.empty())
+	{
+		Throw(std::out_of_range("benchmark sweep needs at least 2 repetitions of 1 frame and a resolution"));
+	}
+
+	// Keep the scene outermost, scene reloads being by far the most expensive configuration change.
+	for (const auto scene : scenes)
+	{
+		if (scene >= SceneList::AllScenes.size())
+		{
+			Throw(std::out_of_range("invalid benchmark sweep scene index"));
+		}
+
+		if (*std::max_element(presentModes.begin(), presentModes.end()) > 3)
+		{
+			Throw(std::out_of_range("invalid benchmark sweep present mode"));
+		}
+
+		if (*std::max_element(materialHitGroups.begin(), materialHitGroups.end()) > 1)
+		{
+			Throw(std::out_of_range("invalid benchmark sweep material hit groups"));
+		}
+
+		for (const auto& resolution : resolutions)
+		for (const auto presentMode : presentModes)
+		for (const auto sampleCount : samples)
+		for (const auto bounceCount : bounces)
+		for (const auto hitGroups : materialHitGroups)
+		{
+			configurations_.push_back({ scene, resolution.first, resolution.second, sampleCount, bounceCount, presentMode, hitGroups });
+		}
+	}
+}
+
+void BenchmarkSweep::LoadBaseline(const std::string& filename)
+{
+	std::ifstream file(filename);
+
+	if (!file)
+	{
+		Throw(std::runtime_error("cannot open benchmark baseline '" + filename + "'"));
+	}
+
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#')
+		{
+			continue;
+		}
+
+		std::istringstream in(line);
+		Result result = {};
+		uint32_t count;
+
+		if (!(in >> result.Name >> count
+			>> result.FrameTime.Mean >> result.FrameTime.StandardDeviation
+			>> result.GpuFrameTime.Mean >> result.GpuFrameTime.StandardDeviation))
+		{
+			Throw(std::runtime_error("invalid benchmark baseline line '" + line + "'"));
+		}
+
+		result.FrameTime.Count = count;
+		result.GpuFrameTime.Count = count;
+		baseline_[result.Name] = result;
+	}
+}
+
+void BenchmarkSweep::FinishConfiguration()
+{
+	Result result = {};
+	result.Name = CurrentConfiguration().Name();
+	result.FrameTime = ComputeStatistics(repetitionFrameTimes_);
+	result.GpuFrameTime = ComputeStatistics(repetitionGpuFrameTimes_);
+
+	std::cout << "Benchmark: frame " << FormatMilliseconds(result.FrameTime) << ", GPU " << FormatMilliseconds(result.GpuFrameTime)
+		<< " (95% confidence, " << result.FrameTime.Count << " repetitions)" << std::endl;
+
+	const auto baseline = baseline_.find(result.Name);
+
+	if (baseline != baseline_.end())
+	{
+		const bool frameTimeChanged = IsSignificantChange(result.FrameTime, baseline->second.FrameTime);
+		const bool gpuFrameTimeChanged = IsSignificantChange(result.GpuFrameTime, baseline->second.GpuFrameTime);
+
+		std::cout << "Benchmark: vs baseline, "
+			<< FormatChange("frame", result.FrameTime, baseline->second.FrameTime, frameTimeChanged) << ", "
+			<< FormatChange("GPU", result.GpuFrameTime, baseline->second.GpuFrameTime, gpuFrameTimeChanged) << std::endl;
+
+		significantChanges_ += frameTimeChanged || gpuFrameTimeChanged ? 1 : 0;
+	}
+
+	results_.push_back(std::move(result));
+}
+
+void BenchmarkSweep::WriteResults() const
+{
+	std::cout << std::endl << "Benchmark: sweep complete";
+
+	if (!baseline_.empty())
+	{
+		std::cout << ", " << significantChanges_ << " configurations significantly changed against the baseline";
+	}
+
+	std::cout << std::endl;
+
+	if (resultsFilename_.empty())
+	{
+		return;
+	}
+
+	std::ofstream file(resultsFilename_);
+	file << "# name repetitions frame_mean frame_stddev gpu_mean gpu_stddev (seconds)" << std::endl;
+	file << std::setprecision(9);
+
+	for (const auto& result : results_)
+	{
+		file << result.Name << " " << result.FrameTime.Count << " "
+			<< result.FrameTime.Mean << " " << result.FrameTime.StandardDeviation << " "
+			<< result.GpuFrameTime.Mean << " " << result.GpuFrameTime.StandardDeviation << std::endl;
+	}
+
+	if (!file)
+	{
+		Throw(std::runtime_error("cannot write benchmark results '" + resultsFilename_ + "'"));
+	}
+
+	std::cout << "Benchmark: results written to '" << resultsFilename_ << "'" << std::endl;
+}
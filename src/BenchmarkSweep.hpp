@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Runs every combination of scenes x resolutions x samples x bounces x present modes x hit groups read from a spec file.
+// Each configuration renders warmup frames first, then a number of measured repetitions whose mean frame
+// times give the configuration mean and 95% confidence interval. Results are written to a file that can
+// be fed back as the baseline of a later run, flagging the statistically significant changes (Welch's t-test).
+class BenchmarkSweep final
+{
+public:
+
+	struct Configuration
+	{
+		uint32_t SceneIndex;
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t NumberOfSamples;
+		uint32_t NumberOfBounces;
+		uint32_t PresentMode;
+		uint32_t MaterialHitGroups; // 0 = megashader (see ShaderVariant::MaterialHitGroups).
+
+		std::string Name() const;
+	};
+
+	// Distribution of the per repetition mean frame times, in seconds.
+	struct Statistics
+	{
+		double Mean;
+		double StandardDeviation;
+		uint32_t Count;
+	};
+
+	BenchmarkSweep(const BenchmarkSweep&) = delete;
+	BenchmarkSweep(BenchmarkSweep&&) = delete;
+	BenchmarkSweep& operator = (const BenchmarkSweep&) = delete;
+	BenchmarkSweep& operator = (BenchmarkSweep&&) = delete;
+
+	// Spec file with one "key = values..." per line (# starts a comment):
+	// scenes, resolutions (WxH), samples, bounces, present-modes, material-hit-groups (0 1 to compare against the megashader),
+	// warmup-frames, repetitions, frames (per repetition).
+	BenchmarkSweep(const std::string& specFilename, const std::string& baselineFilename, std::string resultsFilename);
+	~BenchmarkSweep() = default;
+
+	bool IsComplete() const { return configurationIndex_ == configurations_.size(); }
+	const Configuration& CurrentConfiguration() const { return configurations_[configurationIndex_]; }
+
+	// Record a frame of the current configuration, returns true when moving on to the next configuration.
+	bool AddFrame(float frameTime, float gpuFrameTime);
+
+private:
+
+	struct Result
+	{
+		std::string Name;
+		Statistics FrameTime;
+		Statistics GpuFrameTime;
+	};
+
+	void LoadSpec(const std::string& filename);
+	void LoadBaseline(const std::string& filename);
+	void FinishConfiguration();
+	void WriteResults() const;
+
+	const std::string resultsFilename_;
+
+	std::vector<Configuration> configurations_;
+	uint32_t warmupFrames_{ 30 };
+	uint32_t repetitions_{ 5 };
+	uint32_t framesPerRepetition_{ 60 };
+
+	std::map<std::string, Result> baseline_;
+	std::vector<Result> results_;
+	uint32_t significantChanges_{};
+
+	size_t configurationIndex_{};
+	uint32_t frame_{};
+	double repetitionFrameTime_{};
+	double repetitionGpuFrameTime_{};
+	std::vector<double> repetitionFrameTimes_;
+	std::vector<double> repetitionGpuFrameTimes_;
+};
@@ -0,0 +1,266 @@
+// GPU-free microbenchmarks of the asset loading and scene assembly hot paths.
+// Usage: RayTracerCpuBenchmarks [number of synthetic triangles] (default: one million).
+
+#include "Assets/Model.hpp"
+#include "Assets/SceneGeometry.hpp"
+#include "Assets/VertexHash.hpp"
+#include "Utilities/StbImage.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+using namespace glm;
+using Assets::Material;
+using Assets::Model;
+
+// Count every heap allocation, so that the loaders allocation patterns can be tracked.
+namespace
+{
+	std::atomic<uint64_t> allocationCount{};
+}
+
+void* operator new(const size_t size)
+{
+	++allocationCount;
+
+	if (void* const p = std::malloc(size != 0 ? size : 1))
+	{
+		return p;
+	}
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](const size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* const p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* const p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* const p, size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* const p, size_t) noexcept
+{
+	std::free(p);
+}
+
+namespace
+{
+	// Silence the loaders progress output while benchmarking.
+	class NullOutput final
+	{
+	public:
+
+		NullOutput() : previous_(std::cout.rdbuf(nullptr)) { }
+		~NullOutput() { std::cout.rdbuf(previous_); }
+
+	private:
+
+		std::streambuf* const previous_;
+	};
+
+	// Run the function repeatedly for at least the given time (and 3 iterations), after one untimed warmup call.
+	template <class Function>
+	void Run(const std::string& name, const char* const unit, const size_t unitsPerCall, Function&& function)
+	{
+		const double minTime = 1.0;
+		uint64_t iterations = 0;
+		uint64_t allocations = 0;
+		double elapsed = 0;
+
+		{
+			NullOutput silence;
+			function();
+
+			while (elapsed < minTime || iterations < 3)
+			{
+				const auto allocationsBefore = allocationCount.load();
+				const auto timer = std::chrono::high_resolution_clock::now();
+
+				function();
+
+				elapsed += std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+				allocations += allocationCount.load() - allocationsBefore;
+				++iterations;
+			}
+		}
+
+		const auto nsPerCall = elapsed * 1e9 / iterations;
+
+		std::cout << std::left << std::setw(40) << name << std::right << std::fixed
+			<< std::setw(14) << std::setprecision(3) << nsPerCall / unitsPerCall << " ns/" << std::left << std::setw(9) << unit << std::right
+			<< std::setw(14) << std::setprecision(3) << nsPerCall / 1e6 << " ms/call"
+			<< std::setw(12) << std::setprecision(1) << static_cast<double>(allocations) / iterations << " allocs/call"
+			<< std::setw(8) << iterations << " calls" << std::endl;
+	}
+
+	// A wavy grid with positions, normals and texture coordinates, sharing vertices between faces like a typical scanned mesh.
+	std::string GenerateGridObj(const size_t triangleCount)
+	{
+		const auto n = static_cast<size_t>(std::ceil(std::sqrt(triangleCount / 2.0)));
+		const auto filename = (std::filesystem::temp_directory_path() / ("RayTracerCpuBenchmarks-grid-" + std::to_string(n) + ".obj")).string();
+
+		if (std::filesystem::exists(filename))
+		{
+			return filename;
+		}
+
+		std::ofstream file(filename);
+		file << std::setprecision(7);
+
+		for (size_t y = 0; y <= n; ++y)
+		{
+			for (size_t x = 0; x <= n; ++x)
+			{
+				const float u = static_cast<float>(x) / n;
+				const float v = static_cast<float>(y) / n;
+				const float h = 0.05f * std::sin(20 * u) * std::cos(20 * v);
+
+				file << "v " << u << " " << h << " " << v << "\n";
+				file << "vn " << -std::cos(20 * u) * std::cos(20 * v) << " 1 " << std::sin(20 * u) * std::sin(20 * v) << "\n";
+				file << "vt " << u << " " << v << "\n";
+			}
+		}
+
+		for (size_t y = 0; y != n; ++y)
+		{
+			for (size_t x = 0; x != n; ++x)
+			{
+				const auto i0 = y * (n + 1) + x + 1;
+				const auto i1 = i0 + 1;
+				const auto i2 = i0 + n + 1;
+				const auto i3 = i2 + 1;
+
+				file << "f " << i0 << "/" << i0 << "/" << i0 << " " << i2 << "/" << i2 << "/" << i2 << " " << i1 << "/" << i1 << "/" << i1 << "\n";
+				file << "f " << i1 << "/" << i1 << "/" << i1 << " " << i2 << "/" << i2 << "/" << i2 << " " << i3 << "/" << i3 << "/" << i3 << "\n";
+			}
+		}
+
+		return filename;
+	}
+
+	void BenchmarkModel(const std::string& name, const std::string& filename)
+	{
+		auto model = [&filename]()
+		{
+			NullOutput silence;
+			return Model::LoadModel(filename);
+		}();
+
+		const auto triangles = model.NumberOfIndices() / 3;
+		const auto vertices = model.NumberOfVertices();
+
+		std::cout << name << ": " << vertices << " vertices, " << triangles << " triangles" << std::endl;
+
+		Run("Model::LoadModel", "triangle", triangles, [&]() { Model::LoadModel(filename); });
+		Run("Model::Transform", "vertex", vertices, [&]() { model.Transform(rotate(mat4(1), 0.1f, vec3(0, 1, 0))); });
+
+		volatile size_t sink = 0;
+		Run("std::hash<Vertex>", "vertex", vertices, [&]()
+		{
+			size_t h = 0;
+			for (const auto& vertex : model.Vertices())
+			{
+				h ^= std::hash<Assets::Vertex>()(vertex);
+			}
+			sink = sink + h;
+		});
+
+		std::cout << std::endl;
+	}
+}
+
+int main(int argc, const char* argv[]) noexcept
+{
+	try
+	{
+		const size_t triangleCount = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+		// Synthetic mesh.
+		BenchmarkModel("Synthetic grid", GenerateGridObj(triangleCount));
+
+		// Real mesh, when run from the binary directory like the application.
+		const std::string lucy = "../assets/models/lucy.obj";
+		if (std::filesystem::exists(lucy))
+		{
+			BenchmarkModel("Lucy", lucy);
+		}
+
+		// Tessellated sphere.
+		{
+			const auto sphere = Model::CreateSphere(vec3(0), 1.0f, Material::Lambertian(vec3(1)), false);
+			Run("Model::CreateSphere", "vertex", sphere.NumberOfVertices(), [&]()
+			{
+				Model::CreateSphere(vec3(0), 1.0f, Material::Lambertian(vec3(1)), false);
+			});
+		}
+
+		// Scene assembly, a Ray Tracing In One Weekend like scene of procedural spheres plus a few meshes.
+		{
+			std::vector<Model> models;
+
+			for (int i = 0; i != 500; ++i)
+			{
+				models.push_back(Model::CreateSphere(vec3(i, 0, 0), 0.2f, Material::Lambertian(vec3(0.5f)), true));
+			}
+
+			{
+				NullOutput silence;
+				for (int i = 0; i != 3; ++i)
+				{
+					models.push_back(Model::LoadModel(GenerateGridObj(triangleCount / 3)));
+				}
+			}
+
+			size_t vertices = 0;
+			for (const auto& model : models)
+			{
+				vertices += model.NumberOfVertices();
+			}
+
+			Run("SceneGeometry::Concatenate", "vertex", vertices, [&]() { Assets::SceneGeometry::Concatenate(models); });
+		}
+
+		// Texture decoding (stb allocates with malloc, which is not counted).
+		const std::string texture = "../assets/textures/land_ocean_ice_cloud_2048.png";
+		if (std::filesystem::exists(texture))
+		{
+			int width, height, channels;
+			stbi_image_free(stbi_load(texture.c_str(), &width, &height, &channels, STBI_rgb_alpha));
+
+			Run("stbi_load", "pixel", static_cast<size_t>(width) * height, [&]()
+			{
+				stbi_image_free(stbi_load(texture.c_str(), &width, &height, &channels, STBI_rgb_alpha));
+			});
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	catch (const std::exception& exception)
+	{
+		std::cerr << "FATAL: " << exception.what() << std::endl;
+	}
+
+	return EXIT_FAILURE;
+}
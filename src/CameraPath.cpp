@@ -0,0 +1,120 @@
+#include "CameraPath.hpp"
+#include "Utilities/Exception.hpp"
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	glm::quat Orientation(const CameraPath::Keyframe& keyframe)
+	{
+		return glm::quat_cast(glm::mat3(glm::lookAt(keyframe.Position, keyframe.Target, glm::vec3(0, 1, 0))));
+	}
+
+	glm::vec3 CatmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, const float t)
+	{
+		const float t2 = t * t;
+		const float t3 = t2 * t;
+
+		return 0.5f * (
+			2.0f * p1 +
+			(p2 - p0) * t +
+			(2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+			(3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+	}
+}
+
+CameraPath CameraPath::Load(const std::string& filename)
+{
+	std::ifstream file(filename);
+
+	if (!file)
+	{
+		Throw(std::runtime_error("cannot open camera path '" + filename + "'"));
+	}
+
+	std::vector<Keyframe> keyframes;
+	std::string line;
+	size_t lineNumber = 0;
+
+	while (std::getline(file, line))
+	{
+		++lineNumber;
+
+		line = line.substr(0, line.find('#'));
+
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+		{
+			continue;
+		}
+
+		std::istringstream in(line);
+		Keyframe k = {};
+
+		if (!(in >> k.Time >> k.Position.x >> k.Position.y >> k.Position.z >> k.Target.x >> k.Target.y >> k.Target.z >> k.FieldOfView >> k.Aperture >> k.FocusDistance))
+		{
+			Throw(std::runtime_error("invalid keyframe at line " + std::to_string(lineNumber) + " of camera path '" + filename + "'"));
+		}
+
+		keyframes.push_back(k);
+	}
+
+	return CameraPath(std::move(keyframes));
+}
+
+CameraPath::CameraPath(std::vector<Keyframe> keyframes) :
+	keyframes_(std::move(keyframes))
+{
+	if (keyframes_.empty())
+	{
+		Throw(std::invalid_argument("camera path has no keyframes"));
+	}
+
+	const auto isSorted = std::is_sorted(keyframes_.begin(), keyframes_.end(), [](const Keyframe& a, const Keyframe& b)
+	{
+		return a.Time < b.Time;
+	});
+
+	if (!isSorted)
+	{
+		Throw(std::invalid_argument("camera path keyframes are not sorted by time"));
+	}
+}
+
+uint32_t CameraPath::NumberOfFrames(const float framesPerSecond) const
+{
+	return static_cast<uint32_t>(Duration() * framesPerSecond) + 1;
+}
+
+CameraPath::Camera CameraPath::Evaluate(const float time) const
+{
+	// Find the segment [i, i + 1] containing the given time, clamping at both ends.
+	const auto next = std::upper_bound(keyframes_.begin(), keyframes_.end(), time, [](const float t, const Keyframe& k)
+	{
+		return t < k.Time;
+	});
+
+	const size_t i1 = std::min(static_cast<size_t>(std::max<ptrdiff_t>(next - keyframes_.begin(), 1)), keyframes_.size() - 1);
+	const size_t i0 = keyframes_.size() == 1 ? 0 : i1 - 1;
+	const auto& k0 = keyframes_[i0];
+	const auto& k1 = keyframes_[i1];
+
+	const float duration = k1.Time - k0.Time;
+	const float t = duration > 0 ? glm::clamp((time - k0.Time) / duration, 0.0f, 1.0f) : 0.0f;
+
+	// Neighbouring keyframes for the spline tangents, duplicating the end points.
+	const auto& p0 = keyframes_[i0 == 0 ? i0 : i0 - 1].Position;
+	const auto& p3 = keyframes_[std::min(i1 + 1, keyframes_.size() - 1)].Position;
+
+	const auto position = CatmullRom(p0, k0.Position, k1.Position, p3, t);
+	const auto orientation = glm::slerp(Orientation(k0), Orientation(k1), t);
+
+	Camera camera = {};
+	camera.ModelView = glm::mat4_cast(orientation) * glm::translate(glm::mat4(1), -position);
+	camera.FieldOfView = glm::mix(k0.FieldOfView, k1.FieldOfView, t);
+	camera.Aperture = glm::mix(k0.Aperture, k1.Aperture, t);
+	camera.FocusDistance = glm::mix(k0.FocusDistance, k1.FocusDistance, t);
+
+	return camera;
+}
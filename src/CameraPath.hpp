@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Utilities/Glm.hpp"
+#include <string>
+#include <vector>
+
+// A keyframed camera animation. Positions follow a Catmull-Rom spline through the keyframes, orientations
+// are spherically interpolated, and the lens parameters are linearly interpolated.
+class CameraPath final
+{
+public:
+
+	struct Keyframe
+	{
+		float Time; // In seconds.
+		glm::vec3 Position;
+		glm::vec3 Target; // Look-at point, the up vector being +Y.
+		float FieldOfView;
+		float Aperture;
+		float FocusDistance;
+	};
+
+	struct Camera
+	{
+		glm::mat4 ModelView;
+		float FieldOfView;
+		float Aperture;
+		float FocusDistance;
+	};
+
+	// Text file with one keyframe per line: time px py pz tx ty tz fov aperture focus (# starts a comment).
+	static CameraPath Load(const std::string& filename);
+
+	explicit CameraPath(std::vector<Keyframe> keyframes);
+
+	float Duration() const { return keyframes_.back().Time; }
+	uint32_t NumberOfFrames(float framesPerSecond) const;
+
+	Camera Evaluate(float time) const;
+
+private:
+
+	std::vector<Keyframe> keyframes_;
+};
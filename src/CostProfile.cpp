@@ -0,0 +1,113 @@
+#include "CostProfile.hpp"
+#include "Assets/Model.hpp"
+#include "Assets/Scene.hpp"
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+	const char* const MaterialModelNames[Assets::Material::NumberOfModels] =
+	{
+		"Lambertian",
+		"Metallic",
+		"Dielectric",
+		"Isotropic",
+		"DiffuseLight"
+	};
+}
+
+void CostProfile::Reset(const Assets::Scene& scene)
+{
+	instanceNames_.clear();
+
+	for (const auto& model : scene.Models())
+	{
+		const auto index = std::to_string(instanceNames_.size());
+
+		instanceNames_.push_back(model.Procedural()
+			? "#" + index + " sphere"
+			: "#" + index + " mesh (" + std::to_string(model.NumberOfIndices() / 3) + " triangles)");
+	}
+
+	totals_.assign(Assets::Material::NumberOfModels + instanceNames_.size(), {});
+	numberOfFrames_ = 0;
+}
+
+void CostProfile::AddFrame(const std::vector<Vulkan::RayTracing::CostBucket>& buckets)
+{
+	// Buckets of a different scene may still be in flight.
+	if (buckets.size() != totals_.size())
+	{
+		return;
+	}
+
+	for (size_t i = 0; i != buckets.size(); ++i)
+	{
+		totals_[i].Clocks += buckets[i].Clocks();
+		totals_[i].Hits += buckets[i].Hits;
+		totals_[i].Intersections += buckets[i].Intersections;
+	}
+
+	++numberOfFrames_;
+}
+
+std::vector<CostProfile::Entry> CostProfile::MaterialModels() const
+{
+	return Sorted(0, Assets::Material::NumberOfModels);
+}
+
+std::vector<CostProfile::Entry> CostProfile::Instances() const
+{
+	return Sorted(Assets::Material::NumberOfModels, totals_.size());
+}
+
+void CostProfile::Print(std::ostream& out, const size_t maxInstances) const
+{
+	const auto print = [&out](const std::vector<Entry>& entries, const size_t count)
+	{
+		for (size_t i = 0; i != std::min(count, entries.size()) && entries[i].Clocks != 0; ++i)
+		{
+			const auto& entry = entries[i];
+
+			out << "Benchmark:   " << std::left << std::setw(32) << entry.Name << std::right << std::fixed
+				<< std::setw(6) << std::setprecision(1) << entry.ClockShare * 100 << "% clocks, "
+				<< std::setw(12) << entry.Hits << " hits, "
+				<< std::setw(12) << entry.Intersections << " intersections, "
+				<< std::setw(8) << std::setprecision(0) << entry.ClocksPerInvocation() << " clocks/invocation" << std::endl;
+		}
+
+		out << std::defaultfloat;
+	};
+
+	out << "Benchmark: shader costs per material model over " << numberOfFrames_ << " frames" << std::endl;
+	print(MaterialModels(), Assets::Material::NumberOfModels);
+
+	out << "Benchmark: shader costs of the " << maxInstances << " most expensive instances" << std::endl;
+	print(Instances(), maxInstances);
+}
+
+std::vector<CostProfile::Entry> CostProfile::Sorted(const size_t first, const size_t last) const
+{
+	// Every invocation is counted in both its material model and its instance bucket.
+	uint64_t totalClocks = 0;
+
+	for (size_t i = 0; i != std::min<size_t>(Assets::Material::NumberOfModels, totals_.size()); ++i)
+	{
+		totalClocks += totals_[i].Clocks;
+	}
+
+	std::vector<Entry> entries;
+
+	for (size_t i = first; i < last; ++i)
+	{
+		const auto& total = totals_[i];
+		const std::string name = i < Assets::Material::NumberOfModels ? MaterialModelNames[i] : instanceNames_[i - Assets::Material::NumberOfModels];
+		const double share = totalClocks != 0 ? static_cast<double>(total.Clocks) / totalClocks : 0;
+
+		entries.push_back({ name, share, total.Clocks, total.Hits, total.Intersections });
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.Clocks > b.Clocks; });
+
+	return entries;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Vulkan/RayTracing/ShaderCounters.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Assets
+{
+	class Scene;
+}
+
+// Accumulates the per frame hit and intersection shader costs (see Vulkan::RayTracing::CostBucket) into
+// per material model and per instance totals, ranked by their share of the shader clocks.
+class CostProfile final
+{
+public:
+
+	struct Entry
+	{
+		std::string Name;
+		double ClockShare;
+		uint64_t Clocks;
+		uint64_t Hits;
+		uint64_t Intersections;
+
+		double ClocksPerInvocation() const { return Hits + Intersections != 0 ? static_cast<double>(Clocks) / (Hits + Intersections) : 0; }
+	};
+
+	CostProfile(const CostProfile&) = delete;
+	CostProfile(CostProfile&&) = delete;
+	CostProfile& operator = (const CostProfile&) = delete;
+	CostProfile& operator = (CostProfile&&) = delete;
+
+	CostProfile() = default;
+	~CostProfile() = default;
+
+	// Clear the totals, naming the instances after the scene models.
+	void Reset(const Assets::Scene& scene);
+
+	void AddFrame(const std::vector<Vulkan::RayTracing::CostBucket>& buckets);
+
+	uint32_t NumberOfFrames() const { return numberOfFrames_; }
+
+	// Sorted by decreasing clocks.
+	std::vector<Entry> MaterialModels() const;
+	std::vector<Entry> Instances() const;
+
+	void Print(std::ostream& out, size_t maxInstances) const;
+
+private:
+
+	struct Totals
+	{
+		uint64_t Clocks;
+		uint64_t Hits;
+		uint64_t Intersections;
+	};
+
+	std::vector<Entry> Sorted(size_t first, size_t last) const;
+
+	std::vector<std::string> instanceNames_;
+	std::vector<Totals> totals_;
+	uint32_t numberOfFrames_{};
+};
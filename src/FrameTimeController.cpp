@@ -0,0 +1,86 @@
+#include "FrameTimeController.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Smoothing of the reported frame and sample times.
+	const double ReportSmoothing = 0.1;
+
+	// Fraction of the error corrected per measured frame. A frame over budget is a visible hitch, while the
+	// headroom of a frame under budget is mostly measurement noise until it has been seen a few times.
+	const double DecreaseGain = 0.5;
+	const double IncreaseGain = 0.125;
+
+	// Every render scale change resets the accumulation, it moves in coarse steps and only goes back up
+	// once the work is well past the next step.
+	const double RenderScaleStep = 0.125;
+}
+
+FrameTimeController::FrameTimeController(const uint32_t framesInFlight) :
+	slotWork_(framesInFlight)
+{
+}
+
+void FrameTimeController::Reset(const uint32_t numberOfSamples, const float renderScale)
+{
+	std::fill(slotWork_.begin(), slotWork_.end(), 0);
+	work_ = std::clamp(numberOfSamples, MinNumberOfSamples, MaxNumberOfSamples) * renderScale * renderScale;
+	renderScale_ = renderScale;
+	frameTime_ = 0;
+	sampleTime_ = 0;
+}
+
+void FrameTimeController::SetTarget(const double frameTime, const float minRenderScale, const float maxRenderScale)
+{
+	targetFrameTime_ = frameTime;
+	minRenderScale_ = minRenderScale;
+	maxRenderScale_ = maxRenderScale;
+	renderScale_ = std::clamp(renderScale_, minRenderScale_, maxRenderScale_);
+}
+
+void FrameTimeController::AddFrame(const uint32_t frameIndex, const double gpuFrameTime, const uint32_t numberOfSamples, const float renderScale)
+{
+	const auto measuredWork = slotWork_[frameIndex];
+	slotWork_[frameIndex] = static_cast<double>(numberOfSamples) * renderScale * renderScale;
+
+	if (measuredWork <= 0 || gpuFrameTime <= 0 || targetFrameTime_ <= 0)
+	{
+		return;
+	}
+
+	const auto sampleTime = gpuFrameTime / measuredWork;
+	frameTime_ = frameTime_ > 0 ? frameTime_ + ReportSmoothing * (gpuFrameTime - frameTime_) : gpuFrameTime;
+	sampleTime_ = sampleTime_ > 0 ? sampleTime_ + ReportSmoothing * (sampleTime - sampleTime_) : sampleTime;
+
+	// The work that would have met the target on the measured frame. Its fixed cost makes this an
+	// underestimate when over budget and an overestimate when under, but the fixed point is the target itself.
+	const auto targetWork = measuredWork * targetFrameTime_ / gpuFrameTime;
+	const auto gain = targetWork < work_ ? DecreaseGain : IncreaseGain;
+
+	work_ = std::clamp(
+		work_ + gain * (targetWork - work_),
+		static_cast<double>(MinNumberOfSamples) * minRenderScale_ * minRenderScale_,
+		static_cast<double>(MaxNumberOfSamples) * maxRenderScale_ * maxRenderScale_);
+
+	UpdateRenderScale();
+}
+
+uint32_t FrameTimeController::NumberOfSamples() const
+{
+	// Round down, staying on the safe side of the budget.
+	const auto numberOfSamples = static_cast<uint32_t>(work_ / (static_cast<double>(renderScale_) * renderScale_));
+
+	return std::clamp(numberOfSamples, MinNumberOfSamples, MaxNumberOfSamples);
+}
+
+void FrameTimeController::UpdateRenderScale()
+{
+	// The largest scale affording a single sample per frame.
+	const auto scale = std::min(std::sqrt(work_), static_cast<double>(maxRenderScale_));
+
+	if (scale < renderScale_ || scale >= std::min(renderScale_ + 1.5 * RenderScaleStep, static_cast<double>(maxRenderScale_)))
+	{
+		renderScale_ = std::clamp(static_cast<float>(std::floor(scale / RenderScaleStep) * RenderScaleStep), minRenderScale_, maxRenderScale_);
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Closed-loop control of the work per frame, so that the GPU frame time meets a target budget.
+// The work of a frame is its number of samples times its fraction of the pixels (i.e. the render scale squared).
+// The GPU time of a frame is only known once its frame in flight slot comes round again, so the work of each slot
+// is remembered to pair it with its measured time. The frame time being roughly a fixed cost plus a cost per unit
+// of work, scaling the measured work by target / measured time converges onto the budget.
+// Overshoots are corrected quickly to keep interactive sessions smooth, spare headroom is taken up gradually.
+// Samples are traded first, the render scale only drops once down to a single sample per frame.
+class FrameTimeController final
+{
+public:
+
+	FrameTimeController(const FrameTimeController&) = delete;
+	FrameTimeController(FrameTimeController&&) = delete;
+	FrameTimeController& operator = (const FrameTimeController&) = delete;
+	FrameTimeController& operator = (FrameTimeController&&) = delete;
+
+	explicit FrameTimeController(uint32_t framesInFlight);
+	~FrameTimeController() = default;
+
+	static constexpr uint32_t MinNumberOfSamples = 1;
+	static constexpr uint32_t MaxNumberOfSamples = 128;
+
+	// Forget the frames in flight (e.g. when the scene changes) and restart from the given settings.
+	void Reset(uint32_t numberOfSamples, float renderScale);
+
+	// The target GPU frame time (in seconds) and the render scale range to choose from (a single value when fixed).
+	void SetTarget(double frameTime, float minRenderScale, float maxRenderScale);
+
+	// Pair the GPU time (in seconds) of the frame that last used this slot with its work, update the controller
+	// with it, then remember the work of the new frame (no samples when not tracing, e.g. converged).
+	void AddFrame(uint32_t frameIndex, double gpuFrameTime, uint32_t numberOfSamples, float renderScale);
+
+	uint32_t NumberOfSamples() const;
+	float RenderScale() const { return renderScale_; }
+
+	// Smoothed GPU time of the measured frames and their time per full scale sample (including its share
+	// of the fixed cost), in seconds.
+	double FrameTime() const { return frameTime_; }
+	double SampleTime() const { return sampleTime_; }
+
+private:
+
+	void UpdateRenderScale();
+
+	std::vector<double> slotWork_;
+	double targetFrameTime_{};
+	float minRenderScale_{ 1.0f };
+	float maxRenderScale_{ 1.0f };
+
+	double work_{ MinNumberOfSamples };
+	float renderScale_{ 1.0f };
+	double frameTime_{};
+	double sampleTime_{};
+};
@@ -0,0 +1,348 @@
+#include "ImageCapture.hpp"
+#include "Utilities/Exception.hpp"
+#include "Utilities/StbImage.hpp"
+#include "Utilities/Tracer.hpp"
+#include "Vulkan/Buffer.hpp"
+#include "Vulkan/Device.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#ifdef WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+ImageCapture::Readback::~Readback()
+{
+	Release();
+}
+
+void ImageCapture::Readback::Release()
+{
+	if (accumulationData_ != nullptr)
+	{
+		accumulationBufferMemory_->Unmap();
+		outputBufferMemory_->Unmap();
+		accumulationData_ = nullptr;
+		outputData_ = nullptr;
+	}
+
+	accumulationBuffer_.reset();
+	accumulationBufferMemory_.reset(); // release memory after bound buffer has been destroyed
+	outputBuffer_.reset();
+	outputBufferMemory_.reset(); // release memory after bound buffer has been destroyed
+}
+
+void ImageCapture::Readback::Allocate(const Vulkan::Device& device, const VkExtent2D extent)
+{
+	Release();
+
+	const auto pixelCount = static_cast<size_t>(extent.width) * extent.height;
+	const auto accumulationSize = pixelCount * 4 * sizeof(float);
+	const auto outputSize = pixelCount * 4;
+	const auto memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+	accumulationBuffer_.reset(new Vulkan::Buffer(device, accumulationSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT));
+	accumulationBufferMemory_.reset(new Vulkan::DeviceMemory(accumulationBuffer_->AllocateMemory(memoryFlags)));
+	outputBuffer_.reset(new Vulkan::Buffer(device, outputSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT));
+	outputBufferMemory_.reset(new Vulkan::DeviceMemory(outputBuffer_->AllocateMemory(memoryFlags)));
+
+	// Persistently mapped, only read by the writer thread once the copies have completed.
+	accumulationData_ = static_cast<const float*>(accumulationBufferMemory_->Map(0, accumulationSize));
+	outputData_ = static_cast<const uint8_t*>(outputBufferMemory_->Map(0, outputSize));
+
+	extent_ = extent;
+}
+
+ImageCapture::ImageCapture(const Vulkan::Device& device, const uint32_t framesInFlight) :
+	device_(device)
+{
+	// One more than the frames in flight gives the writer thread a frame worth of slack.
+	for (uint32_t i = 0; i != framesInFlight + 1; ++i)
+	{
+		readbacks_.emplace_back(new Readback());
+	}
+
+	writerThread_ = std::thread([this]() { WriterThread(); });
+}
+
+ImageCapture::~ImageCapture()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		exit_ = true;
+	}
+
+	condition_.notify_one();
+	writerThread_.join();
+
+	if (videoStream_ != nullptr && videoStream_ != stdout)
+	{
+		std::fclose(videoStream_);
+	}
+
+	videoStream_ = nullptr;
+	readbacks_.clear();
+}
+
+const ImageCapture::Readback* ImageCapture::Acquire(
+	const uint32_t frameIndex,
+	const VkExtent2D extent,
+	const VkFormat outputFormat,
+	const uint32_t numberOfSamples,
+	std::string filename)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	const auto readback = FindFreeReadback(extent);
+
+	if (readback == nullptr)
+	{
+		std::cerr << "WARNING: skipped capture '" << filename << "', the writer thread is lagging behind" << std::endl;
+		return nullptr;
+	}
+
+	readback->state_ = Readback::State::Recorded;
+	readback->isVideoFrame_ = false;
+	readback->frameIndex_ = frameIndex;
+	readback->outputFormat_ = outputFormat;
+	readback->numberOfSamples_ = numberOfSamples;
+	readback->filename_ = std::move(filename);
+
+	return readback;
+}
+
+const ImageCapture::Readback* ImageCapture::AcquireVideoFrame(const uint32_t frameIndex, const VkExtent2D extent, const VkFormat outputFormat)
+{
+	if (videoStream_ == nullptr)
+	{
+		Throw(std::logic_error("video stream has not been opened"));
+	}
+
+	// A raw stream has no header, a frame of another size would shear every frame after it.
+	if (extent.width != videoExtent_.width || extent.height != videoExtent_.height)
+	{
+		Throw(std::logic_error("video frame extent does not match the video stream one"));
+	}
+
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	Readback* readback = nullptr;
+	freeCondition_.wait(lock, [&]() { return (readback = FindFreeReadback(extent)) != nullptr; });
+
+	readback->state_ = Readback::State::Recorded;
+	readback->isVideoFrame_ = true;
+	readback->frameIndex_ = frameIndex;
+	readback->outputFormat_ = outputFormat;
+	readback->numberOfSamples_ = 0;
+	readback->filename_.clear();
+
+	return readback;
+}
+
+void ImageCapture::OpenVideoStream(const std::string& target, const VkExtent2D extent)
+{
+	videoExtent_ = extent;
+
+	if (target == "-")
+	{
+		videoStream_ = stdout;
+#ifdef WIN32
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+	}
+	else
+	{
+		videoStream_ = std::fopen(target.c_str(), "wb");
+	}
+
+	if (videoStream_ == nullptr)
+	{
+		Throw(std::runtime_error("cannot open video stream '" + target + "'"));
+	}
+}
+
+void ImageCapture::Collect(const uint32_t frameIndex)
+{
+	bool notify = false;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		for (auto& readback : readbacks_)
+		{
+			if (readback->state_ == Readback::State::Recorded && readback->frameIndex_ == frameIndex)
+			{
+				readback->state_ = Readback::State::Writing;
+				queue_.push_back(readback.get());
+				notify = true;
+			}
+		}
+	}
+
+	if (notify)
+	{
+		condition_.notify_one();
+	}
+}
+
+void ImageCapture::CollectAll()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		for (auto& readback : readbacks_)
+		{
+			if (readback->state_ == Readback::State::Recorded)
+			{
+				readback->state_ = Readback::State::Writing;
+				queue_.push_back(readback.get());
+			}
+		}
+	}
+
+	condition_.notify_one();
+}
+
+ImageCapture::Readback* ImageCapture::FindFreeReadback(const VkExtent2D extent)
+{
+	for (auto& readback : readbacks_)
+	{
+		if (readback->state_ != Readback::State::Free)
+		{
+			continue;
+		}
+
+		// The writer thread never touches a free readback, it is safe to reallocate it.
+		if (readback->extent_.width != extent.width || readback->extent_.height != extent.height)
+		{
+			readback->Allocate(device_, extent);
+		}
+
+		return readback.get();
+	}
+
+	return nullptr;
+}
+
+void ImageCapture::WriterThread()
+{
+	Utilities::Tracer::SetThreadName("ImageCapture");
+
+	for (;;)
+	{
+		Readback* readback;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this]() { return !queue_.empty() || exit_; });
+
+			// Drain the queue before exiting.
+			if (queue_.empty())
+			{
+				return;
+			}
+
+			readback = queue_.front();
+			queue_.pop_front();
+		}
+
+		try
+		{
+			Utilities::Tracer::Zone zone(readback->isVideoFrame_ ? "WriteVideoFrame" : "WriteCapture", readback->filename_);
+			readback->isVideoFrame_ ? WriteVideoFrame(*readback) : Write(*readback);
+		}
+		catch (const std::exception& exception)
+		{
+			std::cerr << "WARNING: failed to write capture '" << readback->filename_ << "' (" << exception.what() << ")" << std::endl;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			readback->state_ = Readback::State::Free;
+		}
+
+		freeCondition_.notify_one();
+	}
+}
+
+void ImageCapture::WriteVideoFrame(const Readback& readback)
+{
+	const auto pixels = OutputToRgb(readback);
+
+	if (std::fwrite(pixels.data(), 1, pixels.size(), videoStream_) != pixels.size() || std::fflush(videoStream_) != 0)
+	{
+		Throw(std::runtime_error("cannot write video frame"));
+	}
+}
+
+std::vector<uint8_t> ImageCapture::OutputToRgb(const Readback& readback)
+{
+	// The alpha channel is not meaningful, and the swap chain format may be BGRA.
+	const bool isBgra = readback.outputFormat_ == VK_FORMAT_B8G8R8A8_UNORM || readback.outputFormat_ == VK_FORMAT_B8G8R8A8_SRGB;
+	const auto pixelCount = static_cast<size_t>(readback.extent_.width) * readback.extent_.height;
+	std::vector<uint8_t> pixels(pixelCount * 3);
+
+	for (size_t i = 0; i != pixelCount; ++i)
+	{
+		const uint8_t* src = readback.outputData_ + i * 4;
+
+		pixels[i * 3 + 0] = src[isBgra ? 2 : 0];
+		pixels[i * 3 + 1] = src[1];
+		pixels[i * 3 + 2] = src[isBgra ? 0 : 2];
+	}
+
+	return pixels;
+}
+
+void ImageCapture::Write(const Readback& readback)
+{
+	const auto timer = std::chrono::high_resolution_clock::now();
+	const auto width = readback.extent_.width;
+	const auto height = readback.extent_.height;
+
+	// Linear color averaged over the accumulated samples, as a little endian PFM (stored bottom to top).
+	{
+		const auto scale = 1.0f / std::max(readback.numberOfSamples_, 1u);
+		const auto filename = readback.filename_ + ".pfm";
+		std::ofstream file(filename, std::ios::binary);
+		std::vector<float> row(static_cast<size_t>(width) * 3);
+
+		file << "PF\n" << width << " " << height << "\n-1.0\n";
+
+		for (uint32_t y = height; y-- != 0; )
+		{
+			const float* src = readback.accumulationData_ + static_cast<size_t>(y) * width * 4;
+
+			for (uint32_t x = 0; x != width; ++x)
+			{
+				row[x * 3 + 0] = src[x * 4 + 0] * scale;
+				row[x * 3 + 1] = src[x * 4 + 1] * scale;
+				row[x * 3 + 2] = src[x * 4 + 2] * scale;
+			}
+
+			file.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(float));
+		}
+
+		if (!file)
+		{
+			Throw(std::runtime_error("cannot write '" + filename + "'"));
+		}
+	}
+
+	// Tone mapped output as an RGB PNG.
+	{
+		const auto filename = readback.filename_ + ".png";
+		const auto pixels = OutputToRgb(readback);
+
+		if (!stbi_write_png(filename.c_str(), static_cast<int>(width), static_cast<int>(height), 3, pixels.data(), static_cast<int>(width * 3)))
+		{
+			Throw(std::runtime_error("cannot write '" + filename + "'"));
+		}
+	}
+
+	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+	std::cout << "- captured '" << readback.filename_ << "' (" << width << "x" << height << ", " << readback.numberOfSamples_ << " samples) in " << elapsed << "s" << std::endl;
+}
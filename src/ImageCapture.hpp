@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Vulkan/Vulkan.hpp"
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Vulkan
+{
+	class Buffer;
+	class Device;
+	class DeviceMemory;
+}
+
+// Captures the accumulation image (as a linear PFM) and the output image (as a PNG) without stalling the renderer.
+// The frame command buffer copies the images into a ring of host-visible buffers; once that frame slot comes
+// around again (i.e. its fence has been waited upon), the buffers are handed to a writer thread.
+// Video frames are written in submission order as raw RGB24 to a stream, for an external encoder to consume.
+class ImageCapture final
+{
+public:
+
+	class Readback final
+	{
+	public:
+
+		Readback(const Readback&) = delete;
+		Readback(Readback&&) = delete;
+		Readback& operator = (const Readback&) = delete;
+		Readback& operator = (Readback&&) = delete;
+
+		Readback() = default;
+		~Readback();
+
+		const Vulkan::Buffer& AccumulationBuffer() const { return *accumulationBuffer_; }
+		const Vulkan::Buffer& OutputBuffer() const { return *outputBuffer_; }
+
+	private:
+
+		friend class ImageCapture;
+
+		enum class State { Free, Recorded, Writing };
+
+		void Allocate(const Vulkan::Device& device, VkExtent2D extent);
+		void Release();
+
+		State state_{ State::Free };
+		bool isVideoFrame_{};
+		uint32_t frameIndex_{};
+		VkExtent2D extent_{};
+		VkFormat outputFormat_{};
+		uint32_t numberOfSamples_{};
+		std::string filename_;
+
+		std::unique_ptr<Vulkan::Buffer> accumulationBuffer_;
+		std::unique_ptr<Vulkan::DeviceMemory> accumulationBufferMemory_;
+		std::unique_ptr<Vulkan::Buffer> outputBuffer_;
+		std::unique_ptr<Vulkan::DeviceMemory> outputBufferMemory_;
+		const float* accumulationData_{};
+		const uint8_t* outputData_{};
+	};
+
+	ImageCapture(const ImageCapture&) = delete;
+	ImageCapture(ImageCapture&&) = delete;
+	ImageCapture& operator = (const ImageCapture&) = delete;
+	ImageCapture& operator = (ImageCapture&&) = delete;
+
+	ImageCapture(const Vulkan::Device& device, uint32_t framesInFlight);
+	~ImageCapture();
+
+	// Find a free readback for the given frame slot, returns nullptr if the writer thread is lagging behind.
+	// The output image is expected to be 8 bits per channel RGBA or BGRA.
+	const Readback* Acquire(uint32_t frameIndex, VkExtent2D extent, VkFormat outputFormat, uint32_t numberOfSamples, std::string filename);
+
+	// Same as above for a video frame, but waits for the writer thread rather than dropping the frame.
+	// Throws if the extent differs from the one the stream was opened with.
+	const Readback* AcquireVideoFrame(uint32_t frameIndex, VkExtent2D extent, VkFormat outputFormat);
+
+	// Open the video frames stream, either "-" for stdout or a file / named pipe. All its frames have the given extent.
+	void OpenVideoStream(const std::string& target, VkExtent2D extent);
+
+	// Hand the readbacks recorded for the given frame slot over to the writer thread, the frame must have completed.
+	void Collect(uint32_t frameIndex);
+
+	// Hand all the recorded readbacks over to the writer thread, the device must be idle.
+	void CollectAll();
+
+private:
+
+	Readback* FindFreeReadback(VkExtent2D extent);
+	void WriterThread();
+	void WriteVideoFrame(const Readback& readback);
+	static std::vector<uint8_t> OutputToRgb(const Readback& readback);
+	static void Write(const Readback& readback);
+
+	const Vulkan::Device& device_;
+
+	std::vector<std::unique_ptr<Readback>> readbacks_;
+	std::deque<Readback*> queue_;
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::condition_variable freeCondition_;
+	bool exit_{};
+
+	std::FILE* videoStream_{};
+	VkExtent2D videoExtent_{};
+
+	std::thread writerThread_;
+};
@@ -2,6 +2,7 @@
 #include "SceneList.hpp"
 #include "Utilities/Exception.hpp"
 #include <boost/program_options.hpp>
+#include <filesystem>
 #include <iostream>
 
 using namespace boost::program_options;
@@ -14,6 +15,12 @@ Options::Options(const int argc, const char* argv[])
 	benchmark.add_options()
 		("next-scenes", bool_switch(&BenchmarkNextScenes)->default_value(false), "Load the next scene once the sample or time limit is reached.")
 		("max-time", value<uint32_t>(&BenchmarkMaxTime)->default_value(60), "The benchmark time limit per scene (in seconds).")
+		("benchmark-mode", value<std::string>(&BenchmarkMode)->default_value("static"), "The benchmark camera (static = scene initial camera, flythrough = replay the scene camera path with accumulation resets and report frame time percentiles).")
+		("benchmark-sweep", value<std::string>(&BenchmarkSweep), "Benchmark every configuration of the given spec file (scenes x resolutions x samples x bounces x present modes), implies --benchmark.")
+		("benchmark-baseline", value<std::string>(&BenchmarkBaseline), "Flag the sweep configurations that changed significantly against the given results file.")
+		("benchmark-results", value<std::string>(&BenchmarkResults), "Write the sweep results to the given file (usable as a later baseline).")
+		("profile-costs", bool_switch(&ProfileCosts)->default_value(false), "Profile the hit and intersection shader costs per material model and per instance, reported at the end of each benchmark scene.")
+		("megashader", bool_switch(&Megashader)->default_value(false), "Use a single closest-hit shader switching on the material model, rather than one hit group per material model (for comparison).")
 		;
 
 	options_description renderer("Renderer options", lineLength);
@@ -21,6 +28,40 @@ Options::Options(const int argc, const char* argv[])
 		("samples", value<uint32_t>(&Samples)->default_value(8), "The number of ray samples per pixel.")
 		("bounces", value<uint32_t>(&Bounces)->default_value(16), "The maximum number of bounces per ray.")
 		("max-samples", value<uint32_t>(&MaxSamples)->default_value(64 * 1024), "The maximum number of accumulated ray samples per pixel.")
+		("render-scale", value<float>(&RenderScale)->default_value(1.0f), "The ray tracing resolution relative to the window, per axis (0.5 to 1), upscaled onto the window.")
+		("interleave", value<std::string>(&Interleave)->default_value("off"), "While the camera moves, only trace a subset of the pixels per frame and reproject the others from the previous frame (off, checkerboard = half, 2x2 = a quarter).")
+		("target-frame-time", value<float>(&TargetFrameTime)->default_value(0), "Adjust the number of samples per frame to meet the given GPU frame time in milliseconds (0 = disabled, fixed samples).")
+		;
+
+	options_description tiled("Tiled render options", lineLength);
+	tiled.add_options()
+		("render-output", value<std::string>(&RenderOutput), "Render a still image tile by tile to the given PFM file, each tile accumulating max-samples (resumes an interrupted render of the same scene, camera and settings).")
+		("render-width", value<uint32_t>(&RenderWidth)->default_value(7680), "The tiled render image width.")
+		("render-height", value<uint32_t>(&RenderHeight)->default_value(4320), "The tiled render image height.")
+		("tile-size", value<uint32_t>(&TileSize)->default_value(512), "The tiled render tile width and height.")
+		;
+
+	options_description capture("Capture options", lineLength);
+	capture.add_options()
+		("capture-at-samples", value<uint32_t>(&CaptureAtSamples)->default_value(0), "Capture the images once the accumulated sample count is reached (0 = disabled).")
+		("capture-every", value<uint32_t>(&CaptureEvery)->default_value(0), "Capture the images every given number of frames (0 = disabled).")
+		("capture-prefix", value<std::string>(&CapturePrefix)->default_value("capture"), "The captured images file name prefix.")
+		;
+
+	options_description cameraPath("Camera path options", lineLength);
+	cameraPath.add_options()
+		("camera-path", value<std::string>(&CameraPath), "Animate the camera along the keyframes of the given file (one 'time px py pz tx ty tz fov aperture focus' per line).")
+		("export-video", value<std::string>(&ExportVideo), "Render each camera path frame to max-samples and write it as raw RGB24 frames of the initial window size to the given named pipe or file ('-' for stdout).")
+		("export-fps", value<float>(&ExportFramesPerSecond)->default_value(30), "The exported video frame rate.")
+		;
+
+	options_description regression("Regression test options", lineLength);
+	regression.add_options()
+		("regression-test", value<std::string>(&RegressionTest), "Render every scene to regression-samples and compare it against the sceneN.pfm references of the given directory.")
+		("regression-update", bool_switch(&RegressionUpdate)->default_value(false), "Write the rendered images as the new references rather than comparing them.")
+		("regression-samples", value<uint32_t>(&RegressionSamples)->default_value(256), "The number of accumulated samples per pixel of the regression images.")
+		("regression-width", value<uint32_t>(&RegressionWidth)->default_value(640), "The regression images width.")
+		("regression-height", value<uint32_t>(&RegressionHeight)->default_value(360), "The regression images height.")
 		;
 
 	options_description scene("Scene options", lineLength);
@@ -31,6 +72,8 @@ Options::Options(const int argc, const char* argv[])
 	options_description vulkan("Vulkan options", lineLength);
 	vulkan.add_options()
 		("visible-device", value<std::vector<uint32_t>>(&VisibleDevices), "Explicitly set which Vulkan device ID is visible (can be repeated for multiple devices). If unspecified, all devices are visible.")
+		("frames-in-flight", value<uint32_t>(&FramesInFlight)->default_value(2), "The number of frames the CPU can prepare ahead of the GPU.")
+		("pipeline-cache", value<std::string>(&PipelineCache), "The pipeline cache file, kept between runs (default: PipelineCache.bin next to the executable).")
 		;
 
 	options_description window("Window options", lineLength);
@@ -45,10 +88,15 @@ Options::Options(const int argc, const char* argv[])
 	desc.add_options()
 		("help", "Display help message.")
 		("benchmark", bool_switch(&Benchmark)->default_value(false), "Run the application in benchmark mode.")
+		("trace-file", value<std::string>(&TraceFile), "Record the startup, scene loading and per-frame zones to the given Chrome trace JSON file (chrome://tracing or ui.perfetto.dev).")
 		;
 
 	desc.add(benchmark);
 	desc.add(renderer);
+	desc.add(tiled);
+	desc.add(capture);
+	desc.add(cameraPath);
+	desc.add(regression);
 	desc.add(scene);
 	desc.add(vulkan);
 	desc.add(window);
@@ -64,6 +112,15 @@ Options::Options(const int argc, const char* argv[])
 		Throw(Help());
 	}
 
+	// Next to the executable rather than in the working directory, so that every run shares the same cache.
+	if (PipelineCache.empty())
+	{
+		PipelineCache = (std::filesystem::absolute(argv[0]).parent_path() / "PipelineCache.bin").string();
+	}
+
+	// A sweep is a benchmark with its own scenes and settings.
+	Benchmark = Benchmark || !BenchmarkSweep.empty();
+
 	if (SceneIndex >= SceneList::AllScenes.size())
 	{
 		Throw(std::out_of_range("scene index is too large"));
@@ -73,5 +130,75 @@ Options::Options(const int argc, const char* argv[])
 	{
 		Throw(std::out_of_range("invalid present mode"));
 	}
+
+	if (RenderWidth == 0 || RenderHeight == 0)
+	{
+		Throw(std::out_of_range("invalid tiled render size"));
+	}
+
+	if (RenderScale < 0.5f || RenderScale > 1.0f)
+	{
+		Throw(std::out_of_range("invalid render scale"));
+	}
+
+	if (TargetFrameTime < 0)
+	{
+		Throw(std::out_of_range("invalid target frame time"));
+	}
+
+	if (Interleave != "off" && Interleave != "checkerboard" && Interleave != "2x2")
+	{
+		Throw(std::invalid_argument("invalid interleave pattern '" + Interleave + "'"));
+	}
+
+	if (TileSize < 8 || TileSize > 4096)
+	{
+		Throw(std::out_of_range("invalid tile size"));
+	}
+
+	if (BenchmarkMode != "static" && BenchmarkMode != "flythrough")
+	{
+		Throw(std::invalid_argument("invalid benchmark mode '" + BenchmarkMode + "'"));
+	}
+
+	if (BenchmarkMode == "flythrough" && !CameraPath.empty())
+	{
+		Throw(std::invalid_argument("fly-through benchmark and camera path are mutually exclusive"));
+	}
+
+	if (!BenchmarkSweep.empty() && (BenchmarkMode != "static" || !CameraPath.empty() || !RenderOutput.empty()))
+	{
+		Throw(std::invalid_argument("benchmark sweep is incompatible with fly-through, camera path and tiled render"));
+	}
+
+	if (!RegressionTest.empty() && (Benchmark || !CameraPath.empty() || !RenderOutput.empty()))
+	{
+		Throw(std::invalid_argument("regression test is incompatible with benchmark, camera path and tiled render"));
+	}
+
+	if (RegressionSamples == 0 || RegressionWidth == 0 || RegressionHeight == 0)
+	{
+		Throw(std::out_of_range("invalid regression test settings"));
+	}
+
+	if (!ExportVideo.empty() && CameraPath.empty())
+	{
+		Throw(std::invalid_argument("video export requires a camera path"));
+	}
+
+	if (!ExportVideo.empty() && !RenderOutput.empty())
+	{
+		Throw(std::invalid_argument("video export and tiled render are mutually exclusive"));
+	}
+
+	if (ExportFramesPerSecond <= 0)
+	{
+		Throw(std::out_of_range("invalid export frame rate"));
+	}
+
+	if (FramesInFlight < 1 || FramesInFlight > 8)
+	{
+		Throw(std::out_of_range("invalid number of frames in flight"));
+	}
 }
 
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <exception>
+#include <string>
 #include <vector>
 
 class Options final
@@ -21,21 +22,56 @@ public:
 
 	// Application options.
 	bool Benchmark{};
+	std::string TraceFile{};
 	
 	// Benchmark options.
 	bool BenchmarkNextScenes{};
 	uint32_t BenchmarkMaxTime{};
+	std::string BenchmarkMode{};
+	std::string BenchmarkSweep{};
+	std::string BenchmarkBaseline{};
+	std::string BenchmarkResults{};
+	bool ProfileCosts{};
+	bool Megashader{};
 
 	// Renderer options.
 	uint32_t Samples{};
 	uint32_t Bounces{};
 	uint32_t MaxSamples{};
+	float RenderScale{};
+	float TargetFrameTime{};
+	std::string Interleave{};
+
+	// Tiled render options.
+	std::string RenderOutput{};
+	uint32_t RenderWidth{};
+	uint32_t RenderHeight{};
+	uint32_t TileSize{};
+
+	// Capture options.
+	uint32_t CaptureAtSamples{};
+	uint32_t CaptureEvery{};
+	std::string CapturePrefix{};
+
+	// Camera path options.
+	std::string CameraPath{};
+	std::string ExportVideo{};
+	float ExportFramesPerSecond{};
+
+	// Regression test options.
+	std::string RegressionTest{};
+	bool RegressionUpdate{};
+	uint32_t RegressionSamples{};
+	uint32_t RegressionWidth{};
+	uint32_t RegressionHeight{};
 
 	// Scene options.
 	uint32_t SceneIndex{};
 
 	// Vulkan options
 	std::vector<uint32_t> VisibleDevices{};
+	uint32_t FramesInFlight{};
+	std::string PipelineCache{};
 
 	// Window options
 	uint32_t Width{};
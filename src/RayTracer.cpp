@@ -1,4 +1,11 @@
 #include "RayTracer.hpp"
+#include "BenchmarkSweep.hpp"
+#include "CameraPath.hpp"
+#include "CostProfile.hpp"
+#include "FrameTimeController.hpp"
+#include "ImageCapture.hpp"
+#include "RegressionTest.hpp"
+#include "TiledRender.hpp"
 #include "UserInterface.hpp"
 #include "UserSettings.hpp"
 #include "Assets/Model.hpp"
@@ -7,10 +14,16 @@
 #include "Assets/UniformBuffer.hpp"
 #include "Utilities/Exception.hpp"
 #include "Utilities/Glm.hpp"
+#include "Utilities/Tracer.hpp"
+#include "Vulkan/CommandQueue.hpp"
 #include "Vulkan/Device.hpp"
+#include "Vulkan/PipelineCache.hpp"
 #include "Vulkan/SwapChain.hpp"
 #include "Vulkan/Window.hpp"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <numeric>
 #include <sstream>
 
 namespace
@@ -21,43 +34,205 @@ namespace
 #else
 		true;
 #endif
+
+	// The fly-through benchmark advances the camera path by a fixed time step per frame, whatever the frame rate.
+	const double FlythroughFrameRate = 60;
+
+	// Converged frames drawn before waiting for events, giving the UI a few frames to settle after an input.
+	const uint32_t IdleFramesBeforeWaiting = 3;
+
+	// The camera and render settings a tiled render depends on, so that it is not resumed with different ones.
+	size_t TiledRenderSettingsHash(const glm::mat4& modelView, const UserSettings& settings, const bool hasSky)
+	{
+		std::ostringstream out;
+		out << std::hexfloat;
+
+		for (glm::length_t i = 0; i != 4; ++i)
+		{
+			for (glm::length_t j = 0; j != 4; ++j)
+			{
+				out << modelView[i][j] << ' ';
+			}
+		}
+
+		out << settings.FieldOfView << ' ' << settings.Aperture << ' ' << settings.FocusDistance << ' ' << hasSky << ' '
+			<< settings.NumberOfBounces << ' ' << settings.ShowHeatmap << ' ' << settings.HeatmapScale;
+
+		return std::hash<std::string>()(out.str());
+	}
+
+	void PrintFrameTimeDistribution(const char* const label, std::vector<float> frameTimes)
+	{
+		if (frameTimes.empty())
+		{
+			return;
+		}
+
+		std::sort(frameTimes.begin(), frameTimes.end());
+
+		// Nearest-rank percentiles.
+		const auto percentile = [&frameTimes](const double p)
+		{
+			const auto rank = static_cast<size_t>(std::ceil(p * frameTimes.size()));
+			return frameTimes[std::max<size_t>(rank, 1) - 1] * 1000;
+		};
+
+		const auto mean = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0) / frameTimes.size();
+
+		std::cout << "Benchmark: " << label << " frame time (ms): mean " << mean * 1000
+			<< ", p50 " << percentile(0.5) << ", p90 " << percentile(0.9) << ", p99 " << percentile(0.99)
+			<< ", max " << frameTimes.back() * 1000 << std::endl;
+	}
 }
 
-RayTracer::RayTracer(const UserSettings& userSettings, const Vulkan::WindowConfig& windowConfig, const VkPresentModeKHR presentMode) :
-	Application(windowConfig, presentMode, EnableValidationLayers),
-	userSettings_(userSettings)
+RayTracer::RayTracer(const UserSettings& userSettings, const Vulkan::WindowConfig& windowConfig, const VkPresentModeKHR presentMode, const uint32_t framesInFlight) :
+	Application(windowConfig, presentMode, framesInFlight, EnableValidationLayers),
+	userSettings_(userSettings),
+	costProfile_(new CostProfile()),
+	frameTimeController_(new FrameTimeController(framesInFlight)),
+	sceneLoader_(new SceneLoader())
 {
 	CheckFramebufferSize();
+	SetPipelineCacheFilename(userSettings_.PipelineCache);
+
+	if (!userSettings_.CameraPath.empty())
+	{
+		cameraPath_.reset(new CameraPath(CameraPath::Load(userSettings_.CameraPath)));
+	}
+
+	if (!userSettings_.BenchmarkSweep.empty())
+	{
+		benchmarkSweep_.reset(new BenchmarkSweep(userSettings_.BenchmarkSweep, userSettings_.BenchmarkBaseline, userSettings_.BenchmarkResults));
+		userSettings_.SceneIndex = static_cast<int>(benchmarkSweep_->CurrentConfiguration().SceneIndex);
+		applySweepConfiguration_ = true;
+	}
+
+	if (!userSettings_.RegressionTest.empty())
+	{
+		regressionTest_.reset(new RegressionTest(
+			userSettings_.RegressionTest, userSettings_.RegressionWidth, userSettings_.RegressionHeight,
+			userSettings_.RegressionSamples, userSettings_.RegressionUpdate));
+
+		userSettings_.SceneIndex = 0;
+		userSettings_.MaxNumberOfSamples = userSettings_.RegressionSamples;
+	}
 }
 
 RayTracer::~RayTracer()
 {
+	// Write out the captures still in flight.
+	if (imageCapture_)
+	{
+		Device().WaitIdle();
+		imageCapture_->CollectAll();
+	}
+
+	imageCapture_.reset();
+	sceneLoader_.reset();
+	frameTimeController_.reset();
+	costProfile_.reset();
+	benchmarkPath_.reset();
+	benchmarkSweep_.reset();
+	regressionTest_.reset();
+	cameraPath_.reset();
+	tiledRender_.reset();
 	scene_.reset();
 }
 
 Assets::UniformBufferObject RayTracer::GetUniformBufferObject(const VkExtent2D extent) const
 {
-	const auto& init = cameraInitialSate_;
+	// When rendering tile by tile, the camera covers the full image rather than the swap chain.
+	const auto imageExtent = 
+		tiledRender_ ? VkExtent2D{ tiledRender_->Width(), tiledRender_->Height() } :
+		benchmarkSweep_ || regressionTest_ || IsExportingVideo() || GetRenderScale() != 1 ? GetTraceExtent() :
+		extent;
 
 	Assets::UniformBufferObject ubo = {};
 	ubo.ModelView = modelViewController_.ModelView();
-	ubo.Projection = glm::perspective(glm::radians(userSettings_.FieldOfView), extent.width / static_cast<float>(extent.height), 0.1f, 10000.0f);
-	ubo.Projection[1][1] *= -1; // Inverting Y for Vulkan, https://matthewwellings.com/blog/the-new-vulkan-coordinate-system/
+	ubo.Projection = GetProjection(imageExtent);
 	ubo.ModelViewInverse = glm::inverse(ubo.ModelView);
 	ubo.ProjectionInverse = glm::inverse(ubo.Projection);
+	ubo.PreviousModelView = previousModelView_;
+	ubo.PreviousProjection = previousProjection_;
 	ubo.Aperture = userSettings_.Aperture;
 	ubo.FocusDistance = userSettings_.FocusDistance;
 	ubo.TotalNumberOfSamples = totalNumberOfSamples_;
 	ubo.NumberOfSamples = numberOfSamples_;
 	ubo.NumberOfBounces = userSettings_.NumberOfBounces;
 	ubo.RandomSeed = 1;
-	ubo.HasSky = init.HasSky;
-	ubo.ShowHeatmap = userSettings_.ShowHeatmap;
 	ubo.HeatmapScale = userSettings_.HeatmapScale;
+	ubo.ImageWidth = imageExtent.width;
+	ubo.ImageHeight = imageExtent.height;
+	ubo.InterleaveMode = interleaveMode_;
+	ubo.InterleaveFrame = interleaveFrame_;
+	ubo.HistoryIndex = historyIndex_;
+
+	if (tiledRender_ && !tiledRender_->IsComplete())
+	{
+		ubo.TileOffsetX = tiledRender_->CurrentTile().X;
+		ubo.TileOffsetY = tiledRender_->CurrentTile().Y;
+	}
 
 	return ubo;
 }
 
+glm::mat4 RayTracer::GetProjection(const VkExtent2D imageExtent) const
+{
+	auto projection = glm::perspective(glm::radians(userSettings_.FieldOfView), imageExtent.width / static_cast<float>(imageExtent.height), 0.1f, 10000.0f);
+	projection[1][1] *= -1; // Inverting Y for Vulkan, https://matthewwellings.com/blog/the-new-vulkan-coordinate-system/
+
+	return projection;
+}
+
+Vulkan::RayTracing::ShaderVariant RayTracer::GetShaderVariant() const
+{
+	Vulkan::RayTracing::ShaderVariant variant = {};
+	variant.ShowHeatmap = userSettings_.ShowHeatmap;
+	variant.HasSky = cameraInitialSate_.HasSky;
+	variant.HasTextures = scene_->HasTextures();
+	variant.NumberOfBounces = userSettings_.NumberOfBounces;
+	variant.CountRays = (userSettings_.ShowOverlay || userSettings_.Benchmark) && SupportsRayCounters();
+	variant.ProfileCosts = userSettings_.ProfileCosts;
+	variant.MaterialHitGroups = userSettings_.MaterialHitGroups;
+
+	return variant;
+}
+
+VkExtent2D RayTracer::GetTraceExtent() const
+{
+	// Always launch full size tiles so that the output images do not change, the shaders discard the pixels past the image edges.
+	if (tiledRender_)
+	{
+		return VkExtent2D{ std::min(tiledRender_->TileSize(), tiledRender_->Width()), std::min(tiledRender_->TileSize(), tiledRender_->Height()) };
+	}
+
+	// The regression test and benchmark sweep resolutions do not depend on the window size.
+	if (regressionTest_)
+	{
+		return VkExtent2D{ regressionTest_->Width(), regressionTest_->Height() };
+	}
+
+	if (benchmarkSweep_ && !benchmarkSweep_->IsComplete())
+	{
+		const auto& configuration = benchmarkSweep_->CurrentConfiguration();
+		return VkExtent2D{ configuration.Width, configuration.Height };
+	}
+
+	// The raw video frames carry no size, every frame of the stream must have the extent it started with.
+	if (IsExportingVideo())
+	{
+		return exportExtent_;
+	}
+
+	return Application::GetTraceExtent();
+}
+
+float RayTracer::GetRenderScale() const
+{
+	// The images written out (or compared) are always traced at their full resolution.
+	return tiledRender_ || regressionTest_ || benchmarkSweep_ || IsExportingVideo() ? 1.0f : userSettings_.RenderScale;
+}
+
 void RayTracer::SetPhysicalDevice(
 	VkPhysicalDevice physicalDevice, 
 	std::vector<const char*>& requiredExtensions,
@@ -86,18 +261,47 @@ void RayTracer::SetPhysicalDevice(
 
 void RayTracer::OnDeviceSet()
 {
+	Utilities::Tracer::Zone zone("RayTracer::OnDeviceSet");
+
 	Application::OnDeviceSet();
 
-	LoadScene(userSettings_.SceneIndex);
-	CreateAccelerationStructures();
+	imageCapture_.reset(new ImageCapture(Device(), FramesInFlight()));
+
+	if (IsExportingVideo())
+	{
+		exportNumberOfFrames_ = cameraPath_->NumberOfFrames(userSettings_.ExportFramesPerSecond);
+		exportExtent_ = Window().FramebufferSize();
+		imageCapture_->OpenVideoStream(userSettings_.ExportVideo, exportExtent_);
+
+		std::cout << "- exporting " << exportNumberOfFrames_ << " frames at " << userSettings_.ExportFramesPerSecond << " fps, " 
+			<< userSettings_.MaxNumberOfSamples << " samples per pixel, as raw RGB24 frames of " << exportExtent_.width << "x" << exportExtent_.height 
+			<< " (the initial window size) to '" << userSettings_.ExportVideo << "'" << std::endl;
+	}
+
+	LoadScene(SceneLoader::Load(userSettings_.SceneIndex));
+	SwitchScene();
+
+	// Once the scene has set the camera.
+	if (!userSettings_.RenderOutput.empty())
+	{
+		tiledRender_.reset(new TiledRender(
+			userSettings_.RenderOutput, userSettings_.RenderWidth, userSettings_.RenderHeight,
+			userSettings_.TileSize, userSettings_.MaxNumberOfSamples, sceneIndex_,
+			TiledRenderSettingsHash(modelViewController_.ModelView(), userSettings_, cameraInitialSate_.HasSky)));
+	}
 }
 
 void RayTracer::CreateSwapChain()
 {
 	Application::CreateSwapChain();
 
-	userInterface_.reset(new UserInterface(CommandPool(), SwapChain(), DepthBuffer(), userSettings_));
+	{
+		Utilities::Tracer::Zone uiZone("CreateUserInterface");
+		userInterface_.reset(new UserInterface(CommandPool(), SwapChain(), DepthBuffer(), userSettings_));
+	}
+
 	resetAccumulation_ = true;
+	historyValid_ = false;
 
 	CheckFramebufferSize();
 }
@@ -109,39 +313,192 @@ void RayTracer::DeleteSwapChain()
 	Application::DeleteSwapChain();
 }
 
+bool RayTracer::IsIdle() const
+{
+	return idleFrames_ > IdleFramesBeforeWaiting && !sceneLoader_->HasRequest() && !nextScene_;
+}
+
 void RayTracer::DrawFrame()
 {
-	// Check if the scene has been changed by the user.
-	if (sceneIndex_ != static_cast<uint32_t>(userSettings_.SceneIndex))
+	// Woken up by an event, the time spent waiting for it is not a frame.
+	if (IsIdle())
+	{
+		idleFrames_ = 0;
+		time_ = Window().GetTime();
+	}
+
+	if (benchmarkSweep_ && !ApplyBenchmarkSweepConfiguration())
+	{
+		return;
+	}
+
+	// Check if the scene has been changed by the user. Interactive sessions keep rendering the current scene
+	// while the next one loads, uploads and builds in the background, the others (e.g. benchmarks) switch right away.
+	const auto requestedSceneIndex = static_cast<uint32_t>(userSettings_.SceneIndex);
+	const auto latestSceneIndex = nextScene_ ? nextSceneIndex_ : sceneIndex_;
+	std::unique_ptr<SceneLoader::Result> loadedScene;
+
+	if (!IsInteractive())
+	{
+		loadedScene = latestSceneIndex != requestedSceneIndex ? SceneLoader::Load(requestedSceneIndex) : nullptr;
+	}
+	else
+	{
+		if (latestSceneIndex != requestedSceneIndex)
+		{
+			sceneLoader_->Request(requestedSceneIndex);
+		}
+		else
+		{
+			sceneLoader_->Cancel();
+		}
+
+		// Only one scene is uploaded and built at a time, a later one waits in the loader.
+		loadedScene = nextScene_ ? nullptr : sceneLoader_->TakeResult();
+	}
+
+	if (loadedScene)
+	{
+		LoadScene(std::move(loadedScene));
+	}
+
+	if (nextScene_ && (!IsInteractive() || AreAccelerationStructuresBuilt()))
+	{
+		SwitchScene();
+		return;
+	}
+
+	// In tiled render mode, write the current tile once it has accumulated all its samples and move on to the next one.
+	if (tiledRender_ && !tiledRender_->IsComplete() && totalNumberOfSamples_ == userSettings_.MaxNumberOfSamples)
 	{
+		std::vector<float> accumulatedColors;
+
 		Device().WaitIdle();
-		DeleteSwapChain();
-		DeleteAccelerationStructures();
-		LoadScene(userSettings_.SceneIndex);
-		CreateAccelerationStructures();
-		CreateSwapChain();
+		ReadAccumulationImage(GetTraceExtent(), accumulatedColors);
+		tiledRender_->WriteTile(accumulatedColors);
+		resetAccumulation_ = true;
+	}
+
+	if (tiledRender_ && tiledRender_->IsComplete())
+	{
+		Window().Close();
 		return;
 	}
 
+	// In regression test mode, compare each scene once it has accumulated all its samples and move on to the next one.
+	if (regressionTest_)
+	{
+		if (totalNumberOfSamples_ == userSettings_.MaxNumberOfSamples)
+		{
+			std::vector<float> accumulatedColors;
+
+			Device().WaitIdle();
+			ReadAccumulationImage(GetTraceExtent(), accumulatedColors);
+			regressionTest_->CheckScene(sceneIndex_, accumulatedColors);
+
+			if (sceneIndex_ + 1 == SceneList::AllScenes.size())
+			{
+				Window().Close();
+				regressionTest_->Finish();
+				return;
+			}
+
+			userSettings_.SceneIndex += 1;
+			return;
+		}
+
+		regressionTest_->BeginScene();
+	}
+
+	// The camera of the previous frame, the one its pixels are reprojected from.
+	previousModelView_ = modelViewController_.ModelView();
+	previousProjection_ = GetProjection(GetTraceExtent());
+
+	if (IsExportingVideo())
+	{
+		CheckAndUpdateVideoExport();
+
+		if (exportFrame_ == exportNumberOfFrames_)
+		{
+			Window().Close();
+			return;
+		}
+	}
+	else if (cameraPath_)
+	{
+		// Real-time preview of the camera path.
+		ApplyCameraPath(*cameraPath_, cameraPath_->Duration() > 0 ? std::fmod(Window().GetTime(), cameraPath_->Duration()) : 0.0);
+		resetAccumulation_ = true;
+	}
+	else if (IsFlythroughBenchmark() && benchmarkPath_)
+	{
+		// Every frame starts from scratch, measuring interactive rather than converged performance.
+		ApplyCameraPath(*benchmarkPath_, flythroughFrame_ / FlythroughFrameRate);
+		resetAccumulation_ = true;
+	}
+
 	// Check if the accumulation buffer needs to be reset.
-	if (resetAccumulation_ || 
-		userSettings_.RequiresAccumulationReset(previousSettings_) || 
-		!userSettings_.AccumulateRays)
+	const bool restartAccumulation =
+		resetAccumulation_ ||
+		userSettings_.RequiresAccumulationReset(previousSettings_) ||
+		!userSettings_.AccumulateRays;
+
+	// An interleaved frame holds reprojected pixels, the accumulation restarts from scratch once the camera stops.
+	if (restartAccumulation || interleaveMode_ != 0)
 	{
 		totalNumberOfSamples_ = 0;
 		resetAccumulation_ = false;
 	}
 
+	// While the accumulation restarts every frame (e.g. camera motion), only trace a subset of the pixels and
+	// reproject the others from the previous frame, as long as it was ray traced at the same resolution.
+	const bool hasHistory = historyValid_ && userSettings_.RenderScale == previousSettings_.RenderScale;
+
+	interleaveMode_ = restartAccumulation && hasHistory && userSettings_.IsRayTraced && IsInteractive()
+		? static_cast<uint32_t>(userSettings_.InterleavedTracing)
+		: 0;
+
+	interleaveFrame_ += interleaveMode_ != 0 ? 1 : 0;
+
+	// The heatmap is not accumulated, changing it needs another trace even once converged.
+	const bool heatmapChanged =
+		userSettings_.ShowHeatmap != previousSettings_.ShowHeatmap ||
+		userSettings_.HeatmapScale != previousSettings_.HeatmapScale;
+
+	// Profile the shader costs from scratch whenever enabled.
+	if (userSettings_.ProfileCosts && !previousSettings_.ProfileCosts)
+	{
+		costProfile_->Reset(*scene_);
+	}
+
+	// Likewise, the frame time controller starts from the current settings.
+	if (userSettings_.AdaptiveSamples && !previousSettings_.AdaptiveSamples)
+	{
+		frameTimeController_->Reset(userSettings_.NumberOfSamples, userSettings_.RenderScale);
+	}
+
 	previousSettings_ = userSettings_;
 
+	// The rasterizer needs proxy meshes for the procedural primitives, only create them when first needed.
+	if (!userSettings_.IsRayTraced && !scene_->HasRasterProxy())
+	{
+		scene_->CreateRasterProxy(CommandPool());
+	}
+
 	// Keep track of our sample count.
 	numberOfSamples_ = glm::clamp(userSettings_.MaxNumberOfSamples - totalNumberOfSamples_, 0u, userSettings_.NumberOfSamples);
 	totalNumberOfSamples_ += numberOfSamples_;
 
+	// Once converged, skip the trace and present the last output again. Interactive sessions then go idle,
+	// only drawing frames on input.
+	converged_ = userSettings_.IsRayTraced && numberOfSamples_ == 0 && !heatmapChanged;
+	idleFrames_ = converged_ && IsInteractive() ? idleFrames_ + 1 : 0;
+	historyIndex_ ^= converged_ ? 0 : 1;
+
 	Application::DrawFrame();
 }
 
-void RayTracer::Render(VkCommandBuffer commandBuffer, const uint32_t imageIndex)
+void RayTracer::Render(VkCommandBuffer commandBuffer, const uint32_t frameIndex, const uint32_t imageIndex)
 {
 	// Record delta time between calls to Render.
 	const auto prevTime = time_;
@@ -154,27 +511,78 @@ void RayTracer::Render(VkCommandBuffer commandBuffer, const uint32_t imageIndex)
 	// Check the current state of the benchmark, update it for the new frame.
 	CheckAndUpdateBenchmarkState(prevTime);
 
+	// The previous frame using this slot has completed, its captures can be written out.
+	imageCapture_->Collect(frameIndex);
+
 	// Render the scene
+	Utilities::Tracer::Zone sceneZone(userSettings_.IsRayTraced ? "RayTrace" : "Rasterize");
+
 	userSettings_.IsRayTraced
-		? Vulkan::RayTracing::Application::Render(commandBuffer, imageIndex)
-		: Vulkan::Application::Render(commandBuffer, imageIndex);
+		? Vulkan::RayTracing::Application::Render(commandBuffer, frameIndex, imageIndex)
+		: Rasterize(commandBuffer, frameIndex, imageIndex);
+
+	historyValid_ = userSettings_.IsRayTraced;
+
+	CheckAndRecordCapture(commandBuffer, frameIndex);
+
+	// The ray counts are read by the ray tracing Render(), they match the GPU time of the same frame.
+	if (userSettings_.Benchmark && userSettings_.IsRayTraced && HasRayStatistics())
+	{
+		periodTracedRays_ += static_cast<double>(LastRayStatistics().TracedRays());
+		periodRayGpuFrameTime_ += GpuFrameTime();
+	}
+
+	if (userSettings_.IsRayTraced && HasCostBuckets())
+	{
+		costProfile_->AddFrame(LastCostBuckets());
+	}
+
+	// Adjust the samples of the next frames, using the GPU time of the frame that last used this slot.
+	// Converged or rasterized frames are not traced and do not tell anything about the cost of a sample.
+	// The render scale is either left to the controller or fixed by the user.
+	if (userSettings_.AdaptiveSamples && IsInteractive())
+	{
+		frameTimeController_->SetTarget(userSettings_.TargetFrameTime / 1000.0,
+			userSettings_.AdaptiveRenderScale ? UserSettings::RenderScaleMinValue : userSettings_.RenderScale,
+			userSettings_.AdaptiveRenderScale ? UserSettings::RenderScaleMaxValue : userSettings_.RenderScale);
+
+		frameTimeController_->AddFrame(frameIndex, GpuFrameTime(), userSettings_.IsRayTraced ? numberOfSamples_ : 0, GetRenderScale());
+		userSettings_.NumberOfSamples = frameTimeController_->NumberOfSamples();
+		userSettings_.RenderScale = frameTimeController_->RenderScale();
+	}
 
 	// Render the UI
 	Statistics stats = {};
 	stats.FramebufferSize = Window().FramebufferSize();
 	stats.FrameRate = static_cast<float>(1 / timeDelta);
+	stats.CpuFrameTime = static_cast<float>(CpuFrameTime() * 1000);
+	stats.GpuFrameTime = static_cast<float>(GpuFrameTime() * 1000);
+	stats.LoadingScene = sceneLoader_->HasRequest() ? SceneList::AllScenes[sceneLoader_->RequestedSceneIndex()].first.c_str() : nullptr;
 
 	if (userSettings_.IsRayTraced)
 	{
-		const auto extent = SwapChain().Extent();
+		const auto extent = GetTraceExtent();
 
-		stats.RayRate = static_cast<float>(
-			double(extent.width*extent.height)*numberOfSamples_
-			/ (timeDelta * 1000000000));
+		stats.HasRayStatistics = HasRayStatistics() && GpuFrameTime() > 0;
+		stats.Rays = LastRayStatistics();
+
+		// The counts and GPU time both belong to the frame that last used this slot.
+		stats.RayRate = stats.HasRayStatistics
+			? static_cast<float>(stats.Rays.TracedRays() / (GpuFrameTime() * 1000000000.0))
+			: static_cast<float>(double(extent.width*extent.height)*numberOfSamples_ / (timeDelta * 1000000000));
 
 		stats.TotalSamples = totalNumberOfSamples_;
+		stats.Costs = userSettings_.ProfileCosts ? costProfile_.get() : nullptr;
+
+		stats.AdaptiveSamples = userSettings_.AdaptiveSamples && IsInteractive();
+		stats.NumberOfSamples = userSettings_.NumberOfSamples;
+		stats.TargetFrameTime = userSettings_.TargetFrameTime;
+		stats.SampleTime = static_cast<float>(frameTimeController_->SampleTime() * 1000);
+		stats.RenderScale = GetRenderScale();
+		stats.RenderSize = extent;
 	}
 
+	Utilities::Tracer::Zone uiZone("RenderUserInterface");
 	userInterface_->Render(commandBuffer, SwapChainFrameBuffer(imageIndex), stats);
 }
 
@@ -190,11 +598,12 @@ void RayTracer::OnKey(int key, int scancode, int action, int mods)
 		switch (key)
 		{
 		case GLFW_KEY_ESCAPE: Window().Close(); break;
+		case GLFW_KEY_F12: captureRequested_ = true; break;
 		default: break;
 		}
 
 		// Settings (toggle switches)
-		if (!userSettings_.Benchmark)
+		if (IsInteractive())
 		{
 			switch (key)
 			{
@@ -209,7 +618,7 @@ void RayTracer::OnKey(int key, int scancode, int action, int mods)
 	}
 
 	// Camera motions
-	if (!userSettings_.Benchmark)
+	if (IsInteractive())
 	{
 		resetAccumulation_ |= modelViewController_.OnKey(key, scancode, action, mods);
 	}
@@ -218,7 +627,7 @@ void RayTracer::OnKey(int key, int scancode, int action, int mods)
 void RayTracer::OnCursorPosition(const double xpos, const double ypos)
 {
 	if (!HasSwapChain() ||
-		userSettings_.Benchmark ||
+		!IsInteractive() ||
 		userInterface_->WantsToCaptureKeyboard() || 
 		userInterface_->WantsToCaptureMouse())
 	{
@@ -232,7 +641,7 @@ void RayTracer::OnCursorPosition(const double xpos, const double ypos)
 void RayTracer::OnMouseButton(const int button, const int action, const int mods)
 {
 	if (!HasSwapChain() || 
-		userSettings_.Benchmark ||
+		!IsInteractive() ||
 		userInterface_->WantsToCaptureMouse())
 	{
 		return;
@@ -245,7 +654,7 @@ void RayTracer::OnMouseButton(const int button, const int action, const int mods
 void RayTracer::OnScroll(const double xoffset, const double yoffset)
 {
 	if (!HasSwapChain() ||
-		userSettings_.Benchmark ||
+		!IsInteractive() ||
 		userInterface_->WantsToCaptureMouse())
 	{
 		return;
@@ -260,18 +669,39 @@ void RayTracer::OnScroll(const double xoffset, const double yoffset)
 	resetAccumulation_ = prevFov != userSettings_.FieldOfView;
 }
 
-void RayTracer::LoadScene(const uint32_t sceneIndex)
+void RayTracer::LoadScene(std::unique_ptr<SceneLoader::Result> assets)
 {
-	auto [models, textures] = SceneList::AllScenes[sceneIndex].second(cameraInitialSate_);
+	const auto sceneIndex = assets->SceneIndex;
+	Utilities::Tracer::Zone zone("RayTracer::LoadScene", SceneList::AllScenes[sceneIndex].first);
+
+	nextSceneIndex_ = sceneIndex;
+	nextCameraState_ = std::move(assets->Camera);
 
-	// If there are no texture, add a dummy one. It makes the pipeline setup a lot easier.
-	if (textures.empty())
 	{
-		textures.push_back(Assets::Texture::LoadTexture("../assets/textures/white.png", Vulkan::SamplerConfig()));
+		Utilities::Tracer::Zone uploadZone("UploadScene");
+
+		// Measure the overlap of the upload with the acceleration structure builds (see SwitchAccelerationStructures()).
+		TransferQueue().ResetBusyTime();
+		ComputeQueue().ResetBusyTime();
+
+		nextScene_.reset(new Assets::Scene(TransferQueue(), ComputeQueue().FamilyIndex(), GraphicsQueue().FamilyIndex(),
+			std::move(assets->Models), std::move(assets->Textures)));
 	}
-	
-	scene_.reset(new Assets::Scene(CommandPool(), std::move(models), std::move(textures)));
-	sceneIndex_ = sceneIndex;
+
+	BuildAccelerationStructures(*nextScene_);
+}
+
+void RayTracer::SwitchScene()
+{
+	Utilities::Tracer::Zone zone("SwitchScene");
+
+	// The frames in flight may still render the previous scene, it is only released once they complete.
+	SwitchAccelerationStructures();
+	Retire(std::move(scene_));
+
+	scene_ = std::move(nextScene_);
+	sceneIndex_ = nextSceneIndex_;
+	cameraInitialSate_ = nextCameraState_;
 
 	userSettings_.FieldOfView = cameraInitialSate_.FieldOfView;
 	userSettings_.Aperture = cameraInitialSate_.Aperture;
@@ -279,8 +709,22 @@ void RayTracer::LoadScene(const uint32_t sceneIndex)
 
 	modelViewController_.Reset(cameraInitialSate_.ModelView);
 
+	benchmarkPath_.reset(cameraInitialSate_.BenchmarkPath.empty() ? nullptr : new CameraPath(cameraInitialSate_.BenchmarkPath));
+	flythroughFrame_ = 0;
+	flythroughFrameTimes_.clear();
+	flythroughGpuFrameTimes_.clear();
+
 	periodTotalFrames_ = 0;
+	periodCpuFrameTime_ = 0;
+	periodGpuFrameTime_ = 0;
+	periodTracedRays_ = 0;
+	periodRayGpuFrameTime_ = 0;
+	costProfile_->Reset(*scene_);
+	frameTimeController_->Reset(userSettings_.NumberOfSamples, userSettings_.RenderScale);
 	resetAccumulation_ = true;
+	historyValid_ = false;
+
+	RecreatePipelines();
 }
 
 void RayTracer::CheckAndUpdateBenchmarkState(double prevTime)
@@ -289,12 +733,27 @@ void RayTracer::CheckAndUpdateBenchmarkState(double prevTime)
 	{
 		return;
 	}
+
+	// The sweep drives the scenes and settings itself, see ApplyBenchmarkSweepConfiguration().
+	if (benchmarkSweep_)
+	{
+		applySweepConfiguration_ = benchmarkSweep_->AddFrame(static_cast<float>(time_ - prevTime), GpuFrameTime());
+		return;
+	}
 	
 	// Initialise scene benchmark timers
 	if (periodTotalFrames_ == 0)
 	{
 		std::cout << std::endl;
 		std::cout << "Benchmark: Start scene #" << sceneIndex_ << " '" << SceneList::AllScenes[sceneIndex_].first << "'" << std::endl;
+
+		// Window time starts with the application, the first frame gives the overall startup time.
+		if (!startupTimeReported_)
+		{
+			std::cout << "Benchmark: startup time " << time_ << "s (" << (PipelineCache().IsWarm() ? "warm" : "cold") << " pipeline cache)" << std::endl;
+			startupTimeReported_ = true;
+		}
+
 		sceneInitialTime_ = time_;
 		periodInitialTime_ = time_;
 	}
@@ -307,21 +766,54 @@ void RayTracer::CheckAndUpdateBenchmarkState(double prevTime)
 
 		if (periodTotalFrames_ != 0 && static_cast<uint64_t>(prevTotalTime / period) != static_cast<uint64_t>(totalTime / period))
 		{
-			std::cout << "Benchmark: " << periodTotalFrames_ / totalTime << " fps" << std::endl;
+			std::cout << "Benchmark: " << periodTotalFrames_ / totalTime << " fps";
+			std::cout << " (CPU " << periodCpuFrameTime_ * 1000 / periodTotalFrames_ << " ms, GPU " << periodGpuFrameTime_ * 1000 / periodTotalFrames_ << " ms)" << std::endl;
+
+			// Resizing stalls the frames, report how long it took rather than leaving it hidden in the frame rate.
+			if (SwapChainRecreations() != periodSwapChainRecreations_)
+			{
+				std::cout << "Benchmark: swap chain recreated " << SwapChainRecreations() - periodSwapChainRecreations_ << " time(s), last in "
+					<< SwapChainRecreationTime() * 1000 << " ms" << std::endl;
+				periodSwapChainRecreations_ = SwapChainRecreations();
+			}
+
+			if (periodRayGpuFrameTime_ > 0)
+			{
+				const auto& rays = LastRayStatistics();
+
+				std::cout << "Benchmark: " << periodTracedRays_ / periodRayGpuFrameTime_ / 1000000 << " Mrays/s traced";
+				std::cout << " (last frame: " << rays.PrimaryRays << " primary, " << rays.SecondaryRays << " secondary, " << rays.Intersections << " intersection shaders; ";
+				std::cout << "path ends: " << rays.Misses << " miss, " << rays.Emissions << " light, " << rays.Absorptions << " absorbed, " << rays.BounceLimits << " bounce limit)" << std::endl;
+			}
+
 			periodInitialTime_ = time_;
 			periodTotalFrames_ = 0;
+			periodCpuFrameTime_ = 0;
+			periodGpuFrameTime_ = 0;
+			periodTracedRays_ = 0;
+			periodRayGpuFrameTime_ = 0;
 		}
 
 		periodTotalFrames_++;
+		periodCpuFrameTime_ += CpuFrameTime();
+		periodGpuFrameTime_ += GpuFrameTime();
 	}
 
-	// If in benchmark mode, bail out from the scene if we've reached the time or sample limit.
+	// If in benchmark mode, bail out from the scene if we've reached the time or sample limit (or the end of the fly-through).
 	{
 		const bool timeLimitReached = periodTotalFrames_ != 0 && Window().GetTime() - sceneInitialTime_ > userSettings_.BenchmarkMaxTime;
 		const bool sampleLimitReached = numberOfSamples_ == 0;
+		const bool sceneFinished = userSettings_.BenchmarkFlythrough
+			? CheckAndUpdateFlythroughState(prevTime)
+			: timeLimitReached || sampleLimitReached;
 
-		if (timeLimitReached || sampleLimitReached)
+		if (sceneFinished)
 		{
+			if (userSettings_.ProfileCosts)
+			{
+				costProfile_->Print(std::cout, 10);
+			}
+
 			if (!userSettings_.BenchmarkNextScenes || static_cast<size_t>(userSettings_.SceneIndex) == SceneList::AllScenes.size() - 1)
 			{
 				Window().Close();
@@ -333,6 +825,153 @@ void RayTracer::CheckAndUpdateBenchmarkState(double prevTime)
 	}
 }
 
+bool RayTracer::ApplyBenchmarkSweepConfiguration()
+{
+	if (benchmarkSweep_->IsComplete())
+	{
+		Window().Close();
+		return false;
+	}
+
+	// Keep the per frame work constant, rather than converging towards max-samples.
+	resetAccumulation_ = true;
+
+	if (!applySweepConfiguration_)
+	{
+		return true;
+	}
+
+	const auto& configuration = benchmarkSweep_->CurrentConfiguration();
+
+	userSettings_.SceneIndex = static_cast<int>(configuration.SceneIndex);
+	userSettings_.NumberOfSamples = configuration.NumberOfSamples;
+	userSettings_.NumberOfBounces = configuration.NumberOfBounces;
+	userSettings_.MaterialHitGroups = configuration.MaterialHitGroups != 0;
+	applySweepConfiguration_ = false;
+
+	// The device is reused across configurations, only the swap chain (and output images) are recreated.
+	// A scene change recreates everything anyway.
+	SetPresentMode(static_cast<VkPresentModeKHR>(configuration.PresentMode));
+
+	if (sceneIndex_ == configuration.SceneIndex)
+	{
+		RecreateSwapChain();
+		return false;
+	}
+
+	return true;
+}
+
+bool RayTracer::CheckAndUpdateFlythroughState(const double prevTime)
+{
+	if (!benchmarkPath_)
+	{
+		std::cout << "Benchmark: scene has no fly-through camera path, skipping" << std::endl;
+		return true;
+	}
+
+	// The GPU timestamps lag behind by the frames in flight, skip the frames that may still belong to the previous scene.
+	if (flythroughFrame_ >= FramesInFlight())
+	{
+		flythroughFrameTimes_.push_back(static_cast<float>(time_ - prevTime));
+		flythroughGpuFrameTimes_.push_back(GpuFrameTime());
+	}
+
+	if (++flythroughFrame_ != benchmarkPath_->NumberOfFrames(static_cast<float>(FlythroughFrameRate)))
+	{
+		return false;
+	}
+
+	std::cout << "Benchmark: fly-through of " << flythroughFrame_ << " frames (" << benchmarkPath_->Duration() << "s path at " 
+		<< FlythroughFrameRate << " steps per second, " << userSettings_.NumberOfSamples << " samples per frame)" << std::endl;
+
+	PrintFrameTimeDistribution("fly-through", flythroughFrameTimes_);
+	PrintFrameTimeDistribution("fly-through GPU", flythroughGpuFrameTimes_);
+
+	return true;
+}
+
+void RayTracer::CheckAndRecordCapture(VkCommandBuffer commandBuffer, const uint32_t frameIndex)
+{
+	++frameCount_;
+
+	const auto previousTotalNumberOfSamples = totalNumberOfSamples_ - numberOfSamples_;
+
+	// Video frames are read back as soon as they reach their sample count, the encoding overlapping the next frame tracing.
+	if (IsExportingVideo() && userSettings_.IsRayTraced &&
+		previousTotalNumberOfSamples < userSettings_.MaxNumberOfSamples && 
+		totalNumberOfSamples_ == userSettings_.MaxNumberOfSamples)
+	{
+		const auto readback = imageCapture_->AcquireVideoFrame(frameIndex, GetTraceExtent(), SwapChain().Format());
+		RecordImageReadback(commandBuffer, readback->AccumulationBuffer(), readback->OutputBuffer());
+	}
+
+	// Capture on user request, when reaching the requested sample count, or at regular frame intervals.
+	const bool sampleCountReached = 
+		userSettings_.CaptureAtSamples != 0 && 
+		previousTotalNumberOfSamples < userSettings_.CaptureAtSamples && 
+		totalNumberOfSamples_ >= userSettings_.CaptureAtSamples;
+	const bool periodReached = userSettings_.CaptureEvery != 0 && frameCount_ % userSettings_.CaptureEvery == 0;
+
+	if (!captureRequested_ && !sampleCountReached && !periodReached)
+	{
+		return;
+	}
+
+	captureRequested_ = false;
+
+	// Only the ray tracer has an accumulation image.
+	if (!userSettings_.IsRayTraced)
+	{
+		return;
+	}
+
+	std::ostringstream filename;
+	filename << userSettings_.CapturePrefix << "-scene" << sceneIndex_ << "-frame" << frameCount_ << "-" << totalNumberOfSamples_ << "spp";
+
+	const auto readback = imageCapture_->Acquire(frameIndex, GetTraceExtent(), SwapChain().Format(), totalNumberOfSamples_, filename.str());
+
+	if (readback != nullptr)
+	{
+		RecordImageReadback(commandBuffer, readback->AccumulationBuffer(), readback->OutputBuffer());
+	}
+}
+
+void RayTracer::CheckAndUpdateVideoExport()
+{
+	if (exportFrame_ == 0 && totalNumberOfSamples_ == 0)
+	{
+		exportInitialTime_ = Window().GetTime();
+	}
+
+	// Move on to the next frame once the current one has accumulated all its samples (and has been read back).
+	if (totalNumberOfSamples_ == userSettings_.MaxNumberOfSamples)
+	{
+		++exportFrame_;
+		resetAccumulation_ = true;
+
+		const auto elapsed = Window().GetTime() - exportInitialTime_;
+
+		std::cout << "- exported frame " << exportFrame_ << "/" << exportNumberOfFrames_
+			<< " (" << exportFrame_ * 3600 / elapsed << " frames/hour at " << userSettings_.MaxNumberOfSamples << " samples)" << std::endl;
+	}
+
+	if (exportFrame_ != exportNumberOfFrames_)
+	{
+		ApplyCameraPath(*cameraPath_, exportFrame_ / userSettings_.ExportFramesPerSecond);
+	}
+}
+
+void RayTracer::ApplyCameraPath(const CameraPath& cameraPath, const double time)
+{
+	const auto camera = cameraPath.Evaluate(static_cast<float>(time));
+
+	modelViewController_.Reset(camera.ModelView);
+	userSettings_.FieldOfView = camera.FieldOfView;
+	userSettings_.Aperture = camera.Aperture;
+	userSettings_.FocusDistance = camera.FocusDistance;
+}
+
 void RayTracer::CheckFramebufferSize() const
 {
 	// Check the framebuffer size when requesting a fullscreen window, as it's not guaranteed to match.
@@ -2,6 +2,7 @@
 
 #include "ModelViewController.hpp"
 #include "SceneList.hpp"
+#include "SceneLoader.hpp"
 #include "UserSettings.hpp"
 #include "Vulkan/RayTracing/Application.hpp"
 
@@ -11,13 +12,17 @@ public:
 
 	VULKAN_NON_COPIABLE(RayTracer)
 
-	RayTracer(const UserSettings& userSettings, const Vulkan::WindowConfig& windowConfig, VkPresentModeKHR presentMode);
+	RayTracer(const UserSettings& userSettings, const Vulkan::WindowConfig& windowConfig, VkPresentModeKHR presentMode, uint32_t framesInFlight);
 	~RayTracer();
 
 protected:
 
 	const Assets::Scene& GetScene() const override { return *scene_; }
 	Assets::UniformBufferObject GetUniformBufferObject(VkExtent2D extent) const override;
+	Vulkan::RayTracing::ShaderVariant GetShaderVariant() const override;
+	VkExtent2D GetTraceExtent() const override;
+	float GetRenderScale() const override;
+	bool IsConverged() const override { return converged_; }
 
 	void SetPhysicalDevice(
 		VkPhysicalDevice physicalDevice, 
@@ -28,8 +33,9 @@ protected:
 	void OnDeviceSet() override;
 	void CreateSwapChain() override;
 	void DeleteSwapChain() override;
+	bool IsIdle() const override;
 	void DrawFrame() override;
-	void Render(VkCommandBuffer commandBuffer, uint32_t imageIndex) override;
+	void Render(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex) override;
 
 	void OnKey(int key, int scancode, int action, int mods) override;
 	void OnCursorPosition(double xpos, double ypos) override;
@@ -38,9 +44,19 @@ protected:
 
 private:
 
-	void LoadScene(uint32_t sceneIndex);
+	glm::mat4 GetProjection(VkExtent2D imageExtent) const;
+	void LoadScene(std::unique_ptr<SceneLoader::Result> assets);
+	void SwitchScene();
 	void CheckAndUpdateBenchmarkState(double prevTime);
+	bool CheckAndUpdateFlythroughState(double prevTime);
+	bool ApplyBenchmarkSweepConfiguration();
 	void CheckFramebufferSize() const;
+	void CheckAndRecordCapture(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+	void CheckAndUpdateVideoExport();
+	void ApplyCameraPath(const class CameraPath& cameraPath, double time);
+	bool IsInteractive() const { return !userSettings_.Benchmark && !tiledRender_ && !cameraPath_ && !regressionTest_; }
+	bool IsFlythroughBenchmark() const { return userSettings_.Benchmark && userSettings_.BenchmarkFlythrough; }
+	bool IsExportingVideo() const { return !userSettings_.ExportVideo.empty(); }
 
 	uint32_t sceneIndex_{};
 	UserSettings userSettings_{};
@@ -48,17 +64,66 @@ private:
 	SceneList::CameraInitialSate cameraInitialSate_{};
 	ModelViewController modelViewController_{};
 
-	std::unique_ptr<const Assets::Scene> scene_;
+	std::unique_ptr<Assets::Scene> scene_;
+
+	// Uploaded and built while the current scene keeps rendering, switched to once ready (see SwitchScene()).
+	std::unique_ptr<Assets::Scene> nextScene_;
+	uint32_t nextSceneIndex_{};
+	SceneList::CameraInitialSate nextCameraState_{};
+
 	std::unique_ptr<class UserInterface> userInterface_;
+	std::unique_ptr<class TiledRender> tiledRender_;
+	std::unique_ptr<class ImageCapture> imageCapture_;
+	std::unique_ptr<class CameraPath> cameraPath_;
+	std::unique_ptr<class RegressionTest> regressionTest_;
+	std::unique_ptr<class CostProfile> costProfile_;
+	std::unique_ptr<class FrameTimeController> frameTimeController_;
+	std::unique_ptr<class SceneLoader> sceneLoader_;
 
 	double time_{};
 
 	uint32_t totalNumberOfSamples_{};
 	uint32_t numberOfSamples_{};
 	bool resetAccumulation_{};
+	bool converged_{};
+	uint32_t idleFrames_{};
+
+	// Interleaved tracing
+	glm::mat4 previousModelView_{};
+	glm::mat4 previousProjection_{};
+	uint32_t interleaveMode_{};
+	uint32_t interleaveFrame_{};
+	uint32_t historyIndex_{};
+	bool historyValid_{};
+
+	// Capture
+	uint64_t frameCount_{};
+	bool captureRequested_{};
+
+	// Video export
+	uint32_t exportFrame_{};
+	uint32_t exportNumberOfFrames_{};
+	VkExtent2D exportExtent_{}; // Locked when the export starts, resizing the window does not change it.
+	double exportInitialTime_{};
 
 	// Benchmark stats
 	double sceneInitialTime_{};
 	double periodInitialTime_{};
 	uint32_t periodTotalFrames_{};
+	double periodCpuFrameTime_{};
+	double periodGpuFrameTime_{};
+	double periodTracedRays_{};
+	double periodRayGpuFrameTime_{};
+	uint32_t periodSwapChainRecreations_{};
+	bool startupTimeReported_{};
+
+	// Benchmark sweep
+	std::unique_ptr<class BenchmarkSweep> benchmarkSweep_;
+	bool applySweepConfiguration_{};
+
+	// Fly-through benchmark
+	std::unique_ptr<class CameraPath> benchmarkPath_;
+	uint32_t flythroughFrame_{};
+	std::vector<float> flythroughFrameTimes_;
+	std::vector<float> flythroughGpuFrameTimes_;
 };
@@ -0,0 +1,298 @@
+#include "RegressionTest.hpp"
+#include "SceneList.hpp"
+#include "Utilities/Exception.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+	// Images are stored as linear RGB, top to bottom.
+	typedef std::vector<float> Image;
+
+	void WritePfm(const std::string& filename, const uint32_t width, const uint32_t height, const Image& image)
+	{
+		// Color PFM, the negative scale denotes little endian floats, scanlines are stored bottom to top.
+		std::ofstream file(filename, std::ios::binary);
+		file << "PF\n" << width << " " << height << "\n-1.0\n";
+
+		for (uint32_t y = height; y-- != 0; )
+		{
+			file.write(reinterpret_cast<const char*>(image.data() + static_cast<size_t>(y) * width * 3), static_cast<std::streamsize>(width) * 3 * sizeof(float));
+		}
+
+		if (!file)
+		{
+			Throw(std::runtime_error("cannot write '" + filename + "'"));
+		}
+	}
+
+	bool ReadPfm(const std::string& filename, const uint32_t width, const uint32_t height, Image& image)
+	{
+		std::ifstream file(filename, std::ios::binary);
+		std::string format;
+		uint32_t fileWidth, fileHeight;
+		float scale;
+
+		if (!(file >> format >> fileWidth >> fileHeight >> scale) || format != "PF" || scale >= 0)
+		{
+			return false;
+		}
+
+		if (fileWidth != width || fileHeight != height)
+		{
+			Throw(std::runtime_error("reference '" + filename + "' does not match the regression test image size"));
+		}
+
+		file.get(); // Single whitespace before the raster.
+		image.resize(static_cast<size_t>(width) * height * 3);
+
+		for (uint32_t y = height; y-- != 0; )
+		{
+			file.read(reinterpret_cast<char*>(image.data() + static_cast<size_t>(y) * width * 3), static_cast<std::streamsize>(width) * 3 * sizeof(float));
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	// The output images are clamped and gamma corrected, compare what is displayed rather than raw radiance with its fireflies.
+	float Display(const float linear)
+	{
+		return std::sqrt(std::clamp(linear, 0.0f, 1.0f));
+	}
+
+	double MeanSquaredError(const Image& a, const Image& b)
+	{
+		double sum = 0;
+
+		for (size_t i = 0; i != a.size(); ++i)
+		{
+			const double d = Display(a[i]) - Display(b[i]);
+			sum += d * d;
+		}
+
+		return sum / a.size();
+	}
+
+	// Clamped linear RGB to CIELAB (sRGB primaries, D65 white).
+	void ToLab(const Image& image, std::vector<float>& lab)
+	{
+		lab.resize(image.size());
+
+		const auto f = [](const float t)
+		{
+			return t > 0.008856f ? std::cbrt(t) : 7.787f * t + 16.0f / 116.0f;
+		};
+
+		for (size_t i = 0; i < image.size(); i += 3)
+		{
+			const float r = std::clamp(image[i + 0], 0.0f, 1.0f);
+			const float g = std::clamp(image[i + 1], 0.0f, 1.0f);
+			const float b = std::clamp(image[i + 2], 0.0f, 1.0f);
+
+			const float x = (0.4124f * r + 0.3576f * g + 0.1805f * b) / 0.9505f;
+			const float y = (0.2126f * r + 0.7152f * g + 0.0722f * b);
+			const float z = (0.0193f * r + 0.1192f * g + 0.9505f * b) / 1.0890f;
+
+			lab[i + 0] = 116.0f * f(y) - 16.0f;
+			lab[i + 1] = 500.0f * (f(x) - f(y));
+			lab[i + 2] = 200.0f * (f(y) - f(z));
+		}
+	}
+
+	// Separable 5-tap Gaussian (sigma ~ 1 pixel), a crude stand-in for the contrast sensitivity filtering of the eye.
+	void Blur(const uint32_t width, const uint32_t height, std::vector<float>& image)
+	{
+		const float weights[] = { 0.0614f, 0.2448f, 0.3877f, 0.2448f, 0.0614f };
+		std::vector<float> temp(image.size());
+
+		for (int pass = 0; pass != 2; ++pass)
+		{
+			for (uint32_t y = 0; y != height; ++y)
+			{
+				for (uint32_t x = 0; x != width; ++x)
+				{
+					for (uint32_t c = 0; c != 3; ++c)
+					{
+						float sum = 0;
+
+						for (int k = -2; k <= 2; ++k)
+						{
+							const int sx = pass == 0 ? std::clamp(static_cast<int>(x) + k, 0, static_cast<int>(width) - 1) : static_cast<int>(x);
+							const int sy = pass == 1 ? std::clamp(static_cast<int>(y) + k, 0, static_cast<int>(height) - 1) : static_cast<int>(y);
+
+							sum += weights[k + 2] * image[(static_cast<size_t>(sy) * width + sx) * 3 + c];
+						}
+
+						temp[(static_cast<size_t>(y) * width + x) * 3 + c] = sum;
+					}
+				}
+			}
+
+			image.swap(temp);
+		}
+	}
+
+	// FLIP-like error: mean HyAB colour distance of the spatially filtered CIELAB images, normalised to [0, 1].
+	// This follows the spirit of NVIDIA's FLIP (colour pipeline only, no feature detection), it is not the reference implementation.
+	double FlipLikeError(const uint32_t width, const uint32_t height, const Image& a, const Image& b)
+	{
+		std::vector<float> labA, labB;
+		ToLab(a, labA);
+		ToLab(b, labB);
+		Blur(width, height, labA);
+		Blur(width, height, labB);
+
+		const double maxDistance = 100.0;
+		double sum = 0;
+
+		for (size_t i = 0; i < labA.size(); i += 3)
+		{
+			const double dl = labA[i + 0] - labB[i + 0];
+			const double da = labA[i + 1] - labB[i + 1];
+			const double db = labA[i + 2] - labB[i + 2];
+			const double hyab = std::abs(dl) + std::sqrt(da * da + db * db);
+
+			sum += std::min(hyab / maxDistance, 1.0);
+		}
+
+		return sum / (labA.size() / 3);
+	}
+}
+
+RegressionTest::RegressionTest(std::string directory, const uint32_t width, const uint32_t height, const uint32_t numberOfSamples, const bool updateReferences) :
+	directory_(std::move(directory)),
+	width_(width),
+	height_(height),
+	numberOfSamples_(numberOfSamples),
+	updateReferences_(updateReferences)
+{
+	LoadThresholds();
+
+	std::cout << "- regression test " << width_ << "x" << height_ << ", " << numberOfSamples_ << " samples per pixel, "
+		<< (updateReferences_ ? "updating" : "comparing against") << " the references in '" << directory_ << "'" << std::endl;
+}
+
+void RegressionTest::BeginScene()
+{
+	if (!sceneBegun_)
+	{
+		sceneStartTime_ = std::chrono::steady_clock::now();
+		sceneBegun_ = true;
+	}
+}
+
+void RegressionTest::CheckScene(const uint32_t sceneIndex, const std::vector<float>& accumulatedColors)
+{
+	const auto timeToImage = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::steady_clock::now() - sceneStartTime_).count();
+	const auto pixelCount = static_cast<size_t>(width_) * height_;
+	const auto scale = 1.0f / numberOfSamples_;
+	const auto filename = ReferenceFilename(sceneIndex);
+	const auto& sceneName = SceneList::AllScenes[sceneIndex].first;
+
+	sceneBegun_ = false;
+
+	Image image(pixelCount * 3);
+
+	for (size_t i = 0; i != pixelCount; ++i)
+	{
+		image[i * 3 + 0] = accumulatedColors[i * 4 + 0] * scale;
+		image[i * 3 + 1] = accumulatedColors[i * 4 + 1] * scale;
+		image[i * 3 + 2] = accumulatedColors[i * 4 + 2] * scale;
+	}
+
+	if (updateReferences_)
+	{
+		WritePfm(filename, width_, height_, image);
+		std::cout << "Regression: scene #" << sceneIndex << " '" << sceneName << "' written to '" << filename << "' (time-to-image " << timeToImage << "s)" << std::endl;
+		return;
+	}
+
+	// A scene without a (readable) reference has not been tested, which must not pass silently.
+	Image reference;
+
+	if (!ReadPfm(filename, width_, height_, reference))
+	{
+		std::cout << "Regression: scene #" << sceneIndex << " '" << sceneName << "': missing or unreadable reference '" << filename << "' "
+			<< "(use --regression-update to write it): FAILED" << std::endl;
+
+		WritePfm(directory_ + "/scene" + std::to_string(sceneIndex) + ".failed.pfm", width_, height_, image);
+		failures_.push_back(sceneName + " (no reference)");
+		return;
+	}
+
+	const auto mse = MeanSquaredError(image, reference);
+	const auto rmse = std::sqrt(mse);
+	const auto psnr = mse > 0 ? 10 * std::log10(1 / mse) : std::numeric_limits<double>::infinity();
+	const auto flip = FlipLikeError(width_, height_, image, reference);
+
+	const auto threshold = thresholds_.find(sceneIndex);
+	const auto thresholds = threshold != thresholds_.end() ? threshold->second : defaultThresholds_;
+	const bool passed = psnr >= thresholds.MinPsnr && flip <= thresholds.MaxFlip;
+
+	std::cout << "Regression: scene #" << sceneIndex << " '" << sceneName << "': "
+		<< "RMSE " << rmse << ", PSNR " << psnr << " dB (min " << thresholds.MinPsnr << "), "
+		<< "FLIP " << flip << " (max " << thresholds.MaxFlip << "), "
+		<< "time-to-image " << timeToImage << "s: " << (passed ? "PASSED" : "FAILED") << std::endl;
+
+	if (!passed)
+	{
+		// Keep the failed image next to the reference for inspection.
+		WritePfm(directory_ + "/scene" + std::to_string(sceneIndex) + ".failed.pfm", width_, height_, image);
+		failures_.push_back(sceneName);
+	}
+}
+
+void RegressionTest::Finish() const
+{
+	if (failures_.empty())
+	{
+		std::cout << "Regression: all scenes passed" << std::endl;
+		return;
+	}
+
+	std::ostringstream message;
+	message << failures_.size() << " scene(s) failed the image regression test:";
+
+	for (const auto& failure : failures_)
+	{
+		message << " '" << failure << "'";
+	}
+
+	Throw(std::runtime_error(message.str()));
+}
+
+std::string RegressionTest::ReferenceFilename(const uint32_t sceneIndex) const
+{
+	return directory_ + "/scene" + std::to_string(sceneIndex) + ".pfm";
+}
+
+void RegressionTest::LoadThresholds()
+{
+	std::ifstream file(directory_ + "/thresholds.txt");
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		line = line.substr(0, line.find('#'));
+
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+		{
+			continue;
+		}
+
+		std::istringstream in(line);
+		uint32_t sceneIndex;
+		Thresholds thresholds = {};
+
+		if (!(in >> sceneIndex >> thresholds.MinPsnr >> thresholds.MaxFlip))
+		{
+			Throw(std::runtime_error("invalid regression thresholds line '" + line + "'"));
+		}
+
+		thresholds_[sceneIndex] = thresholds;
+	}
+}
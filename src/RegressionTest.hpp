@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Renders each scene to a fixed sample count and compares the image against a stored linear PFM reference
+// (<directory>/sceneN.pfm) using RMSE, PSNR and a FLIP-like perceptual error. Thresholds can be overridden
+// per scene by a <directory>/thresholds.txt file with one "scene min-psnr max-flip" per line.
+// The time-to-image is reported alongside, so that performance changes can be shown to be quality neutral.
+class RegressionTest final
+{
+public:
+
+	RegressionTest(const RegressionTest&) = delete;
+	RegressionTest(RegressionTest&&) = delete;
+	RegressionTest& operator = (const RegressionTest&) = delete;
+	RegressionTest& operator = (RegressionTest&&) = delete;
+
+	RegressionTest(std::string directory, uint32_t width, uint32_t height, uint32_t numberOfSamples, bool updateReferences);
+	~RegressionTest() = default;
+
+	uint32_t Width() const { return width_; }
+	uint32_t Height() const { return height_; }
+
+	// Start the time-to-image timer of the current scene, if not already started.
+	void BeginScene();
+
+	// Compare the RGBA accumulation image (i.e. the sum of all samples) against the scene reference (or write it when updating).
+	void CheckScene(uint32_t sceneIndex, const std::vector<float>& accumulatedColors);
+
+	// Print the summary, throws if any scene has failed.
+	void Finish() const;
+
+private:
+
+	struct Thresholds
+	{
+		double MinPsnr;
+		double MaxFlip;
+	};
+
+	std::string ReferenceFilename(uint32_t sceneIndex) const;
+	void LoadThresholds();
+
+	const std::string directory_;
+	const uint32_t width_;
+	const uint32_t height_;
+	const uint32_t numberOfSamples_;
+	const bool updateReferences_;
+
+	// Tolerant of the noise of differently ordered but equivalent computations.
+	const Thresholds defaultThresholds_{ 35.0, 0.02 };
+	std::map<uint32_t, Thresholds> thresholds_;
+	std::vector<std::string> failures_;
+
+	bool sceneBegun_{};
+	std::chrono::steady_clock::time_point sceneStartTime_;
+};
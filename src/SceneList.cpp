@@ -58,6 +58,32 @@ namespace
 		}
 	}
 
+	std::vector<CameraPath::Keyframe> OneWeekendBenchmarkPath(const float aperture, const float targetHeight)
+	{
+		// Orbit the scene, then skim through the small spheres for incoherent, disoccluded views.
+		return
+		{
+			{ 0.0f, vec3(13, 2, 3), vec3(0, targetHeight, 0), 20, aperture, 13.5f },
+			{ 2.5f, vec3(8, 1.2f, -7), vec3(0, targetHeight, 0), 30, aperture, 10.7f },
+			{ 5.0f, vec3(0, 0.6f, -6), vec3(-4, 1, 0), 45, aperture, 7.2f },
+			{ 7.5f, vec3(-7, 1.5f, 3), vec3(0, targetHeight, 0), 30, aperture, 7.8f },
+			{ 10.0f, vec3(6, 3, 9), vec3(0, targetHeight, 0), 20, aperture, 11.2f },
+		};
+	}
+
+	std::vector<CameraPath::Keyframe> CornellBoxBenchmarkPath()
+	{
+		// Fly into the box and look around before backing out.
+		return
+		{
+			{ 0.0f, vec3(278, 278, 800), vec3(278, 278, 0), 40, 0.0f, 10.0f },
+			{ 3.0f, vec3(278, 278, 150), vec3(278, 200, -300), 40, 0.0f, 10.0f },
+			{ 6.0f, vec3(450, 400, -100), vec3(200, 100, -400), 60, 0.0f, 10.0f },
+			{ 8.0f, vec3(100, 300, -200), vec3(450, 150, -300), 60, 0.0f, 10.0f },
+			{ 10.0f, vec3(278, 278, 800), vec3(278, 278, 0), 40, 0.0f, 10.0f },
+		};
+	}
+
 }
 
 const std::vector<std::pair<std::string, std::function<SceneAssets (SceneList::CameraInitialSate&)>>> SceneList::AllScenes =
@@ -81,6 +107,14 @@ SceneAssets SceneList::CubeAndSpheres(CameraInitialSate& camera)
 	camera.ControlSpeed = 2.0f;
 	camera.GammaCorrection = false;
 	camera.HasSky = true;
+	camera.BenchmarkPath =
+	{
+		{ 0.0f, vec3(0, 0, 2), vec3(0), 90, 0.05f, 2.0f },
+		{ 2.5f, vec3(2.5f, 1, 0), vec3(0), 90, 0.05f, 2.7f },
+		{ 5.0f, vec3(0, -0.5f, -2.5f), vec3(0), 90, 0.05f, 2.5f },
+		{ 7.5f, vec3(-2.5f, 1, 0), vec3(0), 90, 0.05f, 2.7f },
+		{ 10.0f, vec3(0, 0, 2), vec3(0), 90, 0.05f, 2.0f },
+	};
 
 	std::vector<Model> models;
 	std::vector<Texture> textures;
@@ -106,6 +140,7 @@ SceneAssets SceneList::RayTracingInOneWeekend(CameraInitialSate& camera)
 	camera.ControlSpeed = 5.0f;
 	camera.GammaCorrection = true;
 	camera.HasSky = true;
+	camera.BenchmarkPath = OneWeekendBenchmarkPath(0.1f, 0);
 
 	const bool isProc = true;
 
@@ -134,6 +169,7 @@ SceneAssets SceneList::PlanetsInOneWeekend(CameraInitialSate& camera)
 	camera.ControlSpeed = 5.0f;
 	camera.GammaCorrection = true;
 	camera.HasSky = true;
+	camera.BenchmarkPath = OneWeekendBenchmarkPath(0.1f, 0);
 
 	const bool isProc = true;
 
@@ -167,6 +203,7 @@ SceneAssets SceneList::LucyInOneWeekend(CameraInitialSate& camera)
 	camera.ControlSpeed = 5.0f;
 	camera.GammaCorrection = true;
 	camera.HasSky = true;
+	camera.BenchmarkPath = OneWeekendBenchmarkPath(0.05f, 1);
 
 	const bool isProc = true;
 
@@ -225,6 +262,7 @@ SceneAssets SceneList::CornellBox(CameraInitialSate& camera)
 	camera.ControlSpeed = 500.0f;
 	camera.GammaCorrection = true;
 	camera.HasSky = false;
+	camera.BenchmarkPath = CornellBoxBenchmarkPath();
 
 	const auto i = mat4(1);
 	const auto white = Material::Lambertian(vec3(0.73f, 0.73f, 0.73f));
@@ -252,6 +290,7 @@ SceneAssets SceneList::CornellBoxLucy(CameraInitialSate& camera)
 	camera.ControlSpeed = 500.0f;
 	camera.GammaCorrection = true;
 	camera.HasSky = false;
+	camera.BenchmarkPath = CornellBoxBenchmarkPath();
 
 	const auto i = mat4(1);
 	const auto sphere = Model::CreateSphere(vec3(555 - 130, 165.0f, -165.0f / 2 - 65), 80.0f, Material::Dielectric(1.5f), true);
@@ -1,4 +1,5 @@
 #pragma once
+#include "CameraPath.hpp"
 #include "Utilities/Glm.hpp"
 #include <functional>
 #include <string>
@@ -26,6 +27,7 @@ public:
 		float ControlSpeed;
 		bool GammaCorrection;
 		bool HasSky;
+		std::vector<CameraPath::Keyframe> BenchmarkPath; // Optional, replayed by the fly-through benchmark.
 	};
 
 	static SceneAssets CubeAndSpheres(CameraInitialSate& camera);
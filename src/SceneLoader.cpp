@@ -0,0 +1,87 @@
+#include "SceneLoader.hpp"
+#include "Utilities/Tracer.hpp"
+#include "Vulkan/Sampler.hpp"
+#include <chrono>
+
+SceneLoader::~SceneLoader()
+{
+	if (future_.valid())
+	{
+		future_.wait();
+	}
+}
+
+std::unique_ptr<SceneLoader::Result> SceneLoader::Load(const uint32_t sceneIndex)
+{
+	Utilities::Tracer::Zone zone("CreateSceneAssets", SceneList::AllScenes[sceneIndex].first);
+
+	std::unique_ptr<Result> result(new Result());
+	result->SceneIndex = sceneIndex;
+	std::tie(result->Models, result->Textures) = SceneList::AllScenes[sceneIndex].second(result->Camera);
+
+	// If there are no texture, add a dummy one. It makes the pipeline setup a lot easier.
+	if (result->Textures.empty())
+	{
+		result->Textures.push_back(Assets::Texture::LoadTexture("../assets/textures/white.png", Vulkan::SamplerConfig()));
+	}
+
+	return result;
+}
+
+void SceneLoader::Request(const uint32_t sceneIndex)
+{
+	if (hasRequest_ && requestedSceneIndex_ == sceneIndex)
+	{
+		return;
+	}
+
+	requestedSceneIndex_ = sceneIndex;
+	hasRequest_ = true;
+
+	// Otherwise, the load in progress is superseded once it completes (see TakeResult()).
+	if (!future_.valid())
+	{
+		Start();
+	}
+}
+
+void SceneLoader::Cancel()
+{
+	hasRequest_ = false;
+}
+
+std::unique_ptr<SceneLoader::Result> SceneLoader::TakeResult()
+{
+	if (!future_.valid() || future_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		return nullptr;
+	}
+
+	auto result = future_.get();
+
+	if (!hasRequest_)
+	{
+		return nullptr;
+	}
+
+	if (result->SceneIndex != requestedSceneIndex_)
+	{
+		Start();
+		return nullptr;
+	}
+
+	hasRequest_ = false;
+
+	return result;
+}
+
+void SceneLoader::Start()
+{
+	const auto sceneIndex = requestedSceneIndex_;
+
+	future_ = std::async(std::launch::async, [sceneIndex]()
+	{
+		Utilities::Tracer::SetThreadName("SceneLoader");
+		return Load(sceneIndex);
+	});
+}
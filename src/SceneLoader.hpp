@@ -0,0 +1,56 @@
+#pragma once
+
+#include "SceneList.hpp"
+#include "Assets/Model.hpp"
+#include "Assets/Texture.hpp"
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+
+// Creates the scene assets (model parsing, texture decoding, procedural generation) on a worker thread,
+// so that the current scene keeps rendering meanwhile. Only the latest request matters: a load whose scene
+// is no longer wanted once it completes is dropped, and the latest request started in its place.
+class SceneLoader final
+{
+public:
+
+	struct Result final
+	{
+		uint32_t SceneIndex{};
+		SceneList::CameraInitialSate Camera{};
+		std::vector<Assets::Model> Models;
+		std::vector<Assets::Texture> Textures;
+	};
+
+	SceneLoader(const SceneLoader&) = delete;
+	SceneLoader(SceneLoader&&) = delete;
+	SceneLoader& operator = (const SceneLoader&) = delete;
+	SceneLoader& operator = (SceneLoader&&) = delete;
+
+	SceneLoader() = default;
+	~SceneLoader(); // Waits for the load in progress, if any.
+
+	// Create the scene assets on the calling thread.
+	static std::unique_ptr<Result> Load(uint32_t sceneIndex);
+
+	// Load the given scene in the background, unless it is already the latest request.
+	void Request(uint32_t sceneIndex);
+
+	// The scene is no longer wanted (e.g. the user went back to the current one).
+	void Cancel();
+
+	bool HasRequest() const { return hasRequest_; }
+	uint32_t RequestedSceneIndex() const { return requestedSceneIndex_; }
+
+	// The assets of the latest request once they are ready, nullptr otherwise. Rethrows the errors of the worker.
+	std::unique_ptr<Result> TakeResult();
+
+private:
+
+	void Start();
+
+	std::future<std::unique_ptr<Result>> future_;
+	uint32_t requestedSceneIndex_{};
+	bool hasRequest_{};
+};
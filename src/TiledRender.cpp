@@ -0,0 +1,217 @@
+#include "TiledRender.hpp"
+#include "Utilities/Exception.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+	std::string PfmHeader(const uint32_t width, const uint32_t height)
+	{
+		// Color PFM, the negative scale denotes little endian floats.
+		std::ostringstream out;
+		out << "PF\n" << width << " " << height << "\n-1.0\n";
+		return out.str();
+	}
+
+	std::string ProgressHeader(
+		const uint32_t width, const uint32_t height, const uint32_t tileSize, const uint32_t numberOfSamples,
+		const uint32_t sceneIndex, const size_t settingsHash)
+	{
+		std::ostringstream out;
+		out << width << " " << height << " " << tileSize << " " << numberOfSamples << " " << sceneIndex << " " << std::hex << settingsHash;
+		return out.str();
+	}
+}
+
+TiledRender::TiledRender(
+	std::string filename, const uint32_t width, const uint32_t height, const uint32_t tileSize, const uint32_t numberOfSamples,
+	const uint32_t sceneIndex, const size_t settingsHash) :
+	filename_(std::move(filename)),
+	progressFilename_(filename_ + ".progress"),
+	header_(PfmHeader(width, height)),
+	width_(width),
+	height_(height),
+	tileSize_(tileSize),
+	numberOfSamples_(numberOfSamples),
+	progressHeader_(ProgressHeader(width, height, tileSize, numberOfSamples, sceneIndex, settingsHash))
+{
+	for (uint32_t y = 0; y < height_; y += tileSize_)
+	{
+		for (uint32_t x = 0; x < width_; x += tileSize_)
+		{
+			tiles_.push_back({ x, y, std::min(tileSize_, width_ - x), std::min(tileSize_, height_ - y) });
+		}
+	}
+
+	if (!Resume())
+	{
+		Create();
+	}
+
+	image_.open(filename_, std::ios::in | std::ios::out | std::ios::binary);
+	progress_.open(progressFilename_, std::ios::app);
+
+	if (!image_ || !progress_)
+	{
+		Throw(std::runtime_error("failed to open '" + filename_ + "' for tiled rendering"));
+	}
+
+	std::cout << "- tiled render " << width_ << "x" << height_ << " to '" << filename_ << "': "
+		<< tiles_.size() << " tiles of " << tileSize_ << "x" << tileSize_ << ", " << numberOfSamples_ << " samples per pixel";
+
+	if (pendingTiles_.size() != tiles_.size())
+	{
+		std::cout << " (resuming, " << tiles_.size() - pendingTiles_.size() << " tiles already done)";
+	}
+
+	std::cout << std::endl;
+
+	startTime_ = std::chrono::steady_clock::now();
+}
+
+TiledRender::~TiledRender()
+{
+	progress_.close();
+	image_.close();
+
+	// The progress file is only useful to resume an incomplete render.
+	if (IsComplete())
+	{
+		std::filesystem::remove(progressFilename_);
+	}
+}
+
+void TiledRender::WriteTile(const std::vector<float>& accumulatedColors)
+{
+	const auto tileIndex = pendingTiles_[nextTile_];
+	const auto& tile = tiles_[tileIndex];
+	const auto scale = 1.0f / numberOfSamples_;
+
+	// The launch covers a full tile size, even on the image edges.
+	const auto pitch = static_cast<size_t>(std::min(tileSize_, width_)) * 4;
+
+	if (accumulatedColors.size() < pitch * tile.Height)
+	{
+		Throw(std::invalid_argument("accumulation buffer is smaller than the tile"));
+	}
+
+	std::vector<float> row(static_cast<size_t>(tile.Width) * 3);
+
+	for (uint32_t y = 0; y != tile.Height; ++y)
+	{
+		const float* src = accumulatedColors.data() + y * pitch;
+
+		for (uint32_t x = 0; x != tile.Width; ++x)
+		{
+			row[x * 3 + 0] = src[x * 4 + 0] * scale;
+			row[x * 3 + 1] = src[x * 4 + 1] * scale;
+			row[x * 3 + 2] = src[x * 4 + 2] * scale;
+		}
+
+		// PFM scanlines are stored bottom to top.
+		const auto fileRow = static_cast<size_t>(height_ - 1 - (tile.Y + y));
+		const auto offset = header_.size() + (fileRow * width_ + tile.X) * 3 * sizeof(float);
+
+		image_.seekp(static_cast<std::streamoff>(offset));
+		image_.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(float));
+	}
+
+	image_.flush();
+
+	if (!image_)
+	{
+		Throw(std::runtime_error("failed to write tile to '" + filename_ + "'"));
+	}
+
+	// Only log the tile once its pixels are safely on disk.
+	progress_ << tileIndex << std::endl;
+	++nextTile_;
+
+	const auto done = tiles_.size() - pendingTiles_.size() + nextTile_;
+	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::steady_clock::now() - startTime_).count();
+	const auto eta = elapsed / nextTile_ * (pendingTiles_.size() - nextTile_);
+
+	std::cout << "- tile " << done << "/" << tiles_.size()
+		<< " (" << 100.0f * done / tiles_.size() << "%)"
+		<< ", elapsed " << elapsed << "s, ETA " << eta << "s" << std::endl;
+
+	if (IsComplete())
+	{
+		std::cout << "- finished tiled render '" << filename_ << "' in " << elapsed << "s" << std::endl;
+	}
+}
+
+bool TiledRender::Resume()
+{
+	std::ifstream progress(progressFilename_);
+	std::string header;
+
+	if (!progress || !std::getline(progress, header))
+	{
+		return false;
+	}
+
+	// The finished tiles would not match the ones still to render.
+	if (header != progressHeader_)
+	{
+		Throw(std::runtime_error("'" + progressFilename_ + "' belongs to a render of another size, scene, camera or settings "
+			"(delete it to start over)"));
+	}
+
+	const auto expectedSize = header_.size() + static_cast<uintmax_t>(width_) * height_ * 3 * sizeof(float);
+	std::error_code error;
+
+	if (std::filesystem::file_size(filename_, error) != expectedSize || error)
+	{
+		return false;
+	}
+
+	std::vector<bool> done(tiles_.size());
+	uint32_t tileIndex;
+
+	while (progress >> tileIndex)
+	{
+		if (tileIndex < done.size())
+		{
+			done[tileIndex] = true;
+		}
+	}
+
+	for (uint32_t i = 0; i != tiles_.size(); ++i)
+	{
+		if (!done[i])
+		{
+			pendingTiles_.push_back(i);
+		}
+	}
+
+	return true;
+}
+
+void TiledRender::Create()
+{
+	// Allocate the whole image on disk upfront, tiles are then written in place.
+	{
+		std::ofstream image(filename_, std::ios::binary | std::ios::trunc);
+		image << header_;
+
+		if (!image)
+		{
+			Throw(std::runtime_error("failed to create '" + filename_ + "'"));
+		}
+	}
+
+	std::filesystem::resize_file(filename_, header_.size() + static_cast<uintmax_t>(width_) * height_ * 3 * sizeof(float));
+
+	std::ofstream progress(progressFilename_, std::ios::trunc);
+	progress << progressHeader_ << std::endl;
+
+	pendingTiles_.resize(tiles_.size());
+
+	for (uint32_t i = 0; i != tiles_.size(); ++i)
+	{
+		pendingTiles_[i] = i;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Renders a still image much larger than the swap chain by splitting it into tiles, each one accumulated
+// up to the target sample count before moving on to the next. Finished tiles are streamed straight into
+// a PFM file on disk, and the finished tile indices are logged in a side file so that an interrupted
+// render can be resumed. The side file header records the image, scene and settings hash of the render,
+// resuming with any of them different is an error.
+class TiledRender final
+{
+public:
+
+	struct Tile
+	{
+		uint32_t X;
+		uint32_t Y;
+		uint32_t Width;
+		uint32_t Height;
+	};
+
+	TiledRender(const TiledRender&) = delete;
+	TiledRender(TiledRender&&) = delete;
+	TiledRender& operator = (const TiledRender&) = delete;
+	TiledRender& operator = (TiledRender&&) = delete;
+
+	TiledRender(
+		std::string filename, uint32_t width, uint32_t height, uint32_t tileSize, uint32_t numberOfSamples,
+		uint32_t sceneIndex, size_t settingsHash);
+	~TiledRender();
+
+	uint32_t Width() const { return width_; }
+	uint32_t Height() const { return height_; }
+	uint32_t TileSize() const { return tileSize_; }
+
+	bool IsComplete() const { return nextTile_ == pendingTiles_.size(); }
+	const Tile& CurrentTile() const { return tiles_[pendingTiles_[nextTile_]]; }
+
+	// Write the current tile from the tile sized RGBA accumulation buffer (i.e. the sum of all samples), then move on to the next tile.
+	void WriteTile(const std::vector<float>& accumulatedColors);
+
+private:
+
+	bool Resume();
+	void Create();
+
+	const std::string filename_;
+	const std::string progressFilename_;
+	const std::string header_;
+	const uint32_t width_;
+	const uint32_t height_;
+	const uint32_t tileSize_;
+	const uint32_t numberOfSamples_;
+	const std::string progressHeader_;
+
+	std::vector<Tile> tiles_;
+	std::vector<uint32_t> pendingTiles_;
+	size_t nextTile_{};
+
+	std::fstream image_;
+	std::ofstream progress_;
+
+	std::chrono::steady_clock::time_point startTime_;
+};
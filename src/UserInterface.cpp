@@ -1,6 +1,8 @@
 #include "UserInterface.hpp"
+#include "CostProfile.hpp"
 #include "SceneList.hpp"
 #include "UserSettings.hpp"
+#include "Assets/Material.hpp"
 #include "Utilities/Exception.hpp"
 #include "Vulkan/DescriptorPool.hpp"
 #include "Vulkan/Device.hpp"
@@ -17,6 +19,7 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_vulkan.h>
 
+#include <algorithm>
 #include <array>
 
 namespace
@@ -119,6 +122,7 @@ void UserInterface::Render(VkCommandBuffer commandBuffer, const Vulkan::FrameBuf
 
 	DrawSettings();
 	DrawOverlay(statistics);
+	DrawCosts(statistics);
 	//ImGui::ShowStyleEditor();
 	ImGui::Render();
 
@@ -179,6 +183,7 @@ void UserInterface::DrawSettings()
 		ImGui::Separator();
 		ImGui::BulletText("F1: toggle Settings.");
 		ImGui::BulletText("F2: toggle Statistics.");
+		ImGui::BulletText("F12: capture images.");
 		ImGui::BulletText(
 			"%c%c%c%c/SHIFT/CTRL: move camera.", 
 			std::toupper(window.GetKeyName(GLFW_KEY_W, 0)[0]),
@@ -201,6 +206,12 @@ void UserInterface::DrawSettings()
 		ImGui::Checkbox("Accumulate rays between frames", &Settings().AccumulateRays);
 		uint32_t min = 1, max = 128;
 		ImGui::SliderScalar("Samples", ImGuiDataType_U32, &Settings().NumberOfSamples, &min, &max);
+		ImGui::SliderFloat("Render scale", &Settings().RenderScale, UserSettings::RenderScaleMinValue, UserSettings::RenderScaleMaxValue, "%.3f");
+		ImGui::Checkbox("Adapt samples to frame time", &Settings().AdaptiveSamples);
+		ImGui::Checkbox("Adapt render scale too", &Settings().AdaptiveRenderScale);
+		ImGui::SliderFloat("Target (ms)", &Settings().TargetFrameTime, 4.0f, 100.0f, "%.1f", ImGuiSliderFlags_Logarithmic);
+		const char* interleavePatterns[] = { "Off", "Checkerboard", "2x2" };
+		ImGui::Combo("Interleave in motion", &Settings().InterleavedTracing, interleavePatterns, IM_ARRAYSIZE(interleavePatterns));
 		min = 1, max = 32;
 		ImGui::SliderScalar("Bounces", ImGuiDataType_U32, &Settings().NumberOfBounces, &min, &max);
 		ImGui::NewLine();
@@ -216,6 +227,8 @@ void UserInterface::DrawSettings()
 		ImGui::Separator();
 		ImGui::Checkbox("Show heatmap", &Settings().ShowHeatmap);
 		ImGui::SliderFloat("Scaling", &Settings().HeatmapScale, 0.10f, 10.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+		ImGui::Checkbox("Profile shader costs", &Settings().ProfileCosts);
+		ImGui::Checkbox("Material hit groups", &Settings().MaterialHitGroups);
 		ImGui::NewLine();
 	}
 	ImGui::End();
@@ -248,8 +261,103 @@ void UserInterface::DrawOverlay(const Statistics& statistics)
 		ImGui::Text("Statistics (%dx%d):", statistics.FramebufferSize.width, statistics.FramebufferSize.height);
 		ImGui::Separator();
 		ImGui::Text("Frame rate: %.1f fps", statistics.FrameRate);
-		ImGui::Text("Primary ray rate: %.2f Gr/s", statistics.RayRate);
+		ImGui::Text("Frame time: %.2f ms CPU, %.2f ms GPU", statistics.CpuFrameTime, statistics.GpuFrameTime);
+
+		if (statistics.HasRayStatistics)
+		{
+			const auto& rays = statistics.Rays;
+			const auto terminations = static_cast<float>(std::max<uint64_t>(rays.Misses + rays.Emissions + rays.Absorptions + rays.BounceLimits, 1));
+
+			ImGui::Text("Ray rate: %.2f Gr/s", statistics.RayRate);
+			ImGui::Text("Rays: %.2fM primary, %.2fM secondary", rays.PrimaryRays / 1e6f, rays.SecondaryRays / 1e6f);
+			ImGui::Text("Intersection shaders: %.2fM", rays.Intersections / 1e6f);
+			ImGui::Text("Path ends: %.0f%% miss, %.0f%% light, %.0f%% absorbed, %.0f%% bounce limit",
+				100 * rays.Misses / terminations, 100 * rays.Emissions / terminations,
+				100 * rays.Absorptions / terminations, 100 * rays.BounceLimits / terminations);
+		}
+		else
+		{
+			ImGui::Text("Primary ray rate (estimated): %.2f Gr/s", statistics.RayRate);
+		}
+
 		ImGui::Text("Accumulated samples:  %u", statistics.TotalSamples);
+
+		if (statistics.RenderScale < 1)
+		{
+			ImGui::Text("Render scale: %.1f%% (%ux%u upscaled)", statistics.RenderScale * 100, statistics.RenderSize.width, statistics.RenderSize.height);
+		}
+
+		if (statistics.AdaptiveSamples)
+		{
+			ImGui::Text("Adaptive samples: %u per frame (%.1f ms target, %.3f ms/sample)",
+				statistics.NumberOfSamples, statistics.TargetFrameTime, statistics.SampleTime);
+		}
+
+		if (statistics.LoadingScene != nullptr)
+		{
+			ImGui::Text("Loading scene: %s...", statistics.LoadingScene);
+		}
+	}
+	ImGui::End();
+}
+
+void UserInterface::DrawCosts(const Statistics& statistics)
+{
+	if (statistics.Costs == nullptr)
+	{
+		return;
+	}
+
+	const auto& io = ImGui::GetIO();
+	const float distance = 10.0f;
+	const ImVec2 pos = ImVec2(io.DisplaySize.x - distance, io.DisplaySize.y - distance);
+	const ImVec2 posPivot = ImVec2(1.0f, 1.0f);
+	ImGui::SetNextWindowPos(pos, ImGuiCond_Always, posPivot);
+	ImGui::SetNextWindowBgAlpha(0.3f); // Transparent background
+
+	const auto flags =
+		ImGuiWindowFlags_AlwaysAutoResize |
+		ImGuiWindowFlags_NoDecoration |
+		ImGuiWindowFlags_NoFocusOnAppearing |
+		ImGuiWindowFlags_NoMove |
+		ImGuiWindowFlags_NoNav |
+		ImGuiWindowFlags_NoSavedSettings;
+
+	// Material models first, then the most expensive instances.
+	const auto drawTable = [](const char* const id, const std::vector<CostProfile::Entry>& entries, const size_t maxRows)
+	{
+		if (!ImGui::BeginTable(id, 4, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg))
+		{
+			return;
+		}
+
+		ImGui::TableSetupColumn(id);
+		ImGui::TableSetupColumn("Clocks");
+		ImGui::TableSetupColumn("Invocations");
+		ImGui::TableSetupColumn("Clocks/inv.");
+		ImGui::TableHeadersRow();
+
+		for (size_t i = 0; i != std::min(maxRows, entries.size()) && entries[i].Clocks != 0; ++i)
+		{
+			const auto& entry = entries[i];
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::TextUnformatted(entry.Name.c_str());
+			ImGui::TableNextColumn(); ImGui::Text("%.1f%%", entry.ClockShare * 100);
+			ImGui::TableNextColumn(); ImGui::Text("%.2fM", (entry.Hits + entry.Intersections) / 1e6);
+			ImGui::TableNextColumn(); ImGui::Text("%.0f", entry.ClocksPerInvocation());
+		}
+
+		ImGui::EndTable();
+	};
+
+	if (ImGui::Begin("Shader Costs", nullptr, flags))
+	{
+		ImGui::Text("Shader costs (%u frames):", statistics.Costs->NumberOfFrames());
+		ImGui::Separator();
+		drawTable("Material model", statistics.Costs->MaterialModels(), Assets::Material::NumberOfModels);
+		ImGui::NewLine();
+		drawTable("Instance", statistics.Costs->Instances(), 12);
 	}
 	ImGui::End();
 }
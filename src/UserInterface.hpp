@@ -1,5 +1,6 @@
 #pragma once
 #include "Vulkan/Vulkan.hpp"
+#include "Vulkan/RayTracing/ShaderCounters.hpp"
 #include <memory>
 
 namespace Vulkan
@@ -12,14 +13,37 @@ namespace Vulkan
 	class SwapChain;
 }
 
+class CostProfile;
 struct UserSettings;
 
 struct Statistics final
 {
 	VkExtent2D FramebufferSize;
 	float FrameRate;
+	float CpuFrameTime;
+	float GpuFrameTime;
 	float RayRate;
 	uint32_t TotalSamples;
+
+	// Counted by the ray tracing shaders, RayRate is then the measured rate of all the traced rays.
+	bool HasRayStatistics;
+	Vulkan::RayTracing::RayStatistics Rays;
+
+	// Only set when profiling the shader costs.
+	const CostProfile* Costs;
+
+	// Samples per frame chosen by the frame time controller to meet the target GPU frame time (ms).
+	bool AdaptiveSamples;
+	uint32_t NumberOfSamples;
+	float TargetFrameTime;
+	float SampleTime;
+
+	// The ray tracing resolution, when rendering at a fraction of the swap chain and upscaling.
+	float RenderScale;
+	VkExtent2D RenderSize;
+
+	// The scene being loaded in the background, if any.
+	const char* LoadingScene;
 };
 
 class UserInterface final
@@ -46,6 +70,7 @@ private:
 
 	void DrawSettings();
 	void DrawOverlay(const Statistics& statistics);
+	void DrawCosts(const Statistics& statistics);
 
 	std::unique_ptr<Vulkan::DescriptorPool> descriptorPool_;
 	std::unique_ptr<Vulkan::RenderPass> renderPass_;
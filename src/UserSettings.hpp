@@ -1,13 +1,21 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+
 struct UserSettings final
 {
 	// Application
 	bool Benchmark;
+	std::string PipelineCache;
 
 	// Benchmark
 	bool BenchmarkNextScenes{};
 	uint32_t BenchmarkMaxTime{};
+	bool BenchmarkFlythrough{};
+	std::string BenchmarkSweep;
+	std::string BenchmarkBaseline;
+	std::string BenchmarkResults;
 	
 	// Scene
 	int SceneIndex;
@@ -18,6 +26,34 @@ struct UserSettings final
 	uint32_t NumberOfSamples;
 	uint32_t NumberOfBounces;
 	uint32_t MaxNumberOfSamples;
+	float RenderScale{ 1.0f };
+	bool AdaptiveSamples{};
+	bool AdaptiveRenderScale{};
+	float TargetFrameTime{};
+	int InterleavedTracing{}; // 0: off, 1: checkerboard, 2: 2x2 (only while the accumulation restarts every frame).
+
+	// Tiled render
+	std::string RenderOutput;
+	uint32_t RenderWidth{};
+	uint32_t RenderHeight{};
+	uint32_t TileSize{};
+
+	// Capture
+	uint32_t CaptureAtSamples{};
+	uint32_t CaptureEvery{};
+	std::string CapturePrefix;
+
+	// Camera path
+	std::string CameraPath;
+	std::string ExportVideo;
+	float ExportFramesPerSecond{};
+
+	// Regression test
+	std::string RegressionTest;
+	bool RegressionUpdate{};
+	uint32_t RegressionSamples{};
+	uint32_t RegressionWidth{};
+	uint32_t RegressionHeight{};
 
 	// Camera
 	float FieldOfView;
@@ -27,6 +63,8 @@ struct UserSettings final
 	// Profiler
 	bool ShowHeatmap;
 	float HeatmapScale;
+	bool ProfileCosts;
+	bool MaterialHitGroups;
 
 	// UI
 	bool ShowSettings;
@@ -35,12 +73,16 @@ struct UserSettings final
 	inline const static float FieldOfViewMinValue = 10.0f;
 	inline const static float FieldOfViewMaxValue = 90.0f;
 
+	inline const static float RenderScaleMinValue = 0.5f;
+	inline const static float RenderScaleMaxValue = 1.0f;
+
 	bool RequiresAccumulationReset(const UserSettings& prev) const
 	{
 		return
 			IsRayTraced != prev.IsRayTraced ||
 			AccumulateRays != prev.AccumulateRays ||
 			NumberOfBounces != prev.NumberOfBounces ||
+			RenderScale != prev.RenderScale ||
 			FieldOfView != prev.FieldOfView ||
 			Aperture != prev.Aperture ||
 			FocusDistance != prev.FocusDistance;
@@ -1,16 +1,15 @@
 #pragma once
 
-#include "Vulkan/Vulkan.hpp"
-
 namespace Utilities
 {
+	// Values match VkDebugUtilsMessageSeverityFlagBitsEXT, without dragging the Vulkan headers into non-Vulkan code.
 	enum class Severity
 	{
-		Verbos = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT,
-		Info = VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT,
-		Warning = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT,
-		Error = VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT,
-		Fatal = VK_DEBUG_UTILS_MESSAGE_SEVERITY_FLAG_BITS_MAX_ENUM_EXT
+		Verbos = 0x00000001,
+		Info = 0x00000010,
+		Warning = 0x00000100,
+		Error = 0x00001000,
+		Fatal = 0x7FFFFFFF
 	};
 
 	class Console final
@@ -0,0 +1,190 @@
+#include "Tracer.hpp"
+#include "Utilities/Exception.hpp"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace Utilities {
+
+namespace
+{
+	struct Event
+	{
+		const char* Name;
+		std::string Detail;
+		int64_t Start; // In nanoseconds since the tracer creation.
+		int64_t Duration;
+		uint32_t ThreadIndex;
+	};
+
+	// Long interactive sessions would otherwise grow without bounds (a frame records a handful of zones).
+	const size_t MaxEvents = 2 * 1024 * 1024;
+
+	std::chrono::steady_clock::time_point epoch;
+	std::mutex mutex;
+	std::vector<Event> events;
+	std::vector<std::pair<uint32_t, std::string>> threadNames;
+	std::atomic<uint32_t> nextThreadIndex{};
+	bool overflowed{};
+
+	uint32_t ThreadIndex()
+	{
+		thread_local const uint32_t index = nextThreadIndex++;
+		return index;
+	}
+
+	int64_t Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+	}
+
+	std::string Escape(const std::string& text)
+	{
+		std::string escaped;
+		escaped.reserve(text.size());
+
+		for (const char c : text)
+		{
+			if (c == '"' || c == '\\') escaped += '\\';
+			escaped += static_cast<unsigned char>(c) < 0x20 ? ' ' : c;
+		}
+
+		return escaped;
+	}
+
+	void Record(const char* const name, std::string detail, const int64_t start)
+	{
+		const auto end = Now();
+		const auto threadIndex = ThreadIndex();
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (events.size() == MaxEvents)
+		{
+			overflowed = true;
+			return;
+		}
+
+		events.push_back({ name, std::move(detail), start, end - start, threadIndex });
+	}
+}
+
+std::atomic<bool> Tracer::enabled_{};
+
+Tracer::Zone::Zone(const char* const name) :
+	name_(name),
+	start_(IsEnabled() ? Now() : -1)
+{
+}
+
+Tracer::Zone::Zone(const char* const name, std::string detail) :
+	name_(name),
+	detail_(std::move(detail)),
+	start_(IsEnabled() ? Now() : -1)
+{
+}
+
+Tracer::Zone::~Zone()
+{
+	if (start_ >= 0 && IsEnabled())
+	{
+		Record(name_, std::move(detail_), start_);
+	}
+}
+
+Tracer::Tracer(std::string filename) :
+	filename_(std::move(filename))
+{
+	if (filename_.empty())
+	{
+		return;
+	}
+
+	if (IsEnabled())
+	{
+		Throw(std::logic_error("tracer is already recording"));
+	}
+
+	epoch = std::chrono::steady_clock::now();
+	events.reserve(64 * 1024);
+	enabled_ = true;
+
+	SetThreadName("Main");
+}
+
+Tracer::~Tracer()
+{
+	if (filename_.empty())
+	{
+		return;
+	}
+
+	enabled_ = false;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::ofstream file(filename_);
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	file << std::fixed << std::setprecision(3);
+
+	bool first = true;
+
+	for (const auto& thread : threadNames)
+	{
+		file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.first
+			<< ",\"args\":{\"name\":\"" << Escape(thread.second) << "\"}}";
+		first = false;
+	}
+
+	for (const auto& event : events)
+	{
+		file << (first ? "" : ",\n") << "{\"name\":\"" << Escape(event.Name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.ThreadIndex
+			<< ",\"ts\":" << event.Start / 1000.0 << ",\"dur\":" << event.Duration / 1000.0;
+
+		if (!event.Detail.empty())
+		{
+			file << ",\"args\":{\"detail\":\"" << Escape(event.Detail) << "\"}";
+		}
+
+		file << "}";
+		first = false;
+	}
+
+	file << "\n]}\n";
+
+	// Never throw from a destructor, a missing trace is not worth aborting for.
+	if (!file)
+	{
+		std::cerr << "WARNING: failed to write trace file '" << filename_ << "'" << std::endl;
+		return;
+	}
+
+	if (overflowed)
+	{
+		std::cerr << "WARNING: trace truncated to its first " << MaxEvents << " zones" << std::endl;
+	}
+
+	std::cout << "- trace of " << events.size() << " zones written to '" << filename_ << "'" << std::endl;
+
+	events.clear();
+	threadNames.clear();
+	overflowed = false;
+}
+
+void Tracer::SetThreadName(const char* const name)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	const auto threadIndex = ThreadIndex();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	threadNames.emplace_back(threadIndex, name);
+}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Utilities
+{
+	// Lightweight scoped-zone tracer, written out as Chrome trace event JSON (chrome://tracing, ui.perfetto.dev).
+	// Zones are only recorded while a tracer instance is alive, and cost a single atomic load otherwise.
+	class Tracer final
+	{
+	public:
+
+		class Zone final
+		{
+		public:
+
+			Zone(const Zone&) = delete;
+			Zone(Zone&&) = delete;
+			Zone& operator = (const Zone&) = delete;
+			Zone& operator = (Zone&&) = delete;
+
+			// The name must outlive the tracer (e.g. a string literal), the optional detail is copied.
+			explicit Zone(const char* name);
+			Zone(const char* name, std::string detail);
+			~Zone();
+
+		private:
+
+			const char* const name_;
+			std::string detail_;
+			int64_t start_{ -1 };
+		};
+
+		Tracer(const Tracer&) = delete;
+		Tracer(Tracer&&) = delete;
+		Tracer& operator = (const Tracer&) = delete;
+		Tracer& operator = (Tracer&&) = delete;
+
+		// Start recording if the filename is not empty, the trace is written when the tracer is destroyed.
+		explicit Tracer(std::string filename);
+		~Tracer();
+
+		static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+		// Name the calling thread in the trace.
+		static void SetThreadName(const char* name);
+
+	private:
+
+		static std::atomic<bool> enabled_;
+
+		const std::string filename_;
+	};
+}
@@ -2,36 +2,57 @@
 #include "Buffer.hpp"
 #include "CommandPool.hpp"
 #include "CommandBuffers.hpp"
+#include "CommandQueue.hpp"
 #include "DebugUtilsMessenger.hpp"
 #include "DepthBuffer.hpp"
 #include "Device.hpp"
+#include "Enumerate.hpp"
 #include "Fence.hpp"
 #include "FrameBuffer.hpp"
 #include "GraphicsPipeline.hpp"
 #include "Instance.hpp"
+#include "PipelineCache.hpp"
 #include "PipelineLayout.hpp"
+#include "QueryPool.hpp"
 #include "RenderPass.hpp"
 #include "Semaphore.hpp"
 #include "Surface.hpp"
 #include "SwapChain.hpp"
+#include "TimelineSemaphore.hpp"
 #include "Window.hpp"
 #include "Assets/Model.hpp"
 #include "Assets/Scene.hpp"
 #include "Assets/UniformBuffer.hpp"
 #include "Utilities/Exception.hpp"
+#include "Utilities/Tracer.hpp"
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
 
 namespace Vulkan {
 
-Application::Application(const WindowConfig& windowConfig, const VkPresentModeKHR presentMode, const bool enableValidationLayers) :
-	presentMode_(presentMode)
+Application::Application(const WindowConfig& windowConfig, const VkPresentModeKHR presentMode, const uint32_t framesInFlight, const bool enableValidationLayers) :
+	presentMode_(presentMode),
+	framesInFlight_(framesInFlight)
 {
+	Utilities::Tracer::Zone zone("Application::Application");
+
 	const auto validationLayers = enableValidationLayers
 		? std::vector<const char*>{"VK_LAYER_KHRONOS_validation"}
 		: std::vector<const char*>();
 
-	window_.reset(new class Window(windowConfig));
-	instance_.reset(new Instance(*window_, validationLayers, VK_API_VERSION_1_2));
+	{
+		Utilities::Tracer::Zone windowZone("CreateWindow");
+		window_.reset(new class Window(windowConfig));
+	}
+
+	{
+		Utilities::Tracer::Zone instanceZone("CreateInstance");
+		instance_.reset(new Instance(*window_, validationLayers, VK_API_VERSION_1_2));
+	}
+
 	debugUtilsMessenger_.reset(enableValidationLayers ? new DebugUtilsMessenger(*instance_, VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT) : nullptr);
 	surface_.reset(new Surface(*instance_));
 }
@@ -39,8 +60,20 @@ Application::Application(const WindowConfig& windowConfig, const VkPresentModeKH
 Application::~Application()
 {
 	Application::DeleteSwapChain();
+	Application::DeletePipelines();
 
+	retired_.clear();
+	timestampsWritten_.clear();
+	inFlightFences_.clear();
+	imageAvailableSemaphores_.clear();
+	timestampQueryPool_.reset();
+	commandBuffers_.reset();
+	uniformBuffers_.clear();
+	transferQueue_.reset();
+	computeQueue_.reset();
+	graphicsQueue_.reset();
 	commandPool_.reset();
+	pipelineCache_.reset();
 	device_.reset();
 	surface_.reset();
 	debugUtilsMessenger_.reset();
@@ -70,6 +103,8 @@ void Application::SetPhysicalDevice(VkPhysicalDevice physicalDevice)
 		Throw(std::logic_error("physical device has already been set"));
 	}
 
+	Utilities::Tracer::Zone zone("Application::SetPhysicalDevice");
+
 	std::vector<const char*> requiredExtensions = 
 	{
 		// VK_KHR_swapchain
@@ -95,6 +130,7 @@ void Application::Run()
 	currentFrame_ = 0;
 
 	window_->DrawFrame = [this]() { DrawFrame(); };
+	window_->IsIdle = [this]() { return IsIdle(); };
 	window_->OnKey = [this](const int key, const int scancode, const int action, const int mods) { OnKey(key, scancode, action, mods); };
 	window_->OnCursorPosition = [this](const double xpos, const double ypos) { OnCursorPosition(xpos, ypos); };
 	window_->OnMouseButton = [this](const int button, const int action, const int mods) { OnMouseButton(button, action, mods); };
@@ -109,8 +145,49 @@ void Application::SetPhysicalDevice(
 	VkPhysicalDeviceFeatures& deviceFeatures,
 	void* nextDeviceFeatures)
 {
-	device_.reset(new class Device(physicalDevice, *surface_, requiredExtensions, deviceFeatures, nextDeviceFeatures));
+	Utilities::Tracer::Zone zone("CreateDevice");
+
+	// Optional, lets the command queues compare their timestamps (see CalibratedTimestamps).
+	const auto extensions = GetEnumerateVector(physicalDevice, static_cast<const char*>(nullptr), vkEnumerateDeviceExtensionProperties);
+	const auto hasCalibratedTimestamps = std::any_of(extensions.begin(), extensions.end(), [](const VkExtensionProperties& extension)
+	{
+		return strcmp(extension.extensionName, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) == 0;
+	});
+
+	if (hasCalibratedTimestamps)
+	{
+		requiredExtensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+	}
+
+	// Required by the command queues (see CommandQueue).
+	VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures = {};
+	timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+	timelineSemaphoreFeatures.pNext = nextDeviceFeatures;
+	timelineSemaphoreFeatures.timelineSemaphore = true;
+
+	VkPhysicalDeviceHostQueryResetFeatures hostQueryResetFeatures = {};
+	hostQueryResetFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_QUERY_RESET_FEATURES;
+	hostQueryResetFeatures.pNext = &timelineSemaphoreFeatures;
+	hostQueryResetFeatures.hostQueryReset = true;
+
+	device_.reset(new class Device(physicalDevice, *surface_, requiredExtensions, deviceFeatures, &hostQueryResetFeatures));
 	commandPool_.reset(new class CommandPool(*device_, device_->GraphicsFamilyIndex(), true));
+	graphicsQueue_.reset(new CommandQueue(*device_, device_->GraphicsFamilyIndex(), device_->GraphicsQueue(), "Graphics"));
+	computeQueue_.reset(new CommandQueue(*device_, device_->ComputeFamilyIndex(), device_->ComputeQueue(), "Compute"));
+	transferQueue_.reset(new CommandQueue(*device_, device_->TransferFamilyIndex(), device_->TransferQueue(), "Transfer"));
+	pipelineCache_.reset(new class PipelineCache(*device_, pipelineCacheFilename_));
+
+	// Per frame in flight resources, independent from the number of swap chain images.
+	for (uint32_t i = 0; i != framesInFlight_; ++i)
+	{
+		imageAvailableSemaphores_.emplace_back(*device_);
+		inFlightFences_.emplace_back(*device_, true);
+		uniformBuffers_.emplace_back(*device_);
+	}
+
+	commandBuffers_.reset(new CommandBuffers(*commandPool_, framesInFlight_));
+	timestampQueryPool_.reset(new QueryPool(*device_, VK_QUERY_TYPE_TIMESTAMP, 2 * framesInFlight_));
+	timestampsWritten_.assign(framesInFlight_, false);
 }
 
 void Application::OnDeviceSet()
@@ -119,6 +196,8 @@ void Application::OnDeviceSet()
 
 void Application::CreateSwapChain()
 {
+	Utilities::Tracer::Zone zone("Application::CreateSwapChain");
+
 	// Wait until the window is visible.
 	while (window_->IsMinimized())
 	{
@@ -128,51 +207,97 @@ void Application::CreateSwapChain()
 	swapChain_.reset(new class SwapChain(*device_, presentMode_));
 	depthBuffer_.reset(new class DepthBuffer(*commandPool_, swapChain_->Extent()));
 
+	// The presentation engine holds on to the semaphore until the image is presented, hence one per swap chain image.
 	for (size_t i = 0; i != swapChain_->ImageViews().size(); ++i)
 	{
-		imageAvailableSemaphores_.emplace_back(*device_);
 		renderFinishedSemaphores_.emplace_back(*device_);
-		inFlightFences_.emplace_back(*device_, true);
-		uniformBuffers_.emplace_back(*device_);
 	}
 
-	graphicsPipeline_.reset(new class GraphicsPipeline(*swapChain_, *depthBuffer_, uniformBuffers_, GetScene(), isWireFrame_));
+	renderPass_.reset(new class RenderPass(*swapChain_, *depthBuffer_, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_LOAD_OP_CLEAR));
 
-	for (const auto& imageView : swapChain_->ImageViews())
+	// The pipeline only depends on the scene and the render pass formats, it survives swap chain recreation.
+	if (!graphicsPipeline_ || !graphicsPipeline_->IsCompatible(*renderPass_))
 	{
-		swapChainFramebuffers_.emplace_back(*imageView, graphicsPipeline_->RenderPass());
+		CreateGraphicsPipeline();
 	}
 
-	commandBuffers_.reset(new CommandBuffers(*commandPool_, static_cast<uint32_t>(swapChainFramebuffers_.size())));
+	for (const auto& imageView : swapChain_->ImageViews())
+	{
+		swapChainFramebuffers_.emplace_back(*imageView, *renderPass_);
+	}
 }
 
 void Application::DeleteSwapChain()
 {
-	commandBuffers_.reset();
 	swapChainFramebuffers_.clear();
-	graphicsPipeline_.reset();
-	uniformBuffers_.clear();
-	inFlightFences_.clear();
+	renderPass_.reset();
 	renderFinishedSemaphores_.clear();
-	imageAvailableSemaphores_.clear();
 	depthBuffer_.reset();
 	swapChain_.reset();
 }
 
+void Application::DeletePipelines()
+{
+	graphicsPipeline_.reset();
+}
+
+void Application::RecreatePipelines()
+{
+	if (!graphicsPipeline_)
+	{
+		return;
+	}
+
+	Retire(std::move(graphicsPipeline_));
+	CreateGraphicsPipeline();
+}
+
+void Application::Retire(std::shared_ptr<void> resource)
+{
+	retired_.push_back({ graphicsQueue_->LastSubmitted(), std::move(resource) });
+}
+
+void Application::ReleaseRetired()
+{
+	const auto completed = graphicsQueue_->Timeline().Value();
+
+	while (!retired_.empty() && retired_.front().Value <= completed)
+	{
+		retired_.pop_front();
+	}
+}
+
 void Application::DrawFrame()
 {
+	Utilities::Tracer::Zone zone("Application::DrawFrame");
+
 	const auto noTimeout = std::numeric_limits<uint64_t>::max();
 
 	auto& inFlightFence = inFlightFences_[currentFrame_];
 	const auto imageAvailableSemaphore = imageAvailableSemaphores_[currentFrame_].Handle();
-	const auto renderFinishedSemaphore = renderFinishedSemaphores_[currentFrame_].Handle();
 
-	inFlightFence.Wait(noTimeout);
+	{
+		Utilities::Tracer::Zone waitZone("WaitForFrameFence");
+		inFlightFence.Wait(noTimeout);
+	}
+
+	// The resources retired before the completed submissions are no longer used.
+	ReleaseRetired();
+
+	// The previous use of this frame slot has completed, its timestamps are available.
+	ReadFrameTimestamps(currentFrame_);
 
 	uint32_t imageIndex;
-	auto result = vkAcquireNextImageKHR(device_->Handle(), swapChain_->Handle(), noTimeout, imageAvailableSemaphore, nullptr, &imageIndex);
+	VkResult result;
 
-	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || isWireFrame_ != graphicsPipeline_->IsWireFrame())
+	{
+		Utilities::Tracer::Zone acquireZone("AcquireNextImage");
+		result = vkAcquireNextImageKHR(device_->Handle(), swapChain_->Handle(), noTimeout, imageAvailableSemaphore, nullptr, &imageIndex);
+	}
+
+	// A suboptimal image has been acquired and its semaphore will be signaled, so it must still be rendered and presented
+	// (the frame semaphores outlive the swap chain). The swap chain is recreated after the present instead.
+	if (result == VK_ERROR_OUT_OF_DATE_KHR)
 	{
 		RecreateSwapChain();
 		return;
@@ -183,11 +308,23 @@ void Application::DrawFrame()
 		Throw(std::runtime_error(std::string("failed to acquire next image (") + ToString(result) + ")"));
 	}
 
-	const auto commandBuffer = commandBuffers_->Begin(imageIndex);
-	Render(commandBuffer, imageIndex);
-	commandBuffers_->End(imageIndex);
+	const auto timer = std::chrono::high_resolution_clock::now();
+	const auto renderFinishedSemaphore = renderFinishedSemaphores_[imageIndex].Handle();
+	const auto queryPool = timestampQueryPool_->Handle();
+	const auto firstQuery = 2 * currentFrame_;
+
+	const auto commandBuffer = commandBuffers_->Begin(currentFrame_);
+
+	{
+		Utilities::Tracer::Zone recordZone("RecordCommandBuffer");
+		vkCmdResetQueryPool(commandBuffer, queryPool, firstQuery, 2);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, firstQuery);
+		Render(commandBuffer, currentFrame_, imageIndex);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, firstQuery + 1);
+		commandBuffers_->End(currentFrame_);
+	}
 
-	UpdateUniformBuffer(imageIndex);
+	UpdateUniformBuffer(currentFrame_);
 
 	VkSubmitInfo submitInfo = {};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -207,8 +344,23 @@ void Application::DrawFrame()
 
 	inFlightFence.Reset();
 
-	Check(vkQueueSubmit(device_->GraphicsQueue(), 1, &submitInfo, inFlightFence.Handle()),
-		"submit draw command buffer");
+	{
+		Utilities::Tracer::Zone submitZone("QueueSubmit");
+		Check(vkQueueSubmit(device_->GraphicsQueue(), 1, &submitInfo, inFlightFence.Handle()),
+			"submit draw command buffer");
+	}
+
+	timestampsWritten_[currentFrame_] = true;
+	cpuFrameTime_ = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+
+	// The pipelines (and the ray tracing variants compiled on first use) have been created while recording the first frame
+	// since they were (re)created, persist them now rather than only on exit.
+	if (savePipelineCache_)
+	{
+		Utilities::Tracer::Zone saveZone("SavePipelineCache");
+		pipelineCache_->Save();
+		savePipelineCache_ = false;
+	}
 
 	VkSwapchainKHR swapChains[] = { swapChain_->Handle() };
 	VkPresentInfoKHR presentInfo = {};
@@ -220,7 +372,10 @@ void Application::DrawFrame()
 	presentInfo.pImageIndices = &imageIndex;
 	presentInfo.pResults = nullptr; // Optional
 
-	result = vkQueuePresentKHR(device_->PresentQueue(), &presentInfo);
+	{
+		Utilities::Tracer::Zone presentZone("QueuePresent");
+		result = vkQueuePresentKHR(device_->PresentQueue(), &presentInfo);
+	}
 
 	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
 	{
@@ -233,10 +388,10 @@ void Application::DrawFrame()
 		Throw(std::runtime_error(std::string("failed to present next image (") + ToString(result) + ")"));
 	}
 
-	currentFrame_ = (currentFrame_ + 1) % inFlightFences_.size();
+	currentFrame_ = (currentFrame_ + 1) % framesInFlight_;
 }
 
-void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageIndex)
+void Application::Render(VkCommandBuffer commandBuffer, const uint32_t frameIndex, const uint32_t imageIndex)
 {
 	std::array<VkClearValue, 2> clearValues = {};
 	clearValues[0].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
@@ -244,7 +399,7 @@ void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageInde
 
 	VkRenderPassBeginInfo renderPassInfo = {};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassInfo.renderPass = graphicsPipeline_->RenderPass().Handle();
+	renderPassInfo.renderPass = renderPass_->Handle();
 	renderPassInfo.framebuffer = swapChainFramebuffers_[imageIndex].Handle();
 	renderPassInfo.renderArea.offset = { 0, 0 };
 	renderPassInfo.renderArea.extent = swapChain_->Extent();
@@ -255,14 +410,28 @@ void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageInde
 	{
 		const auto& scene = GetScene();
 
-		VkDescriptorSet descriptorSets[] = { graphicsPipeline_->DescriptorSet(imageIndex) };
-		VkBuffer vertexBuffers[] = { scene.VertexBuffer().Handle() };
+		VkDescriptorSet descriptorSets[] = { graphicsPipeline_->DescriptorSet(frameIndex) };
+		VkBuffer vertexBuffers[] = { scene.VertexBuffer().Handle(), scene.ProxyInstanceBuffer().Handle() };
 		const VkBuffer indexBuffer = scene.IndexBuffer().Handle();
-		VkDeviceSize offsets[] = { 0 };
-
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_->Handle());
+		VkDeviceSize offsets[] = { 0, 0 };
+
+		VkViewport viewport = {};
+		viewport.x = 0.0f;
+		viewport.y = 0.0f;
+		viewport.width = static_cast<float>(swapChain_->Extent().width);
+		viewport.height = static_cast<float>(swapChain_->Extent().height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+
+		VkRect2D scissor = {};
+		scissor.offset = { 0, 0 };
+		scissor.extent = swapChain_->Extent();
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, isWireFrame_ ? graphicsPipeline_->WireFrameHandle() : graphicsPipeline_->Handle());
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
-		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+		vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
 		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
 		uint32_t vertexOffset = 0;
@@ -273,25 +442,76 @@ void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageInde
 			const auto vertexCount = static_cast<uint32_t>(model.NumberOfVertices());
 			const auto indexCount = static_cast<uint32_t>(model.NumberOfIndices());
 
-			vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
+			// Procedural models have no triangles, they are drawn below using the proxy mesh.
+			if (indexCount != 0)
+			{
+				vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
+			}
 
 			vertexOffset += vertexCount;
 			indexOffset += indexCount;
 		}
+
+		// Draw all the procedural spheres in one go, the first proxy instance being the identity one used above.
+		if (scene.ProxyInstanceCount() != 0)
+		{
+			VkBuffer proxyVertexBuffers[] = { scene.ProxyVertexBuffer().Handle(), scene.ProxyInstanceBuffer().Handle() };
+
+			vkCmdBindVertexBuffers(commandBuffer, 0, 2, proxyVertexBuffers, offsets);
+			vkCmdBindIndexBuffer(commandBuffer, scene.ProxyIndexBuffer().Handle(), 0, VK_INDEX_TYPE_UINT32);
+			vkCmdDrawIndexed(commandBuffer, scene.ProxyIndexCount(), scene.ProxyInstanceCount(), 0, 0, 1);
+		}
 	}
 	vkCmdEndRenderPass(commandBuffer);
 }
 
-void Application::UpdateUniformBuffer(const uint32_t imageIndex)
+void Application::CreateGraphicsPipeline()
 {
-	uniformBuffers_[imageIndex].SetValue(GetUniformBufferObject(swapChain_->Extent()));
+	Utilities::Tracer::Zone zone("CreateGraphicsPipeline");
+	const auto timer = std::chrono::high_resolution_clock::now();
+
+	graphicsPipeline_.reset(new class GraphicsPipeline(*renderPass_, *pipelineCache_, uniformBuffers_, GetScene()));
+	savePipelineCache_ = true;
+
+	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+	std::cout << "- created graphics pipelines in " << elapsed << "s" << std::endl;
+}
+
+void Application::UpdateUniformBuffer(const uint32_t frameIndex)
+{
+	uniformBuffers_[frameIndex].SetValue(GetUniformBufferObject(swapChain_->Extent()));
 }
 
 void Application::RecreateSwapChain()
 {
+	Utilities::Tracer::Zone zone("Application::RecreateSwapChain");
+
+	const auto timer = std::chrono::high_resolution_clock::now();
+
 	device_->WaitIdle();
 	DeleteSwapChain();
 	CreateSwapChain();
+
+	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+	std::cout << "- recreated swap chain in " << elapsed << "s" << std::endl;
+
+	++swapChainRecreations_;
+	swapChainRecreationTime_ = elapsed;
+}
+
+void Application::ReadFrameTimestamps(const uint32_t frameIndex)
+{
+	if (!timestampsWritten_[frameIndex])
+	{
+		return;
+	}
+
+	std::vector<uint64_t> timestamps;
+
+	if (timestampQueryPool_->GetResults(2 * frameIndex, 2, timestamps))
+	{
+		gpuFrameTime_ = static_cast<float>((timestamps[1] - timestamps[0]) * timestampQueryPool_->TimestampPeriod());
+	}
 }
 
 }
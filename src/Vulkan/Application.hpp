@@ -2,6 +2,8 @@
 
 #include "FrameBuffer.hpp"
 #include "WindowConfig.hpp"
+#include <deque>
+#include <string>
 #include <vector>
 #include <memory>
 
@@ -37,14 +39,41 @@ namespace Vulkan
 
 	protected:
 
-		Application(const WindowConfig& windowConfig, VkPresentModeKHR presentMode, bool enableValidationLayers);
+		Application(const WindowConfig& windowConfig, VkPresentModeKHR presentMode, uint32_t framesInFlight, bool enableValidationLayers);
 
 		const class Device& Device() const { return *device_; }
 		class CommandPool& CommandPool() { return *commandPool_; }
+		class CommandQueue& GraphicsQueue() { return *graphicsQueue_; }
+		class CommandQueue& ComputeQueue() { return *computeQueue_; }
+		class CommandQueue& TransferQueue() { return *transferQueue_; }
 		const class DepthBuffer& DepthBuffer() const { return *depthBuffer_; }
 		const std::vector<Assets::UniformBuffer>& UniformBuffers() const { return uniformBuffers_; }
+		const class PipelineCache& PipelineCache() const { return *pipelineCache_; }
+		const class RenderPass& RenderPass() const { return *renderPass_; }
 		const class GraphicsPipeline& GraphicsPipeline() const { return *graphicsPipeline_; }
+		class GraphicsPipeline& GraphicsPipeline() { return *graphicsPipeline_; }
 		const class FrameBuffer& SwapChainFrameBuffer(const size_t i) const { return swapChainFramebuffers_[i]; }
+		uint32_t FramesInFlight() const { return framesInFlight_; }
+
+		// Keep a resource alive until the last submission of the graphics queue (see CommandQueue) has completed, and so the
+		// frames submitted before it (e.g. the previous scene and its pipelines, once the next one is handed over to the graphics queue).
+		void Retire(std::shared_ptr<void> resource);
+		void ReleaseRetired();
+
+		// Takes effect on the next swap chain recreation.
+		void SetPresentMode(const VkPresentModeKHR presentMode) { presentMode_ = presentMode; }
+
+		// Takes effect when the device is set (see SetPhysicalDevice()).
+		void SetPipelineCacheFilename(std::string filename) { pipelineCacheFilename_ = std::move(filename); }
+		void RecreateSwapChain();
+
+		// CPU command recording and GPU execution times of the last completed frame, in seconds.
+		float CpuFrameTime() const { return cpuFrameTime_; }
+		float GpuFrameTime() const { return gpuFrameTime_; }
+
+		// Number of swap chain recreations (e.g. on resize) so far, and the duration of the last one in seconds.
+		uint32_t SwapChainRecreations() const { return swapChainRecreations_; }
+		float SwapChainRecreationTime() const { return swapChainRecreationTime_; }
 		
 		virtual const Assets::Scene& GetScene() const = 0;
 		virtual Assets::UniformBufferObject GetUniformBufferObject(VkExtent2D extent) const = 0;
@@ -58,8 +87,17 @@ namespace Vulkan
 		virtual void OnDeviceSet();
 		virtual void CreateSwapChain();
 		virtual void DeleteSwapChain();
+		virtual void DeletePipelines();
+
+		// Recreate the scene dependent pipelines (e.g. once the scene has been switched) without waiting for the device,
+		// the previous ones are retired. Nothing to do until the pipelines are first created along with the swap chain.
+		virtual void RecreatePipelines();
+
 		virtual void DrawFrame();
-		virtual void Render(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+		virtual void Render(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex);
+
+		// When idle (e.g. nothing left to render), the next frame is only drawn once an event (input, resize, etc.) comes in.
+		virtual bool IsIdle() const { return false; }
 
 		virtual void OnKey(int key, int scancode, int action, int mods) { }
 		virtual void OnCursorPosition(double xpos, double ypos) { }
@@ -70,10 +108,19 @@ namespace Vulkan
 
 	private:
 
-		void UpdateUniformBuffer(uint32_t imageIndex);
-		void RecreateSwapChain();
+		struct Retirement final
+		{
+			uint64_t Value;
+			std::shared_ptr<void> Resource;
+		};
+
+		void CreateGraphicsPipeline();
+		void UpdateUniformBuffer(uint32_t frameIndex);
+		void ReadFrameTimestamps(uint32_t frameIndex);
 
-		const VkPresentModeKHR presentMode_;
+		VkPresentModeKHR presentMode_;
+		const uint32_t framesInFlight_;
+		std::string pipelineCacheFilename_{ "PipelineCache.bin" };
 		
 		std::unique_ptr<class Window> window_;
 		std::unique_ptr<class Instance> instance_;
@@ -83,15 +130,28 @@ namespace Vulkan
 		std::unique_ptr<class SwapChain> swapChain_;
 		std::vector<Assets::UniformBuffer> uniformBuffers_;
 		std::unique_ptr<class DepthBuffer> depthBuffer_;
+		std::unique_ptr<class RenderPass> renderPass_;
+		std::unique_ptr<class PipelineCache> pipelineCache_;
 		std::unique_ptr<class GraphicsPipeline> graphicsPipeline_;
 		std::vector<class FrameBuffer> swapChainFramebuffers_;
 		std::unique_ptr<class CommandPool> commandPool_;
+		std::unique_ptr<class CommandQueue> graphicsQueue_;
+		std::unique_ptr<class CommandQueue> computeQueue_;
+		std::unique_ptr<class CommandQueue> transferQueue_;
 		std::unique_ptr<class CommandBuffers> commandBuffers_;
+		std::unique_ptr<class QueryPool> timestampQueryPool_;
 		std::vector<class Semaphore> imageAvailableSemaphores_;
 		std::vector<class Semaphore> renderFinishedSemaphores_;
 		std::vector<class Fence> inFlightFences_;
-
-		size_t currentFrame_{};
+		std::vector<bool> timestampsWritten_;
+		std::deque<Retirement> retired_;
+
+		uint32_t currentFrame_{};
+		bool savePipelineCache_{};
+		float cpuFrameTime_{};
+		float gpuFrameTime_{};
+		uint32_t swapChainRecreations_{};
+		float swapChainRecreationTime_{};
 	};
 
 }
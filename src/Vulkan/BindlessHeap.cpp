@@ -0,0 +1,213 @@
+#include "BindlessHeap.hpp"
+#include "DescriptorBinding.hpp"
+#include "DescriptorPool.hpp"
+#include "DescriptorSetLayout.hpp"
+#include "DescriptorSets.hpp"
+#include "Device.hpp"
+#include "Utilities/Exception.hpp"
+#include <algorithm>
+#include <map>
+#include <string>
+
+namespace Vulkan {
+
+namespace
+{
+	// Upper bounds of the arrays, further limited by the device.
+	const uint32_t MaxTextures = 4096;
+	const uint32_t MaxBuffers = 1024;
+}
+
+BindlessHeap::BindlessHeap(const class Device& device, const uint32_t framesInFlight) :
+	device_(device),
+	framesInFlight_(framesInFlight)
+{
+	VkPhysicalDeviceDescriptorIndexingProperties indexingProperties = {};
+	indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 properties = {};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &indexingProperties;
+	vkGetPhysicalDeviceProperties2(device.PhysicalDevice(), &properties);
+
+	const auto textureCapacity = std::min({ MaxTextures,
+		indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+		indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+		indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+		indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers });
+
+	const auto bufferCapacity = std::min({ MaxBuffers,
+		indexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+		indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+
+	const auto stages = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR;
+	const std::vector<DescriptorBinding> descriptorBindings =
+	{
+		{TextureBinding, textureCapacity, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stages},
+		{BufferBinding, bufferCapacity, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages}
+	};
+
+	const std::map<uint32_t, VkDescriptorType> bindingTypes =
+	{
+		{TextureBinding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER},
+		{BufferBinding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER}
+	};
+
+	// Unused slots are never read, and can be written while command buffers using the set are pending.
+	const VkDescriptorBindingFlags bindingFlags =
+		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+		VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+	descriptorPool_.reset(new DescriptorPool(device, descriptorBindings, 1, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT));
+	descriptorSetLayout_.reset(new class DescriptorSetLayout(device, descriptorBindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, bindingFlags));
+	descriptorSets_.reset(new DescriptorSets(*descriptorPool_, *descriptorSetLayout_, bindingTypes, 1));
+
+	textureSlots_.Used.resize(textureCapacity);
+	bufferSlots_.Used.resize(bufferCapacity);
+
+	const auto& debugUtils = device.DebugUtils();
+
+	debugUtils.SetObjectName(descriptorSetLayout_->Handle(), "Bindless Heap Layout");
+	debugUtils.SetObjectName(descriptorSets_->Handle(0), "Bindless Heap");
+}
+
+BindlessHeap::~BindlessHeap()
+{
+	descriptorSets_.reset();
+	descriptorSetLayout_.reset();
+	descriptorPool_.reset();
+}
+
+VkDescriptorSet BindlessHeap::DescriptorSet() const
+{
+	return descriptorSets_->Handle(0);
+}
+
+uint32_t BindlessHeap::AddTextures(const std::vector<VkImageView>& imageViews, const std::vector<VkSampler>& samplers)
+{
+	if (imageViews.size() != samplers.size())
+	{
+		Throw(std::invalid_argument("the number of texture image views and samplers differ"));
+	}
+
+	const auto count = static_cast<uint32_t>(imageViews.size());
+	const auto firstSlot = Allocate(textureSlots_, count, "texture");
+
+	if (count == 0)
+	{
+		return firstSlot;
+	}
+
+	std::vector<VkDescriptorImageInfo> imageInfos(count);
+
+	for (size_t i = 0; i != imageInfos.size(); ++i)
+	{
+		auto& imageInfo = imageInfos[i];
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = imageViews[i];
+		imageInfo.sampler = samplers[i];
+	}
+
+	descriptorSets_->UpdateDescriptors(0, { descriptorSets_->Bind(0, TextureBinding, *imageInfos.data(), count, firstSlot) });
+
+	return firstSlot;
+}
+
+void BindlessHeap::RemoveTextures(const uint32_t firstSlot, const uint32_t count)
+{
+	Retire(textureSlots_, firstSlot, count);
+}
+
+void BindlessHeap::UpdateTexture(const uint32_t slot, const VkImageView imageView, const VkSampler sampler)
+{
+	if (slot >= textureSlots_.Used.size() || !textureSlots_.Used[slot])
+	{
+		Throw(std::out_of_range("bindless heap texture slot is not allocated"));
+	}
+
+	VkDescriptorImageInfo imageInfo = {};
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageInfo.imageView = imageView;
+	imageInfo.sampler = sampler;
+
+	descriptorSets_->UpdateDescriptors(0, { descriptorSets_->Bind(0, TextureBinding, imageInfo, 1, slot) });
+}
+
+uint32_t BindlessHeap::AddBuffer(const VkBuffer buffer)
+{
+	const auto slot = Allocate(bufferSlots_, 1, "buffer");
+
+	VkDescriptorBufferInfo bufferInfo = {};
+	bufferInfo.buffer = buffer;
+	bufferInfo.range = VK_WHOLE_SIZE;
+
+	descriptorSets_->UpdateDescriptors(0, { descriptorSets_->Bind(0, BufferBinding, bufferInfo, 1, slot) });
+
+	return slot;
+}
+
+void BindlessHeap::RemoveBuffer(const uint32_t slot)
+{
+	Retire(bufferSlots_, slot, 1);
+}
+
+void BindlessHeap::NextFrame()
+{
+	++frame_;
+
+	Recycle(textureSlots_);
+	Recycle(bufferSlots_);
+}
+
+uint32_t BindlessHeap::Allocate(SlotArray& slots, const uint32_t count, const char* const kind) const
+{
+	// First fit.
+	uint32_t firstSlot = 0;
+	uint32_t length = 0;
+
+	for (uint32_t slot = 0; slot != slots.Used.size() && length != count; ++slot)
+	{
+		if (slots.Used[slot])
+		{
+			firstSlot = slot + 1;
+			length = 0;
+		}
+		else
+		{
+			++length;
+		}
+	}
+
+	if (length != count)
+	{
+		Throw(std::runtime_error("bindless heap cannot fit " + std::to_string(count) + " more " + kind + " slot(s) (capacity "
+			+ std::to_string(slots.Used.size()) + ")"));
+	}
+
+	std::fill(slots.Used.begin() + firstSlot, slots.Used.begin() + firstSlot + count, true);
+
+	return firstSlot;
+}
+
+void BindlessHeap::Retire(SlotArray& slots, const uint32_t firstSlot, const uint32_t count) const
+{
+	if (firstSlot + count > slots.Used.size())
+	{
+		Throw(std::out_of_range("bindless heap slot out of range"));
+	}
+
+	slots.Retired.push_back({ frame_ + framesInFlight_, firstSlot, count });
+}
+
+void BindlessHeap::Recycle(SlotArray& slots) const
+{
+	while (!slots.Retired.empty() && slots.Retired.front().Frame <= frame_)
+	{
+		const auto& retired = slots.Retired.front();
+		std::fill(slots.Used.begin() + retired.FirstSlot, slots.Used.begin() + retired.FirstSlot + retired.Count, false);
+		slots.Retired.pop_front();
+	}
+}
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace Vulkan
+{
+	class DescriptorPool;
+	class DescriptorSetLayout;
+	class DescriptorSets;
+	class Device;
+
+	// A single descriptor set holding arrays of textures and storage buffers, which the shaders index by slot
+	// (see Bindless.glsl). The arrays are partially bound and updated after bind (descriptor indexing), so that
+	// resources can be added and removed at runtime without recreating the pipelines or their descriptor sets.
+	// A removed slot is only reused once the frames in flight that may still read it have completed (see NextFrame()).
+	class BindlessHeap final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(BindlessHeap)
+
+		static const uint32_t TextureBinding = 0;
+		static const uint32_t BufferBinding = 1;
+
+		BindlessHeap(const Device& device, uint32_t framesInFlight);
+		~BindlessHeap();
+
+		const class Device& Device() const { return device_; }
+		const class DescriptorSetLayout& DescriptorSetLayout() const { return *descriptorSetLayout_; }
+		VkDescriptorSet DescriptorSet() const;
+
+		uint32_t TextureCapacity() const { return static_cast<uint32_t>(textureSlots_.Used.size()); }
+		uint32_t BufferCapacity() const { return static_cast<uint32_t>(bufferSlots_.Used.size()); }
+
+		// The textures take contiguous slots (so that they can be indexed from a base slot), the first one is returned.
+		uint32_t AddTextures(const std::vector<VkImageView>& imageViews, const std::vector<VkSampler>& samplers);
+		void RemoveTextures(uint32_t firstSlot, uint32_t count);
+
+		// Point a slot to another texture. The slot must not be read by the frames in flight (e.g. it is only read by
+		// a frame slot whose previous use has completed).
+		void UpdateTexture(uint32_t slot, VkImageView imageView, VkSampler sampler);
+
+		uint32_t AddBuffer(VkBuffer buffer);
+		void RemoveBuffer(uint32_t slot);
+
+		// Once per frame, recycle the slots removed frames in flight ago.
+		void NextFrame();
+
+	private:
+
+		struct Retirement final
+		{
+			uint64_t Frame;
+			uint32_t FirstSlot;
+			uint32_t Count;
+		};
+
+		struct SlotArray final
+		{
+			std::vector<bool> Used;
+			std::deque<Retirement> Retired;
+		};
+
+		uint32_t Allocate(SlotArray& slots, uint32_t count, const char* kind) const;
+		void Retire(SlotArray& slots, uint32_t firstSlot, uint32_t count) const;
+		void Recycle(SlotArray& slots) const;
+
+		const class Device& device_;
+		const uint32_t framesInFlight_;
+
+		std::unique_ptr<DescriptorPool> descriptorPool_;
+		std::unique_ptr<class DescriptorSetLayout> descriptorSetLayout_;
+		std::unique_ptr<DescriptorSets> descriptorSets_;
+
+		SlotArray textureSlots_;
+		SlotArray bufferSlots_;
+		uint64_t frame_{};
+	};
+
+}
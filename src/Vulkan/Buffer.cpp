@@ -62,13 +62,18 @@ void Buffer::CopyFrom(CommandPool& commandPool, const Buffer& src, VkDeviceSize
 {
 	SingleTimeCommands::Submit(commandPool, [&](VkCommandBuffer commandBuffer)
 	{
-		VkBufferCopy copyRegion = {};
-		copyRegion.srcOffset = 0; // Optional
-		copyRegion.dstOffset = 0; // Optional
-		copyRegion.size = size;
-
-		vkCmdCopyBuffer(commandBuffer, src.Handle(), Handle(), 1, &copyRegion);
+		CopyFrom(commandBuffer, src, size);
 	});
 }
 
+void Buffer::CopyFrom(VkCommandBuffer commandBuffer, const Buffer& src, VkDeviceSize size)
+{
+	VkBufferCopy copyRegion = {};
+	copyRegion.srcOffset = 0; // Optional
+	copyRegion.dstOffset = 0; // Optional
+	copyRegion.size = size;
+
+	vkCmdCopyBuffer(commandBuffer, src.Handle(), Handle(), 1, &copyRegion);
+}
+
 }
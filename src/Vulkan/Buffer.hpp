@@ -26,6 +26,7 @@ namespace Vulkan
 		VkDeviceAddress GetDeviceAddress() const;
 
 		void CopyFrom(CommandPool& commandPool, const Buffer& src, VkDeviceSize size);
+		void CopyFrom(VkCommandBuffer commandBuffer, const Buffer& src, VkDeviceSize size);
 
 	private:
 
@@ -2,8 +2,10 @@
 
 #include "Buffer.hpp"
 #include "CommandPool.hpp"
+#include "CommandQueue.hpp"
 #include "Device.hpp"
 #include "DeviceMemory.hpp"
+#include "QueueOwnership.hpp"
 #include <cstring>
 #include <memory>
 #include <string>
@@ -27,6 +29,39 @@ namespace Vulkan
 			const std::vector<T>& content,
 			std::unique_ptr<Buffer>& buffer,
 			std::unique_ptr<DeviceMemory>& memory);
+
+		// Record the upload into a command buffer of the given queue, which keeps the staging buffer alive until it completes.
+		template <class T>
+		static void CreateDeviceBuffer(
+			CommandQueue& queue,
+			VkCommandBuffer commandBuffer,
+			const char* name,
+			VkBufferUsageFlags usage,
+			const std::vector<T>& content,
+			std::unique_ptr<Buffer>& buffer,
+			std::unique_ptr<DeviceMemory>& memory);
+
+		// Upload on the given queue without waiting for it, then release the buffer to the queue family using it.
+		// Returns the value of the queue timeline once uploaded.
+		template <class T>
+		static uint64_t CreateDeviceBuffer(
+			CommandQueue& queue,
+			uint32_t dstQueueFamilyIndex,
+			const char* name,
+			VkBufferUsageFlags usage,
+			const std::vector<T>& content,
+			std::unique_ptr<Buffer>& buffer,
+			std::unique_ptr<DeviceMemory>& memory);
+
+	private:
+
+		static void AllocateDeviceBuffer(
+			const Device& device,
+			const char* name,
+			VkBufferUsageFlags usage,
+			size_t size,
+			std::unique_ptr<Buffer>& buffer,
+			std::unique_ptr<DeviceMemory>& memory);
 	};
 
 	template <class T>
@@ -60,19 +95,76 @@ namespace Vulkan
 		std::unique_ptr<Buffer>& buffer,
 		std::unique_ptr<DeviceMemory>& memory)
 	{
-		const auto& device = commandPool.Device();
-		const auto& debugUtils = device.DebugUtils();
+		AllocateDeviceBuffer(commandPool.Device(), name, usage, sizeof(content[0]) * content.size(), buffer, memory);
+		CopyFromStagingBuffer(commandPool, *buffer, content);
+	}
+
+	template <class T>
+	void BufferUtil::CreateDeviceBuffer(
+		CommandQueue& queue,
+		const VkCommandBuffer commandBuffer,
+		const char* const name,
+		const VkBufferUsageFlags usage,
+		const std::vector<T>& content,
+		std::unique_ptr<Buffer>& buffer,
+		std::unique_ptr<DeviceMemory>& memory)
+	{
+		const auto& device = queue.Device();
 		const auto contentSize = sizeof(content[0]) * content.size();
+
+		AllocateDeviceBuffer(device, name, usage, contentSize, buffer, memory);
+
+		// Create a temporary host-visible staging buffer.
+		auto stagingBuffer = std::make_unique<Buffer>(device, contentSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+		auto stagingBufferMemory = std::make_unique<DeviceMemory>(stagingBuffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+
+		// Copy the host data into the staging buffer.
+		const auto data = stagingBufferMemory->Map(0, contentSize);
+		std::memcpy(data, content.data(), contentSize);
+		stagingBufferMemory->Unmap();
+
+		// Copy the staging buffer to the device buffer.
+		buffer->CopyFrom(commandBuffer, *stagingBuffer, contentSize);
+
+		queue.Retain(std::move(stagingBuffer), std::move(stagingBufferMemory));
+	}
+
+	template <class T>
+	uint64_t BufferUtil::CreateDeviceBuffer(
+		CommandQueue& queue,
+		const uint32_t dstQueueFamilyIndex,
+		const char* const name,
+		const VkBufferUsageFlags usage,
+		const std::vector<T>& content,
+		std::unique_ptr<Buffer>& buffer,
+		std::unique_ptr<DeviceMemory>& memory)
+	{
+		return queue.Submit({}, [&](VkCommandBuffer commandBuffer)
+		{
+			CreateDeviceBuffer(queue, commandBuffer, name, usage, content, buffer, memory);
+
+			QueueOwnership::ReleaseBuffer(commandBuffer, buffer->Handle(), queue.FamilyIndex(), dstQueueFamilyIndex,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+		});
+	}
+
+	inline void BufferUtil::AllocateDeviceBuffer(
+		const Device& device,
+		const char* const name,
+		const VkBufferUsageFlags usage,
+		const size_t size,
+		std::unique_ptr<Buffer>& buffer,
+		std::unique_ptr<DeviceMemory>& memory)
+	{
+		const auto& debugUtils = device.DebugUtils();
 		const VkMemoryAllocateFlags allocateFlags = usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
 			? VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT
 			: 0;
 
-		buffer.reset(new Buffer(device, contentSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage));
+		buffer.reset(new Buffer(device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage));
 		memory.reset(new DeviceMemory(buffer->AllocateMemory(allocateFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 
 		debugUtils.SetObjectName(buffer->Handle(), (name + std::string(" Buffer")).c_str());
 		debugUtils.SetObjectName(memory->Handle(), (name + std::string(" Memory")).c_str());
-
-		CopyFromStagingBuffer(commandPool, *buffer, content);
 	}
 }
@@ -0,0 +1,105 @@
+#include "CalibratedTimestamps.hpp"
+#include "Device.hpp"
+#include "Instance.hpp"
+#include "Surface.hpp"
+#include <algorithm>
+#include <vector>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+namespace Vulkan {
+
+namespace
+{
+#ifdef WIN32
+	const VkTimeDomainEXT HostTimeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+
+	double HostPeriod()
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		return 1.0 / frequency.QuadPart;
+	}
+#else
+	const VkTimeDomainEXT HostTimeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_RAW_EXT;
+
+	double HostPeriod()
+	{
+		return 1e-9;
+	}
+#endif
+}
+
+CalibratedTimestamps::CalibratedTimestamps(const class Device& device) :
+	device_(device)
+{
+	if (!device.IsEnabled(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME))
+	{
+		return;
+	}
+
+	const auto instance = device.Surface().Instance().Handle();
+	const auto vkGetPhysicalDeviceCalibrateableTimeDomainsEXT = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(
+		vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
+
+	if (vkGetPhysicalDeviceCalibrateableTimeDomainsEXT == nullptr)
+	{
+		return;
+	}
+
+	uint32_t count = 0;
+	Check(vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(device.PhysicalDevice(), &count, nullptr),
+		"get calibrateable time domains");
+
+	std::vector<VkTimeDomainEXT> domains(count);
+	Check(vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(device.PhysicalDevice(), &count, domains.data()),
+		"get calibrateable time domains");
+
+	const auto hasDomain = [&domains](const VkTimeDomainEXT domain) { return std::find(domains.begin(), domains.end(), domain) != domains.end(); };
+
+	if (!hasDomain(VK_TIME_DOMAIN_DEVICE_EXT) || !hasDomain(HostTimeDomain))
+	{
+		return;
+	}
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties);
+
+	hostDomain_ = HostTimeDomain;
+	hostPeriod_ = HostPeriod();
+	devicePeriod_ = properties.limits.timestampPeriod * 1e-9;
+	vkGetCalibratedTimestampsEXT_ = reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(vkGetDeviceProcAddr(device.Handle(), "vkGetCalibratedTimestampsEXT"));
+}
+
+void CalibratedTimestamps::Calibrate()
+{
+	VkCalibratedTimestampInfoEXT infos[2] = {};
+	infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+	infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+	infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+	infos[1].timeDomain = hostDomain_;
+
+	uint64_t timestamps[2] = {};
+	uint64_t maxDeviation = 0;
+
+	Check(vkGetCalibratedTimestampsEXT_(device_.Handle(), 2, infos, timestamps, &maxDeviation),
+		"get calibrated timestamps");
+
+	deviceTimestamp_ = timestamps[0];
+	hostTimestamp_ = timestamps[1];
+}
+
+double CalibratedTimestamps::ToHostTime(const uint64_t timestamp, const uint32_t validBits) const
+{
+	// The timestamp may be either side of the calibration, and wraps around past its valid bits.
+	const auto mask = validBits >= 64 ? ~uint64_t(0) : (uint64_t(1) << validBits) - 1;
+	const auto forward = (timestamp - deviceTimestamp_) & mask;
+	const auto backward = (deviceTimestamp_ - timestamp) & mask;
+	const auto delta = forward <= backward ? static_cast<double>(forward) : -static_cast<double>(backward);
+
+	return hostTimestamp_ * hostPeriod_ + delta * devicePeriod_;
+}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+namespace Vulkan
+{
+	class Device;
+
+	// Converts the timestamps written by vkCmdWriteTimestamp to the host monotonic clock (VK_EXT_calibrated_timestamps).
+	// Timestamps of different queues are not guaranteed to share a time base, only calibrated ones can be compared.
+	// Not supported when the device has not enabled the extension, or cannot calibrate against the host clock.
+	class CalibratedTimestamps final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(CalibratedTimestamps)
+
+		explicit CalibratedTimestamps(const Device& device);
+		~CalibratedTimestamps() = default;
+
+		bool IsSupported() const { return vkGetCalibratedTimestampsEXT_ != nullptr; }
+
+		// Sample the device and host clocks together, the reference of the following conversions.
+		void Calibrate();
+
+		// Host time in seconds of a device timestamp, written on a queue family with the given number of valid bits.
+		double ToHostTime(uint64_t timestamp, uint32_t validBits) const;
+
+	private:
+
+		const class Device& device_;
+
+		PFN_vkGetCalibratedTimestampsEXT vkGetCalibratedTimestampsEXT_{};
+		VkTimeDomainEXT hostDomain_{};
+		double hostPeriod_{}; // In seconds.
+		double devicePeriod_{}; // In seconds.
+
+		uint64_t deviceTimestamp_{};
+		uint64_t hostTimestamp_{};
+	};
+
+}
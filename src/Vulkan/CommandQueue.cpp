@@ -0,0 +1,193 @@
+#include "CommandQueue.hpp"
+#include "Buffer.hpp"
+#include "CalibratedTimestamps.hpp"
+#include "CommandBuffers.hpp"
+#include "CommandPool.hpp"
+#include "Device.hpp"
+#include "DeviceMemory.hpp"
+#include "Enumerate.hpp"
+#include "QueryPool.hpp"
+#include "TimelineSemaphore.hpp"
+#include <algorithm>
+#include <string>
+
+namespace Vulkan {
+
+namespace
+{
+	// Each submission in flight owns a pair of timestamp queries, the oldest one is waited for beyond that.
+	const uint32_t MaxPendingSubmissions = 64;
+}
+
+CommandQueue::CommandQueue(const class Device& device, const uint32_t familyIndex, const VkQueue queue, const char* const name) :
+	device_(device),
+	familyIndex_(familyIndex),
+	queue_(queue)
+{
+	commandPool_.reset(new class CommandPool(device, familyIndex, false));
+	timeline_.reset(new TimelineSemaphore(device, 0));
+
+	const auto queueFamilies = GetEnumerateVector(device.PhysicalDevice(), vkGetPhysicalDeviceQueueFamilyProperties);
+
+	timestampValidBits_ = queueFamilies[familyIndex].timestampValidBits;
+
+	if (timestampValidBits_ != 0)
+	{
+		queryPool_.reset(new QueryPool(device, VK_QUERY_TYPE_TIMESTAMP, 2 * MaxPendingSubmissions));
+		calibratedTimestamps_.reset(new CalibratedTimestamps(device));
+	}
+
+	const auto& debugUtils = device.DebugUtils();
+
+	debugUtils.SetObjectName(queue_, (name + std::string(" Queue")).c_str());
+	debugUtils.SetObjectName(timeline_->Handle(), (name + std::string(" Timeline")).c_str());
+}
+
+CommandQueue::~CommandQueue()
+{
+	timeline_->Wait(lastSubmitted_);
+
+	staging_.clear();
+	pending_.clear();
+	calibratedTimestamps_.reset();
+	queryPool_.reset();
+	timeline_.reset();
+	commandPool_.reset();
+}
+
+uint64_t CommandQueue::Submit(const std::vector<Wait>& waits, const std::function<void(VkCommandBuffer)>& action)
+{
+	const auto value = lastSubmitted_ + 1;
+	const auto firstQuery = 2 * static_cast<uint32_t>(value % MaxPendingSubmissions);
+
+	// The previous user of these queries must have completed and been read back.
+	WaitFor(value > MaxPendingSubmissions ? value - MaxPendingSubmissions : 0);
+
+	std::unique_ptr<class CommandBuffers> commandBuffers(new class CommandBuffers(*commandPool_, 1));
+	const auto commandBuffer = (*commandBuffers)[0];
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	Check(vkBeginCommandBuffer(commandBuffer, &beginInfo),
+		"begin recording command buffer");
+
+	// Host reset, as transfer queues cannot reset queries themselves.
+	if (queryPool_)
+	{
+		vkResetQueryPool(device_.Handle(), queryPool_->Handle(), firstQuery, 2);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool_->Handle(), firstQuery);
+	}
+
+	action(commandBuffer);
+
+	if (queryPool_)
+	{
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool_->Handle(), firstQuery + 1);
+	}
+
+	Check(vkEndCommandBuffer(commandBuffer),
+		"record command buffer");
+
+	std::vector<VkSemaphore> waitSemaphores;
+	std::vector<uint64_t> waitValues;
+	std::vector<VkPipelineStageFlags> waitStages;
+
+	for (const auto& wait : waits)
+	{
+		waitSemaphores.push_back(wait.Queue.Timeline().Handle());
+		waitValues.push_back(wait.Value);
+		waitStages.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+	}
+
+	const auto signalSemaphore = timeline_->Handle();
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+	timelineInfo.pWaitSemaphoreValues = waitValues.data();
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &value;
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+	submitInfo.pWaitSemaphores = waitSemaphores.data();
+	submitInfo.pWaitDstStageMask = waitStages.data();
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &signalSemaphore;
+
+	Check(vkQueueSubmit(queue_, 1, &submitInfo, nullptr),
+		"submit command buffer");
+
+	lastSubmitted_ = value;
+	pending_.push_back({ value, firstQuery, std::move(commandBuffers) });
+
+	return value;
+}
+
+void CommandQueue::Retain(std::unique_ptr<Buffer> buffer, std::unique_ptr<DeviceMemory> memory)
+{
+	staging_.push_back({ lastSubmitted_ + 1, std::move(memory), std::move(buffer) });
+}
+
+void CommandQueue::WaitFor(const uint64_t value)
+{
+	timeline_->Wait(value);
+	Collect();
+}
+
+bool CommandQueue::GetBusyTime(double& start, double& end) const
+{
+	start = busyStart_;
+	end = busyEnd_;
+
+	return hasBusyTime_;
+}
+
+bool CommandQueue::HasCalibratedTimestamps() const
+{
+	return calibratedTimestamps_ && calibratedTimestamps_->IsSupported();
+}
+
+void CommandQueue::Collect()
+{
+	const auto completed = timeline_->Value();
+	const bool calibrate = HasCalibratedTimestamps();
+	bool calibrated = false;
+
+	while (!pending_.empty() && pending_.front().Value <= completed)
+	{
+		std::vector<uint64_t> timestamps;
+
+		if (queryPool_ && queryPool_->GetResults(pending_.front().FirstQuery, 2, timestamps))
+		{
+			// Calibrate once per collection, close to the timestamps so that the clocks have not drifted apart.
+			if (calibrate && !calibrated)
+			{
+				calibratedTimestamps_->Calibrate();
+				calibrated = true;
+			}
+
+			const auto start = calibrate ? calibratedTimestamps_->ToHostTime(timestamps[0], timestampValidBits_) : timestamps[0] * queryPool_->TimestampPeriod();
+			const auto end = calibrate ? calibratedTimestamps_->ToHostTime(timestamps[1], timestampValidBits_) : timestamps[1] * queryPool_->TimestampPeriod();
+
+			busyStart_ = hasBusyTime_ ? std::min(busyStart_, start) : start;
+			busyEnd_ = hasBusyTime_ ? std::max(busyEnd_, end) : end;
+			hasBusyTime_ = true;
+		}
+
+		pending_.pop_front();
+	}
+
+	while (!staging_.empty() && staging_.front().Value <= completed)
+	{
+		staging_.pop_front();
+	}
+}
+
+}
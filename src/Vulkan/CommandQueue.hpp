@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Vulkan
+{
+	class Buffer;
+	class CalibratedTimestamps;
+	class CommandBuffers;
+	class CommandPool;
+	class Device;
+	class DeviceMemory;
+	class QueryPool;
+	class TimelineSemaphore;
+
+	// A device queue submitting one-time command buffers without waiting for them on the host. Each submission signals
+	// the next value of the queue timeline semaphore, and can first wait for values of the other queues timelines, so that
+	// the work of several queues is ordered on the GPU alone. The command buffers, and the staging buffers they read,
+	// are kept alive until their submission completes.
+	// When the queue family supports timestamps, the GPU time span of the submissions is measured. The spans of different
+	// queues can only be compared (e.g. to report their overlap) when they are calibrated to the host clock.
+	class CommandQueue final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(CommandQueue)
+
+		struct Wait final
+		{
+			const CommandQueue& Queue;
+			uint64_t Value;
+		};
+
+		CommandQueue(const Device& device, uint32_t familyIndex, VkQueue queue, const char* name);
+		~CommandQueue(); // Waits for the pending submissions.
+
+		const class Device& Device() const { return device_; }
+		uint32_t FamilyIndex() const { return familyIndex_; }
+		VkQueue Handle() const { return queue_; }
+		const class TimelineSemaphore& Timeline() const { return *timeline_; }
+		uint64_t LastSubmitted() const { return lastSubmitted_; }
+
+		// Record and submit a command buffer, which starts once the given timeline values are reached.
+		// Returns the value signalled on this queue timeline when it completes.
+		uint64_t Submit(const std::vector<Wait>& waits, const std::function<void(VkCommandBuffer)>& action);
+
+		// Keep a staging buffer alive until the submission being recorded (or else the next one) completes.
+		void Retain(std::unique_ptr<Buffer> buffer, std::unique_ptr<DeviceMemory> memory);
+
+		// Block until the timeline reaches the given value, then free the resources of the completed submissions.
+		void WaitFor(uint64_t value);
+		void WaitIdle() { WaitFor(lastSubmitted_); }
+
+		// GPU time span of the submissions completed since the last reset, in seconds. On the host clock when the timestamps
+		// are calibrated (see CalibratedTimestamps), otherwise on the queue own clock where only the duration is meaningful.
+		// False when the queue family does not support timestamps or nothing completed yet.
+		void ResetBusyTime() { hasBusyTime_ = false; }
+		bool GetBusyTime(double& start, double& end) const;
+		bool HasCalibratedTimestamps() const;
+
+	private:
+
+		struct Submission final
+		{
+			uint64_t Value;
+			uint32_t FirstQuery;
+			std::unique_ptr<class CommandBuffers> CommandBuffers;
+		};
+
+		struct Staging final
+		{
+			uint64_t Value;
+			std::unique_ptr<DeviceMemory> Memory;
+			std::unique_ptr<class Buffer> Buffer; // Destroyed before its memory.
+		};
+
+		void Collect();
+
+		const class Device& device_;
+		const uint32_t familyIndex_;
+		const VkQueue queue_;
+
+		std::unique_ptr<class CommandPool> commandPool_;
+		std::unique_ptr<class TimelineSemaphore> timeline_;
+		std::unique_ptr<class QueryPool> queryPool_;
+		std::unique_ptr<CalibratedTimestamps> calibratedTimestamps_;
+		uint32_t timestampValidBits_{};
+
+		std::deque<Submission> pending_;
+		std::deque<Staging> staging_;
+		uint64_t lastSubmitted_{};
+
+		bool hasBusyTime_{};
+		double busyStart_{};
+		double busyEnd_{};
+	};
+
+}
@@ -4,6 +4,15 @@
 namespace Vulkan {
 
 DescriptorSetLayout::DescriptorSetLayout(const Device& device, const std::vector<DescriptorBinding>& descriptorBindings) :
+	DescriptorSetLayout(device, descriptorBindings, 0, 0)
+{
+}
+
+DescriptorSetLayout::DescriptorSetLayout(
+	const Device& device,
+	const std::vector<DescriptorBinding>& descriptorBindings,
+	const VkDescriptorSetLayoutCreateFlags flags,
+	const VkDescriptorBindingFlags bindingFlags) :
 	device_(device)
 {
 	std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
@@ -19,8 +28,17 @@ DescriptorSetLayout::DescriptorSetLayout(const Device& device, const std::vector
 		layoutBindings.push_back(b);
 	}
 
+	const std::vector<VkDescriptorBindingFlags> layoutBindingFlags(layoutBindings.size(), bindingFlags);
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+	bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	bindingFlagsInfo.bindingCount = static_cast<uint32_t>(layoutBindingFlags.size());
+	bindingFlagsInfo.pBindingFlags = layoutBindingFlags.data();
+
 	VkDescriptorSetLayoutCreateInfo layoutInfo = {};
 	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.pNext = bindingFlags != 0 ? &bindingFlagsInfo : nullptr;
+	layoutInfo.flags = flags;
 	layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
 	layoutInfo.pBindings = layoutBindings.data();
 
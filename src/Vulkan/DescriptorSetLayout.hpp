@@ -14,6 +14,14 @@ namespace Vulkan
 		VULKAN_NON_COPIABLE(DescriptorSetLayout)
 
 		DescriptorSetLayout(const Device& device, const std::vector<DescriptorBinding>& descriptorBindings);
+
+		// The binding flags (e.g. partially bound, update after bind) apply to all the bindings.
+		DescriptorSetLayout(
+			const Device& device,
+			const std::vector<DescriptorBinding>& descriptorBindings,
+			VkDescriptorSetLayoutCreateFlags flags,
+			VkDescriptorBindingFlags bindingFlags);
+
 		~DescriptorSetLayout();
 
 	private:
@@ -25,10 +25,11 @@ namespace Vulkan
 
 		~DescriptorSets();
 
+		uint32_t Size() const { return static_cast<uint32_t>(descriptorSets_.size()); }
 		VkDescriptorSet Handle(uint32_t index) const { return descriptorSets_[index]; }
 
-		VkWriteDescriptorSet Bind(uint32_t index, uint32_t binding, const VkDescriptorBufferInfo& bufferInfo, uint32_t count = 1) const;
-		VkWriteDescriptorSet Bind(uint32_t index, uint32_t binding, const VkDescriptorImageInfo& imageInfo, uint32_t count = 1) const;
+		VkWriteDescriptorSet Bind(uint32_t index, uint32_t binding, const VkDescriptorBufferInfo& bufferInfo, uint32_t count = 1, uint32_t arrayElement = 0) const;
+		VkWriteDescriptorSet Bind(uint32_t index, uint32_t binding, const VkDescriptorImageInfo& imageInfo, uint32_t count = 1, uint32_t arrayElement = 0) const;
 		VkWriteDescriptorSet Bind(uint32_t index, uint32_t binding, const VkWriteDescriptorSetAccelerationStructureKHR& structureInfo, uint32_t count = 1) const;
 
 		void UpdateDescriptors(uint32_t index, const std::vector<VkWriteDescriptorSet>& descriptorWrites);
@@ -41,7 +41,8 @@ Device::Device(
 	const void* nextDeviceFeatures) :
 	physicalDevice_(physicalDevice),
 	surface_(surface),
-	debugUtils_(surface.Instance().Handle())
+	debugUtils_(surface.Instance().Handle()),
+	extensions_(requiredExtensions.begin(), requiredExtensions.end())
 {
 	CheckRequiredExtensions(physicalDevice, requiredExtensions);
 
@@ -51,9 +52,15 @@ Device::Device(
 	const auto graphicsFamily = FindQueue(queueFamilies, "graphics", VK_QUEUE_GRAPHICS_BIT, 0);
 	const auto computeFamily = FindQueue(queueFamilies, "compute", VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT);
 
-	//Commented out the dedicated transfer queue, as it's never used (relic from Vulkan tutorial) 
-	//and causes problems with RADV (see https://github.com/NVIDIA/Q2RTX/issues/147).
-	//const auto transferFamily = FindQueue(queueFamilies, "transfer", VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+	// Uploads prefer a dedicated transfer queue (i.e. a DMA engine). Not all devices expose one (e.g. RADV, see
+	// https://github.com/NVIDIA/Q2RTX/issues/147), in which case they share the compute queue instead.
+	const auto transferFamily = std::find_if(queueFamilies.begin(), queueFamilies.end(), [](const VkQueueFamilyProperties& queueFamily)
+	{
+		return
+			queueFamily.queueCount > 0 &&
+			queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT &&
+			!(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+	});
 
 	// Find the presentation queue (usually the same as graphics queue).
 	const auto presentFamily = std::find_if(queueFamilies.begin(), queueFamilies.end(), [&](const VkQueueFamilyProperties& queueFamily)
@@ -72,7 +79,7 @@ Device::Device(
 	graphicsFamilyIndex_ = static_cast<uint32_t>(graphicsFamily - queueFamilies.begin());
 	computeFamilyIndex_ = static_cast<uint32_t>(computeFamily - queueFamilies.begin());
 	presentFamilyIndex_ = static_cast<uint32_t>(presentFamily - queueFamilies.begin());
-	//transferFamilyIndex_ = static_cast<uint32_t>(transferFamily - queueFamilies.begin());
+	transferFamilyIndex_ = transferFamily != queueFamilies.end() ? static_cast<uint32_t>(transferFamily - queueFamilies.begin()) : computeFamilyIndex_;
 
 	// Queues can be the same
 	const std::set<uint32_t> uniqueQueueFamilies =
@@ -80,7 +87,7 @@ Device::Device(
 		graphicsFamilyIndex_,
 		computeFamilyIndex_,
 		presentFamilyIndex_,
-		//transferFamilyIndex_
+		transferFamilyIndex_
 	};
 
 	// Create queues
@@ -118,7 +125,7 @@ Device::Device(
 	vkGetDeviceQueue(device_, graphicsFamilyIndex_, 0, &graphicsQueue_);
 	vkGetDeviceQueue(device_, computeFamilyIndex_, 0, &computeQueue_);
 	vkGetDeviceQueue(device_, presentFamilyIndex_, 0, &presentQueue_);
-	//vkGetDeviceQueue(device_, transferFamilyIndex_, 0, &transferQueue_);
+	vkGetDeviceQueue(device_, transferFamilyIndex_, 0, &transferQueue_);
 }
 
 Device::~Device()
@@ -2,6 +2,8 @@
 
 #include "DebugUtils.hpp"
 #include "Vulkan.hpp"
+#include <set>
+#include <string>
 #include <vector>
 
 namespace Vulkan
@@ -28,15 +30,18 @@ namespace Vulkan
 
 		const class DebugUtils& DebugUtils() const { return debugUtils_; }
 
+		// Whether the device has been created with the given extension (e.g. an optional one).
+		bool IsEnabled(const std::string& extension) const { return extensions_.count(extension) != 0; }
+
 		uint32_t GraphicsFamilyIndex() const { return graphicsFamilyIndex_; }
 		uint32_t ComputeFamilyIndex() const { return computeFamilyIndex_; }
 		uint32_t PresentFamilyIndex() const { return presentFamilyIndex_; }
-		//uint32_t TransferFamilyIndex() const { return transferFamilyIndex_; }
+		uint32_t TransferFamilyIndex() const { return transferFamilyIndex_; }
 		
 		VkQueue GraphicsQueue() const { return graphicsQueue_; }
 		VkQueue ComputeQueue() const { return computeQueue_; }
 		VkQueue PresentQueue() const { return presentQueue_; }
-		//VkQueue TransferQueue() const { return transferQueue_; }
+		VkQueue TransferQueue() const { return transferQueue_; }
 
 		void WaitIdle() const;
 
@@ -50,16 +55,17 @@ namespace Vulkan
 		VULKAN_HANDLE(VkDevice, device_)
 
 		class DebugUtils debugUtils_;
+		const std::set<std::string> extensions_;
 
 		uint32_t graphicsFamilyIndex_ {};
 		uint32_t computeFamilyIndex_{};
 		uint32_t presentFamilyIndex_{};
-		//uint32_t transferFamilyIndex_{};
+		uint32_t transferFamilyIndex_{};
 
 		VkQueue graphicsQueue_{};
 		VkQueue computeQueue_{};
 		VkQueue presentQueue_{};
-		//VkQueue transferQueue_{};
+		VkQueue transferQueue_{};
 	};
 
 }
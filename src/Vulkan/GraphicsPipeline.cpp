@@ -4,33 +4,95 @@
 #include "DescriptorPool.hpp"
 #include "DescriptorSets.hpp"
 #include "Device.hpp"
+#include "DepthBuffer.hpp"
+#include "PipelineCache.hpp"
 #include "PipelineLayout.hpp"
 #include "RenderPass.hpp"
 #include "ShaderModule.hpp"
 #include "SwapChain.hpp"
+#include "Assets/ProxyInstance.hpp"
 #include "Assets/Scene.hpp"
 #include "Assets/UniformBuffer.hpp"
 #include "Assets/Vertex.hpp"
+#include <array>
+#include <cstddef>
 
 namespace Vulkan {
 
+namespace
+{
+	// Binding 0 is the per-vertex data, binding 1 the per-instance data (procedural primitives proxies).
+	std::array<VkVertexInputBindingDescription, 2> GetBindingDescriptions()
+	{
+		std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = {};
+
+		bindingDescriptions[0].binding = 0;
+		bindingDescriptions[0].stride = sizeof(Assets::Vertex);
+		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		bindingDescriptions[1].binding = 1;
+		bindingDescriptions[1].stride = sizeof(Assets::ProxyInstance);
+		bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		return bindingDescriptions;
+	}
+
+	std::array<VkVertexInputAttributeDescription, 6> GetAttributeDescriptions()
+	{
+		std::array<VkVertexInputAttributeDescription, 6> attributeDescriptions = {};
+
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attributeDescriptions[0].offset = offsetof(Assets::Vertex, Position);
+
+		attributeDescriptions[1].binding = 0;
+		attributeDescriptions[1].location = 1;
+		attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attributeDescriptions[1].offset = offsetof(Assets::Vertex, Normal);
+
+		attributeDescriptions[2].binding = 0;
+		attributeDescriptions[2].location = 2;
+		attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
+		attributeDescriptions[2].offset = offsetof(Assets::Vertex, TexCoord);
+
+		attributeDescriptions[3].binding = 0;
+		attributeDescriptions[3].location = 3;
+		attributeDescriptions[3].format = VK_FORMAT_R32_SINT;
+		attributeDescriptions[3].offset = offsetof(Assets::Vertex, MaterialIndex);
+
+		attributeDescriptions[4].binding = 1;
+		attributeDescriptions[4].location = 4;
+		attributeDescriptions[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		attributeDescriptions[4].offset = offsetof(Assets::ProxyInstance, CenterAndRadius);
+
+		attributeDescriptions[5].binding = 1;
+		attributeDescriptions[5].location = 5;
+		attributeDescriptions[5].format = VK_FORMAT_R32_SINT;
+		attributeDescriptions[5].offset = offsetof(Assets::ProxyInstance, MaterialIndex);
+
+		return attributeDescriptions;
+	}
+}
+
 GraphicsPipeline::GraphicsPipeline(
-	const SwapChain& swapChain, 
-	const DepthBuffer& depthBuffer,
+	const class RenderPass& renderPass,
+	const PipelineCache& pipelineCache,
 	const std::vector<Assets::UniformBuffer>& uniformBuffers,
-	const Assets::Scene& scene,
-	const bool isWireFrame) :
-	swapChain_(swapChain),
-	isWireFrame_(isWireFrame)
+	const Assets::Scene& scene) :
+	device_(pipelineCache.Device()),
+	colorFormat_(renderPass.SwapChain().Format()),
+	depthFormat_(renderPass.DepthBuffer().Format())
 {
-	const auto& device = swapChain.Device();
-	const auto bindingDescription = Assets::Vertex::GetBindingDescription();
-	const auto attributeDescriptions = Assets::Vertex::GetAttributeDescriptions();
+	const auto& device = pipelineCache.Device();
+
+	const auto bindingDescriptions = GetBindingDescriptions();
+	const auto attributeDescriptions = GetAttributeDescriptions();
 
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount = 1;
-	vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+	vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+	vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
 	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
 	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
@@ -39,30 +101,30 @@ GraphicsPipeline::GraphicsPipeline(
 	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 	inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-	VkViewport viewport = {};
-	viewport.x = 0.0f;
-	viewport.y = 0.0f;
-	viewport.width = static_cast<float>(swapChain.Extent().width);
-	viewport.height = static_cast<float>(swapChain.Extent().height);
-	viewport.minDepth = 0.0f;
-	viewport.maxDepth = 1.0f;
-
-	VkRect2D scissor = {};
-	scissor.offset = { 0, 0 };
-	scissor.extent = swapChain.Extent();
-
+	// Viewport and scissor are dynamic so that the pipeline survives swap chain recreation.
 	VkPipelineViewportStateCreateInfo viewportState = {};
 	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
 	viewportState.viewportCount = 1;
-	viewportState.pViewports = &viewport;
+	viewportState.pViewports = nullptr;
 	viewportState.scissorCount = 1;
-	viewportState.pScissors = &scissor;
+	viewportState.pScissors = nullptr;
+
+	const std::array<VkDynamicState, 2> dynamicStates =
+	{
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR
+	};
+
+	VkPipelineDynamicStateCreateInfo dynamicState = {};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+	dynamicState.pDynamicStates = dynamicStates.data();
 
 	VkPipelineRasterizationStateCreateInfo rasterizer = {};
 	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
 	rasterizer.depthClampEnable = VK_FALSE;
 	rasterizer.rasterizerDiscardEnable = VK_FALSE;
-	rasterizer.polygonMode = isWireFrame ? VK_POLYGON_MODE_LINE : VK_POLYGON_MODE_FILL;
+	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
 	rasterizer.lineWidth = 1.0f;
 	rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
 	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
@@ -125,7 +187,7 @@ GraphicsPipeline::GraphicsPipeline(
 
 	auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
-	for (uint32_t i = 0; i != swapChain.Images().size(); ++i)
+	for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
 	{
 		// Uniform buffer
 		VkDescriptorBufferInfo uniformBufferInfo = {};
@@ -158,9 +220,8 @@ GraphicsPipeline::GraphicsPipeline(
 		descriptorSets.UpdateDescriptors(i, descriptorWrites);
 	}
 
-	// Create pipeline layout and render pass.
+	// Create pipeline layout.
 	pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
-	renderPass_.reset(new class RenderPass(swapChain, depthBuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_LOAD_OP_CLEAR));
 
 	// Load shaders.
 	const ShaderModule vertShader(device, "../assets/shaders/Graphics.vert.spv");
@@ -172,7 +233,10 @@ GraphicsPipeline::GraphicsPipeline(
 		fragShader.CreateShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT)
 	};
 
-	// Create graphic pipeline
+	// Create graphic pipelines, the wireframe one only differs by its polygon mode.
+	VkPipelineRasterizationStateCreateInfo wireFrameRasterizer = rasterizer;
+	wireFrameRasterizer.polygonMode = VK_POLYGON_MODE_LINE;
+
 	VkGraphicsPipelineCreateInfo pipelineInfo = {};
 	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 	pipelineInfo.stageCount = 2;
@@ -184,33 +248,71 @@ GraphicsPipeline::GraphicsPipeline(
 	pipelineInfo.pMultisampleState = &multisampling;
 	pipelineInfo.pDepthStencilState = &depthStencil;
 	pipelineInfo.pColorBlendState = &colorBlending;
-	pipelineInfo.pDynamicState = nullptr; // Optional
+	pipelineInfo.pDynamicState = &dynamicState;
 	pipelineInfo.basePipelineHandle = nullptr; // Optional
 	pipelineInfo.basePipelineIndex = -1; // Optional
 	pipelineInfo.layout = pipelineLayout_->Handle();
-	pipelineInfo.renderPass = renderPass_->Handle();
+	pipelineInfo.renderPass = renderPass.Handle();
 	pipelineInfo.subpass = 0;
 
-	Check(vkCreateGraphicsPipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
-		"create graphics pipeline");
+	VkGraphicsPipelineCreateInfo wireFramePipelineInfo = pipelineInfo;
+	wireFramePipelineInfo.pRasterizationState = &wireFrameRasterizer;
+
+	const std::array<VkGraphicsPipelineCreateInfo, 2> pipelineInfos = { pipelineInfo, wireFramePipelineInfo };
+	std::array<VkPipeline, 2> pipelines = {};
+
+	Check(vkCreateGraphicsPipelines(device.Handle(), pipelineCache.Handle(), static_cast<uint32_t>(pipelineInfos.size()), pipelineInfos.data(), nullptr, pipelines.data()),
+		"create graphics pipelines");
+
+	pipeline_ = pipelines[0];
+	wireFramePipeline_ = pipelines[1];
 }
 
 GraphicsPipeline::~GraphicsPipeline()
 {
+	if (wireFramePipeline_ != nullptr)
+	{
+		vkDestroyPipeline(device_.Handle(), wireFramePipeline_, nullptr);
+		wireFramePipeline_ = nullptr;
+	}
+
 	if (pipeline_ != nullptr)
 	{
-		vkDestroyPipeline(swapChain_.Device().Handle(), pipeline_, nullptr);
+		vkDestroyPipeline(device_.Handle(), pipeline_, nullptr);
 		pipeline_ = nullptr;
 	}
 
-	renderPass_.reset();
 	pipelineLayout_.reset();
 	descriptorSetManager_.reset();
 }
 
+bool GraphicsPipeline::IsCompatible(const class RenderPass& renderPass) const
+{
+	return
+		colorFormat_ == renderPass.SwapChain().Format() &&
+		depthFormat_ == renderPass.DepthBuffer().Format();
+}
+
 VkDescriptorSet GraphicsPipeline::DescriptorSet(const uint32_t index) const
 {
 	return descriptorSetManager_->DescriptorSets().Handle(index);
 }
 
+void GraphicsPipeline::UpdateTextures(const uint32_t index, const std::vector<VkImageView>& imageViews, const std::vector<VkSampler>& samplers)
+{
+	auto& descriptorSets = descriptorSetManager_->DescriptorSets();
+
+	std::vector<VkDescriptorImageInfo> imageInfos(imageViews.size());
+
+	for (size_t t = 0; t != imageInfos.size(); ++t)
+	{
+		auto& imageInfo = imageInfos[t];
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = imageViews[t];
+		imageInfo.sampler = samplers[t];
+	}
+
+	descriptorSets.UpdateDescriptors(index, { descriptorSets.Bind(index, 2, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size())) });
+}
+
 }
@@ -12,10 +12,10 @@ namespace Assets
 
 namespace Vulkan
 {
-	class DepthBuffer;
+	class Device;
+	class PipelineCache;
 	class PipelineLayout;
 	class RenderPass;
-	class SwapChain;
 
 	class GraphicsPipeline final
 	{
@@ -24,28 +24,35 @@ namespace Vulkan
 		VULKAN_NON_COPIABLE(GraphicsPipeline)
 
 		GraphicsPipeline(
-			const SwapChain& swapChain, 
-			const DepthBuffer& depthBuffer,
+			const RenderPass& renderPass,
+			const PipelineCache& pipelineCache,
 			const std::vector<Assets::UniformBuffer>& uniformBuffers,
-			const Assets::Scene& scene,
-			bool isWireFrame);
+			const Assets::Scene& scene);
 		~GraphicsPipeline();
 
+		// The pipeline and its per frame in flight descriptor sets survive swap chain recreation, 
+		// as long as the render pass formats have not changed.
+		bool IsCompatible(const RenderPass& renderPass) const;
+
 		VkDescriptorSet DescriptorSet(uint32_t index) const;
-		bool IsWireFrame() const { return isWireFrame_; }
+
+		// Point the textures of a descriptor set at other images (e.g. streamed ones), once its previous use has completed.
+		void UpdateTextures(uint32_t index, const std::vector<VkImageView>& imageViews, const std::vector<VkSampler>& samplers);
+
+		VkPipeline WireFrameHandle() const { return wireFramePipeline_; }
 		const class PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
-		const class RenderPass& RenderPass() const { return *renderPass_; }
 
 	private:
 
-		const SwapChain& swapChain_;
-		const bool isWireFrame_;
+		const class Device& device_;
+		const VkFormat colorFormat_;
+		const VkFormat depthFormat_;
 
 		VULKAN_HANDLE(VkPipeline, pipeline_)
+		VkPipeline wireFramePipeline_{};
 
 		std::unique_ptr<class DescriptorSetManager> descriptorSetManager_;
 		std::unique_ptr<class PipelineLayout> pipelineLayout_;
-		std::unique_ptr<class RenderPass> renderPass_;
 	};
 
 }
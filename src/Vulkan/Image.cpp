@@ -18,9 +18,21 @@ Image::Image(
 	const VkFormat format,
 	const VkImageTiling tiling,
 	const VkImageUsageFlags usage) :
+	Image(device, extent, 1, format, tiling, usage)
+{
+}
+
+Image::Image(
+	const class Device& device,
+	const VkExtent2D extent,
+	const uint32_t mipLevels,
+	const VkFormat format,
+	const VkImageTiling tiling,
+	const VkImageUsageFlags usage) :
 	device_(device),
 	extent_(extent),
 	format_(format),
+	mipLevels_(mipLevels),
 	imageLayout_(VK_IMAGE_LAYOUT_UNDEFINED)
 {
 	VkImageCreateInfo imageInfo = {};
@@ -29,7 +41,7 @@ Image::Image(
 	imageInfo.extent.width = extent.width;
 	imageInfo.extent.height = extent.height;
 	imageInfo.extent.depth = 1;
-	imageInfo.mipLevels = 1;
+	imageInfo.mipLevels = mipLevels;
 	imageInfo.arrayLayers = 1;
 	imageInfo.format = format;
 	imageInfo.tiling = tiling;
@@ -47,6 +59,7 @@ Image::Image(Image&& other) noexcept :
 	device_(other.device_),
 	extent_(other.extent_),
 	format_(other.format_),
+	mipLevels_(other.mipLevels_),
 	imageLayout_(other.imageLayout_),
 	image_(other.image_)
 {
@@ -80,6 +93,12 @@ VkMemoryRequirements Image::GetMemoryRequirements() const
 	return requirements;
 }
 
+void Image::BindMemory(const DeviceMemory& memory, const VkDeviceSize offset) const
+{
+	Check(vkBindImageMemory(device_.Handle(), image_, memory.Handle(), offset),
+		"bind image memory");
+}
+
 void Image::TransitionImageLayout(CommandPool& commandPool, VkImageLayout newLayout)
 {
 	SingleTimeCommands::Submit(commandPool, [&](VkCommandBuffer commandBuffer)
@@ -152,19 +171,24 @@ void Image::CopyFrom(CommandPool& commandPool, const Buffer& buffer)
 {
 	SingleTimeCommands::Submit(commandPool, [&](VkCommandBuffer commandBuffer)
 	{
-		VkBufferImageCopy region = {};
-		region.bufferOffset = 0;
-		region.bufferRowLength = 0;
-		region.bufferImageHeight = 0;
-		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		region.imageSubresource.mipLevel = 0;
-		region.imageSubresource.baseArrayLayer = 0;
-		region.imageSubresource.layerCount = 1;
-		region.imageOffset = { 0, 0, 0 };
-		region.imageExtent = { extent_.width, extent_.height, 1 };
-
-		vkCmdCopyBufferToImage(commandBuffer, buffer.Handle(), image_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+		CopyFrom(commandBuffer, buffer);
 	});
 }
 
+void Image::CopyFrom(VkCommandBuffer commandBuffer, const Buffer& buffer)
+{
+	VkBufferImageCopy region = {};
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = { extent_.width, extent_.height, 1 };
+
+	vkCmdCopyBufferToImage(commandBuffer, buffer.Handle(), image_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+}
+
 }
@@ -19,24 +19,29 @@ namespace Vulkan
 
 		Image(const Device& device, VkExtent2D extent, VkFormat format);
 		Image(const Device& device, VkExtent2D extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage);
+		Image(const Device& device, VkExtent2D extent, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage);
 		Image(Image&& other) noexcept;
 		~Image();
 
 		const class Device& Device() const { return device_; }
 		VkExtent2D Extent() const { return extent_; }
 		VkFormat Format() const { return format_; }
+		uint32_t MipLevels() const { return mipLevels_; }
 
 		DeviceMemory AllocateMemory(VkMemoryPropertyFlags properties) const;
 		VkMemoryRequirements GetMemoryRequirements() const;
+		void BindMemory(const DeviceMemory& memory, VkDeviceSize offset) const;
 
 		void TransitionImageLayout(CommandPool& commandPool, VkImageLayout newLayout);
 		void CopyFrom(CommandPool& commandPool, const Buffer& buffer);
+		void CopyFrom(VkCommandBuffer commandBuffer, const Buffer& buffer);
 
 	private:
 
 		const class Device& device_;
 		const VkExtent2D extent_;
 		const VkFormat format_;
+		const uint32_t mipLevels_;
 		VkImageLayout imageLayout_;
 
 		VULKAN_HANDLE(VkImage, image_)
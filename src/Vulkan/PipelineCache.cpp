@@ -0,0 +1,107 @@
+#include "PipelineCache.hpp"
+#include "Device.hpp"
+#include "Utilities/Exception.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace Vulkan {
+
+namespace
+{
+	// See VkPipelineCacheHeaderVersionOne in the Vulkan specification.
+	bool IsCompatible(const Device& device, const std::vector<char>& data)
+	{
+		const size_t headerSize = 16 + VK_UUID_SIZE;
+
+		if (data.size() < headerSize)
+		{
+			return false;
+		}
+
+		uint32_t header[4];
+		std::memcpy(header, data.data(), sizeof(header));
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties);
+
+		return
+			header[0] >= headerSize &&
+			header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+			header[2] == properties.vendorID &&
+			header[3] == properties.deviceID &&
+			std::memcmp(data.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+	}
+}
+
+PipelineCache::PipelineCache(const class Device& device, std::string filename) :
+	device_(device),
+	filename_(std::move(filename))
+{
+	std::cout << "- loading pipeline cache '" << filename_ << "'... " << std::flush;
+
+	std::ifstream file(filename_, std::ios::binary);
+	std::vector<char> data;
+
+	if (file)
+	{
+		data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	isWarm_ = IsCompatible(device, data);
+
+	VkPipelineCacheCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = isWarm_ ? data.size() : 0;
+	createInfo.pInitialData = isWarm_ ? data.data() : nullptr;
+
+	Check(vkCreatePipelineCache(device.Handle(), &createInfo, nullptr, &pipelineCache_),
+		"create pipeline cache");
+
+	std::cout << (isWarm_ ? "warm" : "cold") << " (" << createInfo.initialDataSize << " bytes)" << std::endl;
+}
+
+PipelineCache::~PipelineCache()
+{
+	if (pipelineCache_ != nullptr)
+	{
+		Save();
+
+		vkDestroyPipelineCache(device_.Handle(), pipelineCache_, nullptr);
+		pipelineCache_ = nullptr;
+	}
+}
+
+void PipelineCache::Save() const
+{
+	try
+	{
+		Write();
+	}
+	catch (const std::exception& exception)
+	{
+		std::cerr << "WARNING: failed to save pipeline cache '" << filename_ << "' (" << exception.what() << ")" << std::endl;
+	}
+}
+
+void PipelineCache::Write() const
+{
+	size_t size = 0;
+	Check(vkGetPipelineCacheData(device_.Handle(), pipelineCache_, &size, nullptr),
+		"get pipeline cache data size");
+
+	std::vector<char> data(size);
+	Check(vkGetPipelineCacheData(device_.Handle(), pipelineCache_, &size, data.data()),
+		"get pipeline cache data");
+
+	std::ofstream file(filename_, std::ios::binary | std::ios::trunc);
+
+	if (!file.write(data.data(), static_cast<std::streamsize>(size)))
+	{
+		Throw(std::runtime_error("failed to write pipeline cache '" + filename_ + "'"));
+	}
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include <string>
+
+namespace Vulkan
+{
+	class Device;
+
+	// Pipeline cache persisted on disk between runs. The cache content is only reused if it was 
+	// created by the same driver on the same device, otherwise it starts empty (cold).
+	class PipelineCache final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(PipelineCache)
+
+		PipelineCache(const Device& device, std::string filename);
+		~PipelineCache();
+
+		const class Device& Device() const { return device_; }
+		bool IsWarm() const { return isWarm_; }
+
+		// Write the cache content to disk (e.g. once the pipelines have been created), as well as on destruction.
+		// A failure is only reported, the cache then starts cold on the next run.
+		void Save() const;
+
+	private:
+
+		void Write() const;
+
+		const class Device& device_;
+		const std::string filename_;
+		bool isWarm_{};
+
+		VULKAN_HANDLE(VkPipelineCache, pipelineCache_)
+	};
+
+}
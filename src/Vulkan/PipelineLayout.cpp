@@ -4,17 +4,27 @@
 
 namespace Vulkan {
 
-PipelineLayout::PipelineLayout(const Device & device, const DescriptorSetLayout& descriptorSetLayout) :
+PipelineLayout::PipelineLayout(const Device & device, const DescriptorSetLayout& descriptorSetLayout, const std::vector<VkPushConstantRange>& pushConstantRanges) :
+	PipelineLayout(device, std::vector<const DescriptorSetLayout*>{ &descriptorSetLayout }, pushConstantRanges)
+{
+}
+
+PipelineLayout::PipelineLayout(const Device& device, const std::vector<const DescriptorSetLayout*>& descriptorSetLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges) :
 	device_(device)
 {
-	VkDescriptorSetLayout descriptorSetLayouts[] = { descriptorSetLayout.Handle() };
+	std::vector<VkDescriptorSetLayout> descriptorSetLayoutHandles;
+
+	for (const auto* descriptorSetLayout : descriptorSetLayouts)
+	{
+		descriptorSetLayoutHandles.push_back(descriptorSetLayout->Handle());
+	}
 
 	VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
 	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipelineLayoutInfo.setLayoutCount = 1;
-	pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts;
-	pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-	pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
+	pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayoutHandles.size());
+	pipelineLayoutInfo.pSetLayouts = descriptorSetLayoutHandles.data();
+	pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+	pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
 
 	Check(vkCreatePipelineLayout(device_.Handle(), &pipelineLayoutInfo, nullptr, &pipelineLayout_),
 		"create pipeline layout");
@@ -0,0 +1,52 @@
+#include "QueryPool.hpp"
+#include "Device.hpp"
+#include "Utilities/Exception.hpp"
+
+namespace Vulkan {
+
+QueryPool::QueryPool(const class Device& device, const VkQueryType type, const uint32_t count) :
+	device_(device)
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties);
+
+	timestampPeriod_ = properties.limits.timestampPeriod * 1e-9;
+
+	VkQueryPoolCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	createInfo.queryType = type;
+	createInfo.queryCount = count;
+
+	Check(vkCreateQueryPool(device.Handle(), &createInfo, nullptr, &queryPool_),
+		"create query pool");
+}
+
+QueryPool::~QueryPool()
+{
+	if (queryPool_ != nullptr)
+	{
+		vkDestroyQueryPool(device_.Handle(), queryPool_, nullptr);
+		queryPool_ = nullptr;
+	}
+}
+
+bool QueryPool::GetResults(const uint32_t firstQuery, const uint32_t count, std::vector<uint64_t>& results) const
+{
+	results.resize(count);
+
+	const auto result = vkGetQueryPoolResults(
+		device_.Handle(), queryPool_, firstQuery, count,
+		results.size() * sizeof(uint64_t), results.data(), sizeof(uint64_t),
+		VK_QUERY_RESULT_64_BIT);
+
+	if (result == VK_NOT_READY)
+	{
+		return false;
+	}
+
+	Check(result, "get query pool results");
+
+	return true;
+}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include <vector>
+
+namespace Vulkan
+{
+	class Device;
+
+	class QueryPool final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(QueryPool)
+
+		QueryPool(const Device& device, VkQueryType type, uint32_t count);
+		~QueryPool();
+
+		const class Device& Device() const { return device_; }
+
+		// Returns false if the results are not available yet (e.g. the queries have never been written).
+		bool GetResults(uint32_t firstQuery, uint32_t count, std::vector<uint64_t>& results) const;
+
+		// Duration of a timestamp query increment, in seconds.
+		double TimestampPeriod() const { return timestampPeriod_; }
+
+	private:
+
+		const class Device& device_;
+		double timestampPeriod_{};
+
+		VULKAN_HANDLE(VkQueryPool, queryPool_)
+	};
+
+}
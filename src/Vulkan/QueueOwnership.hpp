@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+namespace Vulkan
+{
+	// Queue family ownership transfers of exclusive resources (see "Queue Family Ownership Transfer" in the Vulkan spec).
+	// The release is recorded on a queue of the source family, the matching acquire (same layouts) on a queue of the
+	// destination family, in a submission waiting for the release one to complete (e.g. on its timeline value).
+	// Within the same family, the semaphore wait is enough: the release only performs the layout transition, if any,
+	// and the acquire is a no-op.
+	class QueueOwnership final
+	{
+	public:
+
+		static void ReleaseBuffer(
+			const VkCommandBuffer commandBuffer,
+			const VkBuffer buffer,
+			const uint32_t srcQueueFamilyIndex,
+			const uint32_t dstQueueFamilyIndex,
+			const VkPipelineStageFlags srcStageMask,
+			const VkAccessFlags srcAccessMask)
+		{
+			if (srcQueueFamilyIndex == dstQueueFamilyIndex)
+			{
+				return;
+			}
+
+			const auto barrier = BufferBarrier(buffer, srcQueueFamilyIndex, dstQueueFamilyIndex, srcAccessMask, 0);
+			vkCmdPipelineBarrier(commandBuffer, srcStageMask, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+		}
+
+		static void AcquireBuffer(
+			const VkCommandBuffer commandBuffer,
+			const VkBuffer buffer,
+			const uint32_t srcQueueFamilyIndex,
+			const uint32_t dstQueueFamilyIndex,
+			const VkPipelineStageFlags dstStageMask,
+			const VkAccessFlags dstAccessMask)
+		{
+			if (srcQueueFamilyIndex == dstQueueFamilyIndex)
+			{
+				return;
+			}
+
+			const auto barrier = BufferBarrier(buffer, srcQueueFamilyIndex, dstQueueFamilyIndex, 0, dstAccessMask);
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStageMask, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+		}
+
+		static void ReleaseImage(
+			const VkCommandBuffer commandBuffer,
+			const VkImage image,
+			const VkImageSubresourceRange subresourceRange,
+			const uint32_t srcQueueFamilyIndex,
+			const uint32_t dstQueueFamilyIndex,
+			const VkPipelineStageFlags srcStageMask,
+			const VkAccessFlags srcAccessMask,
+			const VkImageLayout oldLayout,
+			const VkImageLayout newLayout)
+		{
+			const auto barrier = ImageBarrier(image, subresourceRange, srcQueueFamilyIndex, dstQueueFamilyIndex, srcAccessMask, 0, oldLayout, newLayout);
+			vkCmdPipelineBarrier(commandBuffer, srcStageMask, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+
+		static void AcquireImage(
+			const VkCommandBuffer commandBuffer,
+			const VkImage image,
+			const VkImageSubresourceRange subresourceRange,
+			const uint32_t srcQueueFamilyIndex,
+			const uint32_t dstQueueFamilyIndex,
+			const VkPipelineStageFlags dstStageMask,
+			const VkAccessFlags dstAccessMask,
+			const VkImageLayout oldLayout,
+			const VkImageLayout newLayout)
+		{
+			if (srcQueueFamilyIndex == dstQueueFamilyIndex)
+			{
+				return;
+			}
+
+			const auto barrier = ImageBarrier(image, subresourceRange, srcQueueFamilyIndex, dstQueueFamilyIndex, 0, dstAccessMask, oldLayout, newLayout);
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dstStageMask, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+
+	private:
+
+		static VkBufferMemoryBarrier BufferBarrier(
+			const VkBuffer buffer,
+			const uint32_t srcQueueFamilyIndex,
+			const uint32_t dstQueueFamilyIndex,
+			const VkAccessFlags srcAccessMask,
+			const VkAccessFlags dstAccessMask)
+		{
+			VkBufferMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask = srcAccessMask;
+			barrier.dstAccessMask = dstAccessMask;
+			barrier.srcQueueFamilyIndex = srcQueueFamilyIndex;
+			barrier.dstQueueFamilyIndex = dstQueueFamilyIndex;
+			barrier.buffer = buffer;
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+
+			return barrier;
+		}
+
+		static VkImageMemoryBarrier ImageBarrier(
+			const VkImage image,
+			const VkImageSubresourceRange subresourceRange,
+			const uint32_t srcQueueFamilyIndex,
+			const uint32_t dstQueueFamilyIndex,
+			const VkAccessFlags srcAccessMask,
+			const VkAccessFlags dstAccessMask,
+			const VkImageLayout oldLayout,
+			const VkImageLayout newLayout)
+		{
+			const auto sameFamily = srcQueueFamilyIndex == dstQueueFamilyIndex;
+
+			VkImageMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = srcAccessMask;
+			barrier.dstAccessMask = dstAccessMask;
+			barrier.oldLayout = oldLayout;
+			barrier.newLayout = newLayout;
+			barrier.srcQueueFamilyIndex = sameFamily ? VK_QUEUE_FAMILY_IGNORED : srcQueueFamilyIndex;
+			barrier.dstQueueFamilyIndex = sameFamily ? VK_QUEUE_FAMILY_IGNORED : dstQueueFamilyIndex;
+			barrier.image = image;
+			barrier.subresourceRange = subresourceRange;
+
+			return barrier;
+		}
+	};
+
+}
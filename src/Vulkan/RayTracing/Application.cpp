@@ -4,18 +4,28 @@
 #include "RayTracingPipeline.hpp"
 #include "ShaderBindingTable.hpp"
 #include "TopLevelAccelerationStructure.hpp"
+#include "UpscalePipeline.hpp"
 #include "Assets/Model.hpp"
 #include "Assets/Scene.hpp"
+#include "Assets/TextureStreamer.hpp"
+#include "Utilities/Exception.hpp"
 #include "Utilities/Glm.hpp"
+#include "Utilities/Tracer.hpp"
+#include "Vulkan/BindlessHeap.hpp"
 #include "Vulkan/Buffer.hpp"
 #include "Vulkan/BufferUtil.hpp"
+#include "Vulkan/CommandQueue.hpp"
+#include "Vulkan/GraphicsPipeline.hpp"
 #include "Vulkan/Image.hpp"
-#include "Vulkan/ImageMemoryBarrier.hpp"
 #include "Vulkan/ImageView.hpp"
 #include "Vulkan/PipelineLayout.hpp"
+#include "Vulkan/QueueOwnership.hpp"
 #include "Vulkan/SingleTimeCommands.hpp"
 #include "Vulkan/SwapChain.hpp"
+#include "Vulkan/TimelineSemaphore.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <numeric>
 
@@ -38,18 +48,96 @@ namespace
 
 		return total;
 	}
+
+	// Strength of the contrast adaptive sharpening following the upscale (see Upscale.comp).
+	const float UpscaleSharpness = 0.5f;
+
+	// Device memory for the streamed texture levels, on top of the always resident tails (see Assets::TextureStreamer).
+	const VkDeviceSize TextureStreamingBudget = 512 * 1024 * 1024;
+
+	// One hit group record per instance (see CreateTopLevelStructures()), embedding its material and geometry so that
+	// the hit shaders do not have to look them up.
+	std::vector<ShaderBindingTable::Entry> CreateHitGroups(const RayTracingPipeline& rayTracingPipeline, const Assets::Scene& scene)
+	{
+		const auto vertices = scene.VertexBuffer().GetDeviceAddress();
+		const auto indices = scene.IndexBuffer().GetDeviceAddress();
+
+		std::vector<ShaderBindingTable::Entry> hitGroups;
+		hitGroups.reserve(scene.Models().size());
+
+		for (size_t i = 0; i != scene.Models().size(); ++i)
+		{
+			const auto& model = scene.Models()[i];
+			const auto& offsets = scene.Offsets()[i];
+
+			RayTracingPipeline::HitRecord record = {};
+			record.ModelMaterial = model.Materials()[0];
+			record.Vertices = vertices + offsets.y * sizeof(Assets::Vertex);
+			record.Indices = indices + offsets.x * sizeof(uint32_t);
+			record.Sphere = scene.Procedurals()[i];
+			record.PerVertexMaterials = model.NumberOfMaterials() != 1;
+
+			// The hit group specialized for the model material, or the generic one when the model has several materials.
+			const auto materialModel = record.PerVertexMaterials
+				? RayTracingPipeline::AnyMaterialModel
+				: static_cast<uint32_t>(record.ModelMaterial.MaterialModel);
+
+			ShaderBindingTable::Entry entry{
+				model.Procedural() ? rayTracingPipeline.ProceduralHitGroupIndex(materialModel) : rayTracingPipeline.TriangleHitGroupIndex(materialModel),
+				std::vector<unsigned char>(sizeof(record)) };
+
+			std::memcpy(entry.InlineData.data(), &record, sizeof(record));
+			hitGroups.push_back(std::move(entry));
+		}
+
+		return hitGroups;
+	}
 }
 
-Application::Application(const WindowConfig& windowConfig, const VkPresentModeKHR presentMode, const bool enableValidationLayers) :
-	Vulkan::Application(windowConfig, presentMode, enableValidationLayers)
+// The acceleration structures of a scene, and the compute queue timeline value once they are built.
+// Declared in reverse destruction order: the structures go before their buffers, the buffers before their memory.
+struct Application::AccelerationStructures final
+{
+	const Assets::Scene* Scene{};
+	uint64_t Built{};
+	std::chrono::high_resolution_clock::time_point BuildStart;
+
+	std::unique_ptr<DeviceMemory> BottomBufferMemory;
+	std::unique_ptr<Buffer> BottomBuffer;
+	std::unique_ptr<DeviceMemory> BottomScratchBufferMemory;
+	std::unique_ptr<Buffer> BottomScratchBuffer;
+	std::vector<BottomLevelAccelerationStructure> BottomAs;
+
+	std::unique_ptr<DeviceMemory> TopBufferMemory;
+	std::unique_ptr<Buffer> TopBuffer;
+	std::unique_ptr<DeviceMemory> TopScratchBufferMemory;
+	std::unique_ptr<Buffer> TopScratchBuffer;
+	std::unique_ptr<DeviceMemory> InstancesBufferMemory;
+	std::unique_ptr<Buffer> InstancesBuffer;
+	std::vector<TopLevelAccelerationStructure> TopAs;
+};
+
+Application::Application(const WindowConfig& windowConfig, const VkPresentModeKHR presentMode, const uint32_t framesInFlight, const bool enableValidationLayers) :
+	Vulkan::Application(windowConfig, presentMode, framesInFlight, enableValidationLayers)
 {
 }
 
 Application::~Application()
 {
+	// The streamed textures retired along with a previous scene still hold bindless heap slots (see RecreatePipelines()).
+	if (bindlessHeap_)
+	{
+		GraphicsQueue().WaitIdle();
+		ReleaseRetired();
+	}
+
 	Application::DeleteSwapChain();
+	Application::DeletePipelines();
 	DeleteAccelerationStructures();
 
+	upscalePipeline_.reset();
+	bindlessHeap_.reset();
+	rayCounters_.reset();
 	rayTracingProperties_.reset();
 	deviceProcedures_.reset();
 }
@@ -69,6 +157,18 @@ void Application::SetPhysicalDevice(
 	});
 
 	// Required device features.
+	// The bindless heap indexes its storage buffer and sampled image arrays with dynamically uniform indices.
+	VkPhysicalDeviceFeatures supportedFeatures = {};
+	vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
+	if (!supportedFeatures.shaderStorageBufferArrayDynamicIndexing || !supportedFeatures.shaderSampledImageArrayDynamicIndexing)
+	{
+		Throw(std::runtime_error("physical device does not support dynamic indexing of storage buffer and sampled image arrays"));
+	}
+
+	deviceFeatures.shaderStorageBufferArrayDynamicIndexing = true;
+	deviceFeatures.shaderSampledImageArrayDynamicIndexing = true;
+
 	VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeatures = {};
 	bufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
 	bufferDeviceAddressFeatures.pNext = nextDeviceFeatures;
@@ -79,6 +179,10 @@ void Application::SetPhysicalDevice(
 	indexingFeatures.pNext = &bufferDeviceAddressFeatures;
 	indexingFeatures.runtimeDescriptorArray = true;
 	indexingFeatures.shaderSampledImageArrayNonUniformIndexing = true;
+	indexingFeatures.descriptorBindingPartiallyBound = true;
+	indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = true;
+	indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = true;
+	indexingFeatures.descriptorBindingUpdateUnusedWhilePending = true;
 
 	VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructureFeatures = {};
 	accelerationStructureFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
@@ -99,42 +203,118 @@ void Application::OnDeviceSet()
 
 	deviceProcedures_.reset(new DeviceProcedures(Device()));
 	rayTracingProperties_.reset(new RayTracingProperties(Device()));
+	rayCounters_.reset(new ShaderCounters(Device(), sizeof(RayStatistics), FramesInFlight()));
+	bindlessHeap_.reset(new BindlessHeap(Device(), FramesInFlight()));
+}
+
+void Application::BuildAccelerationStructures(const Assets::Scene& scene)
+{
+	Utilities::Tracer::Zone zone("BuildAccelerationStructures");
+
+	if (nextAccelerationStructures_)
+	{
+		Throw(std::logic_error("acceleration structures are already being built"));
+	}
+
+	auto& transferQueue = TransferQueue();
+	auto& computeQueue = ComputeQueue();
+	auto& graphicsQueue = GraphicsQueue();
+
+	std::unique_ptr<AccelerationStructures> structures(new AccelerationStructures());
+	structures->Scene = &scene;
+	structures->BuildStart = std::chrono::high_resolution_clock::now();
+
+	// Build on the async compute queue, as soon as the geometry is uploaded. The rest of the scene (e.g. the textures)
+	// keeps uploading on the transfer queue meanwhile.
+	structures->Built = computeQueue.Submit({ { transferQueue, scene.BuildInputsUploaded() } }, [&](VkCommandBuffer commandBuffer)
+	{
+		scene.AcquireBuildInputs(commandBuffer);
+
+		CreateBottomLevelStructures(commandBuffer, *structures);
+		CreateTopLevelStructures(commandBuffer, *structures);
+
+		scene.ReleaseBuildInputs(commandBuffer);
+
+		for (const auto* buffer : { structures->BottomBuffer.get(), structures->TopBuffer.get() })
+		{
+			QueueOwnership::ReleaseBuffer(commandBuffer, buffer->Handle(), computeQueue.FamilyIndex(), graphicsQueue.FamilyIndex(),
+				VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR);
+		}
+	});
+
+	nextAccelerationStructures_ = std::move(structures);
+}
+
+bool Application::AreAccelerationStructuresBuilt()
+{
+	const auto& structures = nextAccelerationStructures_;
+
+	return structures &&
+		ComputeQueue().Timeline().Value() >= structures->Built &&
+		TransferQueue().Timeline().Value() >= structures->Scene->Uploaded();
 }
 
-void Application::CreateAccelerationStructures()
+void Application::SwitchAccelerationStructures()
 {
-	const auto timer = std::chrono::high_resolution_clock::now();
+	Utilities::Tracer::Zone zone("SwitchAccelerationStructures");
+
+	auto& structures = *nextAccelerationStructures_;
+	const auto& scene = *structures.Scene;
+	auto& transferQueue = TransferQueue();
+	auto& computeQueue = ComputeQueue();
+	auto& graphicsQueue = GraphicsQueue();
 
-	SingleTimeCommands::Submit(CommandPool(), [this](VkCommandBuffer commandBuffer)
+	// Usually completed already, only the submissions are then freed (and their GPU time collected).
+	transferQueue.WaitFor(scene.Uploaded());
+	computeQueue.WaitFor(structures.Built);
+
+	// Hand everything over to the graphics queue, which traces the scene. Submitted once the build has completed,
+	// the acquisition does not hold back the frames still tracing the previous scene.
+	graphicsQueue.Submit({ { transferQueue, scene.Uploaded() }, { computeQueue, structures.Built } }, [&](VkCommandBuffer commandBuffer)
 	{
-		CreateBottomLevelStructures(commandBuffer);
-		CreateTopLevelStructures(commandBuffer);
+		scene.Acquire(commandBuffer);
+
+		for (const auto* buffer : { structures.BottomBuffer.get(), structures.TopBuffer.get() })
+		{
+			QueueOwnership::AcquireBuffer(commandBuffer, buffer->Handle(), computeQueue.FamilyIndex(), graphicsQueue.FamilyIndex(),
+				VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR);
+		}
 	});
 
-	topScratchBuffer_.reset();
-	topScratchBufferMemory_.reset();
-	bottomScratchBuffer_.reset();
-	bottomScratchBufferMemory_.reset();
+	structures.TopScratchBuffer.reset();
+	structures.TopScratchBufferMemory.reset();
+	structures.BottomScratchBuffer.reset();
+	structures.BottomScratchBufferMemory.reset();
+
+	// The frames submitted before the acquisition may still trace the previous structures.
+	Retire(std::move(accelerationStructures_));
+	accelerationStructures_ = std::move(nextAccelerationStructures_);
 
-	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - accelerationStructures_->BuildStart).count();
 	std::cout << "- built acceleration structures in " << elapsed << "s" << std::endl;
+
+	// The GPU time spans of the scene upload and of the builds, as measured by the queues timestamps.
+	// Different queues may not share a time base, their overlap is only meaningful once calibrated to the host clock.
+	double uploadStart = 0, uploadEnd = 0, buildStart = 0, buildEnd = 0;
+
+	if (transferQueue.GetBusyTime(uploadStart, uploadEnd) && computeQueue.GetBusyTime(buildStart, buildEnd))
+	{
+		std::cout << "- GPU upload " << (uploadEnd - uploadStart) * 1000 << "ms (transfer queue), build " << (buildEnd - buildStart) * 1000 << "ms (compute queue)";
+
+		if (transferQueue.HasCalibratedTimestamps() && computeQueue.HasCalibratedTimestamps())
+		{
+			const auto overlap = std::max(0.0, std::min(uploadEnd, buildEnd) - std::max(uploadStart, buildStart));
+			std::cout << ", overlapping " << overlap * 1000 << "ms";
+		}
+
+		std::cout << std::endl;
+	}
 }
 
 void Application::DeleteAccelerationStructures()
 {
-	topAs_.clear();
-	instancesBuffer_.reset();
-	instancesBufferMemory_.reset();
-	topScratchBuffer_.reset();
-	topScratchBufferMemory_.reset();
-	topBuffer_.reset();
-	topBufferMemory_.reset();
-
-	bottomAs_.clear();
-	bottomScratchBuffer_.reset();
-	bottomScratchBufferMemory_.reset();
-	bottomBuffer_.reset();
-	bottomBufferMemory_.reset();
+	nextAccelerationStructures_.reset();
+	accelerationStructures_.reset();
 }
 
 void Application::CreateSwapChain()
@@ -142,20 +322,40 @@ void Application::CreateSwapChain()
 	Vulkan::Application::CreateSwapChain();
 
 	CreateOutputImage();
+	CreateRenderGraph();
 
-	rayTracingPipeline_.reset(new RayTracingPipeline(*deviceProcedures_, SwapChain(), topAs_[0], *accumulationImageView_, *outputImageView_, UniformBuffers(), GetScene()));
+	const auto& upscaledImageView = renderGraph_->GetImageView(upscaledResource_);
 
-	const std::vector<ShaderBindingTable::Entry> rayGenPrograms = { {rayTracingPipeline_->RayGenShaderIndex(), {}} };
-	const std::vector<ShaderBindingTable::Entry> missPrograms = { {rayTracingPipeline_->MissShaderIndex(), {}} };
-	const std::vector<ShaderBindingTable::Entry> hitGroups = { {rayTracingPipeline_->TriangleHitGroupIndex(), {}}, {rayTracingPipeline_->ProceduralHitGroupIndex(), {}} };
+	if (upscalePipeline_)
+	{
+		upscalePipeline_->UpdateDescriptorSets(*outputImageView_, upscaledImageView);
+	}
+	else
+	{
+		upscalePipeline_.reset(new UpscalePipeline(PipelineCache(), *outputImageView_, upscaledImageView));
+	}
 
-	shaderBindingTable_.reset(new ShaderBindingTable(*deviceProcedures_, *rayTracingPipeline_, *rayTracingProperties_, rayGenPrograms, missPrograms, hitGroups));
+	// The pipeline only depends on the scene, it survives swap chain recreation.
+	if (rayTracingPipeline_)
+	{
+		rayTracingPipeline_->UpdateDescriptorSets(*accumulationImageView_, *outputImageView_, *historyImageViews_[0], *historyImageViews_[1]);
+		return;
+	}
+
+	CreateRayTracingPipeline();
 }
 
 void Application::DeleteSwapChain()
 {
-	shaderBindingTable_.reset();
-	rayTracingPipeline_.reset();
+	renderGraph_.reset();
+
+	for (size_t i = 0; i != historyImages_.size(); ++i)
+	{
+		historyImageViews_[i].reset();
+		historyImages_[i].reset();
+		historyImageMemories_[i].reset();
+	}
+
 	outputImageView_.reset();
 	outputImage_.reset();
 	outputImageMemory_.reset();
@@ -166,45 +366,163 @@ void Application::DeleteSwapChain()
 	Vulkan::Application::DeleteSwapChain();
 }
 
-void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageIndex)
+void Application::DeletePipelines()
+{
+	if (rayTracingPipeline_)
+	{
+		RemoveSceneFromHeap();
+	}
+
+	shaderBindingTables_.clear();
+	rayTracingPipeline_.reset();
+	costCounters_.reset();
+
+	Vulkan::Application::DeletePipelines();
+}
+
+void Application::RecreatePipelines()
+{
+	if (!rayTracingPipeline_)
+	{
+		return;
+	}
+
+	// The frames in flight may still trace with them, and sample the streamed textures of the previous scene.
+	Retire(std::move(rayTracingPipeline_));
+	Retire(std::make_shared<decltype(shaderBindingTables_)>(std::move(shaderBindingTables_)));
+	Retire(std::move(costCounters_));
+	Retire(std::move(textureStreamer_));
+
+	RemoveSceneFromHeap();
+	shaderBindingTables_.clear();
+
+	Vulkan::Application::RecreatePipelines();
+	CreateRayTracingPipeline();
+}
+
+VkExtent2D Application::GetTraceExtent() const
 {
 	const auto extent = SwapChain().Extent();
+	const auto scale = GetRenderScale();
+
+	return VkExtent2D
+	{
+		std::max(static_cast<uint32_t>(extent.width * scale + 0.5f), 1u),
+		std::max(static_cast<uint32_t>(extent.height * scale + 0.5f), 1u)
+	};
+}
+
+void Application::Render(VkCommandBuffer commandBuffer, const uint32_t frameIndex, const uint32_t imageIndex)
+{
+	// The previous use of this frame slot has completed, its ray counts are available.
+	const auto rayStatistics = rayCounters_->Read(frameIndex);
+	const auto costBuckets = costCounters_->Read(frameIndex);
+
+	hasRayStatistics_ = rayStatistics != nullptr;
+	hasCostBuckets_ = costBuckets != nullptr;
+
+	if (hasRayStatistics_)
+	{
+		std::memcpy(&rayStatistics_, rayStatistics, sizeof(RayStatistics));
+	}
 
-	VkDescriptorSet descriptorSets[] = { rayTracingPipeline_->DescriptorSet(imageIndex) };
+	if (hasCostBuckets_)
+	{
+		std::memcpy(costBuckets_.data(), costBuckets, costBuckets_.size() * sizeof(CostBucket));
+	}
 
-	VkImageSubresourceRange subresourceRange = {};
-	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	subresourceRange.baseMipLevel = 0;
-	subresourceRange.levelCount = 1;
-	subresourceRange.baseArrayLayer = 0;
-	subresourceRange.layerCount = 1;
+	// So are its texture requests, which page the texture levels in and out before this frame is recorded.
+	textureStreamer_->Update(frameIndex);
+	finestLevelsRequested_ = false;
+	bindlessHeap_->NextFrame();
+
+	renderGraph_->SetImage(swapChainResource_, SwapChain().Images()[imageIndex]);
+	renderGraph_->Execute(commandBuffer, frameIndex);
+}
 
-	// Acquire destination images for rendering.
-	ImageMemoryBarrier::Insert(commandBuffer, accumulationImage_->Handle(), subresourceRange, 0,
-		VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+void Application::Rasterize(VkCommandBuffer commandBuffer, const uint32_t frameIndex, const uint32_t imageIndex)
+{
+	// Requested once rather than every frame, so that the least recently requested textures are still the first evicted.
+	if (!finestLevelsRequested_)
+	{
+		textureStreamer_->RequestFinestLevels();
+		finestLevelsRequested_ = true;
+	}
 
-	ImageMemoryBarrier::Insert(commandBuffer, outputImage_->Handle(), subresourceRange, 0,
-		VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+	textureStreamer_->Update(frameIndex);
+	bindlessHeap_->NextFrame();
+
+	// The previous use of this frame slot has completed, its descriptor set can follow the textures swapped in since.
+	// The replaced images are only released frames in flight after the last update (see TextureStreamer::Update()).
+	std::vector<VkImageView> imageViews(textureStreamer_->TextureCount());
+	std::vector<VkSampler> samplers(textureStreamer_->TextureCount());
+
+	for (uint32_t i = 0; i != textureStreamer_->TextureCount(); ++i)
+	{
+		imageViews[i] = textureStreamer_->ImageView(i);
+		samplers[i] = textureStreamer_->Sampler(i);
+	}
+
+	GraphicsPipeline().UpdateTextures(frameIndex, imageViews, samplers);
+
+	Vulkan::Application::Render(commandBuffer, frameIndex, imageIndex);
+}
+
+void Application::RecordTrace(VkCommandBuffer commandBuffer, const uint32_t frameIndex, const VkExtent2D extent)
+{
+	VkDescriptorSet descriptorSets[] = { rayTracingPipeline_->DescriptorSet(frameIndex), bindlessHeap_->DescriptorSet() };
+
+	// Pipeline variants are compiled on first use, each one has its own shader binding table.
+	const auto shaderVariant = GetShaderVariant();
+	const auto pipeline = rayTracingPipeline_->Handle(shaderVariant);
+	auto& shaderBindingTable = shaderBindingTables_[shaderVariant];
+
+	if (!shaderBindingTable)
+	{
+		Utilities::Tracer::Zone zone("CreateShaderBindingTable");
+
+		const std::vector<ShaderBindingTable::Entry> rayGenPrograms = { {rayTracingPipeline_->RayGenShaderIndex(), {}} };
+		const std::vector<ShaderBindingTable::Entry> missPrograms = { {rayTracingPipeline_->MissShaderIndex(), {}} };
+		const std::vector<ShaderBindingTable::Entry> hitGroups = CreateHitGroups(*rayTracingPipeline_, GetScene());
+
+		shaderBindingTable.reset(new ShaderBindingTable(*deviceProcedures_, pipeline, *rayTracingProperties_, rayGenPrograms, missPrograms, hitGroups));
+	}
+
+	if (shaderVariant.CountRays)
+	{
+		rayCounters_->RecordReset(commandBuffer);
+	}
+
+	if (shaderVariant.ProfileCosts)
+	{
+		costCounters_->RecordReset(commandBuffer);
+	}
 
 	// Bind ray tracing pipeline.
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, rayTracingPipeline_->Handle());
-	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, rayTracingPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, rayTracingPipeline_->PipelineLayout().Handle(), 0, 2, descriptorSets, 0, nullptr);
+
+	auto sceneSlots = sceneSlots_;
+	sceneSlots.TextureBase = textureStreamer_->TextureBase(frameIndex);
+	sceneSlots.TextureFrameOffset = textureStreamer_->FrameOffset(frameIndex);
+
+	vkCmdPushConstants(commandBuffer, rayTracingPipeline_->PipelineLayout().Handle(), RayTracingPipeline::SceneSlotsStages, 0, sizeof(sceneSlots), &sceneSlots);
 
 	// Describe the shader binding table.
 	VkStridedDeviceAddressRegionKHR raygenShaderBindingTable = {};
-	raygenShaderBindingTable.deviceAddress = shaderBindingTable_->RayGenDeviceAddress();
-	raygenShaderBindingTable.stride = shaderBindingTable_->RayGenEntrySize();
-	raygenShaderBindingTable.size = shaderBindingTable_->RayGenSize();
+	raygenShaderBindingTable.deviceAddress = shaderBindingTable->RayGenDeviceAddress();
+	raygenShaderBindingTable.stride = shaderBindingTable->RayGenEntrySize();
+	raygenShaderBindingTable.size = shaderBindingTable->RayGenSize();
 
 	VkStridedDeviceAddressRegionKHR missShaderBindingTable = {};
-	missShaderBindingTable.deviceAddress = shaderBindingTable_->MissDeviceAddress();
-	missShaderBindingTable.stride = shaderBindingTable_->MissEntrySize();
-	missShaderBindingTable.size = shaderBindingTable_->MissSize();
+	missShaderBindingTable.deviceAddress = shaderBindingTable->MissDeviceAddress();
+	missShaderBindingTable.stride = shaderBindingTable->MissEntrySize();
+	missShaderBindingTable.size = shaderBindingTable->MissSize();
 
 	VkStridedDeviceAddressRegionKHR hitShaderBindingTable = {};
-	hitShaderBindingTable.deviceAddress = shaderBindingTable_->HitGroupDeviceAddress();
-	hitShaderBindingTable.stride = shaderBindingTable_->HitGroupEntrySize();
-	hitShaderBindingTable.size = shaderBindingTable_->HitGroupSize();
+	hitShaderBindingTable.deviceAddress = shaderBindingTable->HitGroupDeviceAddress();
+	hitShaderBindingTable.stride = shaderBindingTable->HitGroupEntrySize();
+	hitShaderBindingTable.size = shaderBindingTable->HitGroupSize();
 
 	VkStridedDeviceAddressRegionKHR callableShaderBindingTable = {};
 
@@ -213,14 +531,21 @@ void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageInde
 		&raygenShaderBindingTable, &missShaderBindingTable, &hitShaderBindingTable, &callableShaderBindingTable,
 		extent.width, extent.height, 1);
 
-	// Acquire output image and swap-chain image for copying.
-	ImageMemoryBarrier::Insert(commandBuffer, outputImage_->Handle(), subresourceRange, 
-		VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+	textureStreamer_->RecordFeedbackBarrier(commandBuffer);
 
-	ImageMemoryBarrier::Insert(commandBuffer, SwapChain().Images()[imageIndex], subresourceRange, 0,
-		VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	if (shaderVariant.CountRays)
+	{
+		rayCounters_->RecordReadback(commandBuffer, frameIndex);
+	}
 
-	// Copy output image into swap-chain image.
+	if (shaderVariant.ProfileCosts)
+	{
+		costCounters_->RecordReadback(commandBuffer, frameIndex);
+	}
+}
+
+void Application::CopyImage(VkCommandBuffer commandBuffer, VkImage source, VkImage swapChainImage, const VkExtent2D extent)
+{
 	VkImageCopy copyRegion;
 	copyRegion.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
 	copyRegion.srcOffset = { 0, 0, 0 };
@@ -229,17 +554,83 @@ void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageInde
 	copyRegion.extent = { extent.width, extent.height, 1 };
 
 	vkCmdCopyImage(commandBuffer,
-		outputImage_->Handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-		SwapChain().Images()[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		swapChainImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 		1, &copyRegion);
+}
 
-	ImageMemoryBarrier::Insert(commandBuffer, SwapChain().Images()[imageIndex], subresourceRange, VK_ACCESS_TRANSFER_WRITE_BIT,
-		0, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+void Application::ReadAccumulationImage(const VkExtent2D extent, std::vector<float>& accumulatedColors)
+{
+	const auto count = static_cast<size_t>(extent.width) * extent.height * 4;
+	const auto size = count * sizeof(float);
+
+	// Create a temporary host-visible staging buffer.
+	auto stagingBuffer = std::make_unique<Buffer>(Device(), size, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	auto stagingBufferMemory = stagingBuffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	SingleTimeCommands::Submit(CommandPool(), [&](VkCommandBuffer commandBuffer)
+	{
+		renderGraph_->Use(commandBuffer, accumulationResource_, RenderGraph::Usage::TransferSrc, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+		VkBufferImageCopy region = {};
+		region.bufferOffset = 0;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = { extent.width, extent.height, 1 };
+
+		vkCmdCopyImageToBuffer(commandBuffer, accumulationImage_->Handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer->Handle(), 1, &region);
+	});
+
+	accumulatedColors.resize(count);
+
+	const auto data = stagingBufferMemory.Map(0, size);
+	std::memcpy(accumulatedColors.data(), data, size);
+	stagingBufferMemory.Unmap();
+
+	// Delete the buffer before the memory
+	stagingBuffer.reset();
 }
 
-void Application::CreateBottomLevelStructures(VkCommandBuffer commandBuffer)
+void Application::RecordImageReadback(VkCommandBuffer commandBuffer, const Buffer& accumulationBuffer, const Buffer& outputBuffer)
 {
-	const auto& scene = GetScene();
+	const auto extent = GetTraceExtent();
+
+	// The render graph knows which layouts Render() left them in.
+	renderGraph_->Use(commandBuffer, accumulationResource_, RenderGraph::Usage::TransferSrc, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	renderGraph_->Use(commandBuffer, outputResource_, RenderGraph::Usage::TransferSrc, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+	VkBufferImageCopy region = {};
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = { extent.width, extent.height, 1 };
+
+	vkCmdCopyImageToBuffer(commandBuffer, accumulationImage_->Handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, accumulationBuffer.Handle(), 1, &region);
+	vkCmdCopyImageToBuffer(commandBuffer, outputImage_->Handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, outputBuffer.Handle(), 1, &region);
+
+	// Make the copies visible to the host once the frame fence is signaled.
+	VkMemoryBarrier memoryBarrier = {};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+}
+
+bool Application::SupportsRayCounters() const
+{
+	return rayTracingProperties_->SupportsSubgroupOperations(
+		VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT,
+		VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR);
+}
+
+void Application::CreateBottomLevelStructures(VkCommandBuffer commandBuffer, AccelerationStructures& structures)
+{
+	const auto& scene = *structures.Scene;
 	const auto& debugUtils = Device().DebugUtils();
 	
 	// Bottom level acceleration structure
@@ -258,7 +649,7 @@ void Application::CreateBottomLevelStructures(VkCommandBuffer commandBuffer)
 			? geometries.AddGeometryAabb(scene, aabbOffset, 1, true)
 			: geometries.AddGeometryTriangles(scene, vertexOffset, vertexCount, indexOffset, indexCount, true);
 
-		bottomAs_.emplace_back(*deviceProcedures_, *rayTracingProperties_, geometries);
+		structures.BottomAs.emplace_back(*deviceProcedures_, *rayTracingProperties_, geometries);
 
 		vertexOffset += vertexCount * sizeof(Assets::Vertex);
 		indexOffset += indexCount * sizeof(uint32_t);
@@ -266,97 +657,126 @@ void Application::CreateBottomLevelStructures(VkCommandBuffer commandBuffer)
 	}
 
 	// Allocate the structures memory.
-	const auto total = GetTotalRequirements(bottomAs_);
+	const auto total = GetTotalRequirements(structures.BottomAs);
 
-	bottomBuffer_.reset(new Buffer(Device(), total.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT));
-	bottomBufferMemory_.reset(new DeviceMemory(bottomBuffer_->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
-	bottomScratchBuffer_.reset(new Buffer(Device(), total.buildScratchSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
-	bottomScratchBufferMemory_.reset(new DeviceMemory(bottomScratchBuffer_->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+	structures.BottomBuffer.reset(new Buffer(Device(), total.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT));
+	structures.BottomBufferMemory.reset(new DeviceMemory(structures.BottomBuffer->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+	structures.BottomScratchBuffer.reset(new Buffer(Device(), total.buildScratchSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+	structures.BottomScratchBufferMemory.reset(new DeviceMemory(structures.BottomScratchBuffer->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 
-	debugUtils.SetObjectName(bottomBuffer_->Handle(), "BLAS Buffer");
-	debugUtils.SetObjectName(bottomBufferMemory_->Handle(), "BLAS Memory");
-	debugUtils.SetObjectName(bottomScratchBuffer_->Handle(), "BLAS Scratch Buffer");
-	debugUtils.SetObjectName(bottomScratchBufferMemory_->Handle(), "BLAS Scratch Memory");
+	debugUtils.SetObjectName(structures.BottomBuffer->Handle(), "BLAS Buffer");
+	debugUtils.SetObjectName(structures.BottomBufferMemory->Handle(), "BLAS Memory");
+	debugUtils.SetObjectName(structures.BottomScratchBuffer->Handle(), "BLAS Scratch Buffer");
+	debugUtils.SetObjectName(structures.BottomScratchBufferMemory->Handle(), "BLAS Scratch Memory");
 
 	// Generate the structures.
 	VkDeviceSize resultOffset = 0;
 	VkDeviceSize scratchOffset = 0;
 
-	for (size_t i = 0; i != bottomAs_.size(); ++i)
+	for (size_t i = 0; i != structures.BottomAs.size(); ++i)
 	{
-		bottomAs_[i].Generate(commandBuffer, *bottomScratchBuffer_, scratchOffset, *bottomBuffer_, resultOffset);
+		structures.BottomAs[i].Generate(commandBuffer, *structures.BottomScratchBuffer, scratchOffset, *structures.BottomBuffer, resultOffset);
 		
-		resultOffset += bottomAs_[i].BuildSizes().accelerationStructureSize;
-		scratchOffset += bottomAs_[i].BuildSizes().buildScratchSize;
+		resultOffset += structures.BottomAs[i].BuildSizes().accelerationStructureSize;
+		scratchOffset += structures.BottomAs[i].BuildSizes().buildScratchSize;
 
-		debugUtils.SetObjectName(bottomAs_[i].Handle(), ("BLAS #" + std::to_string(i)).c_str());
+		debugUtils.SetObjectName(structures.BottomAs[i].Handle(), ("BLAS #" + std::to_string(i)).c_str());
 	}
 }
 
-void Application::CreateTopLevelStructures(VkCommandBuffer commandBuffer)
+void Application::CreateTopLevelStructures(VkCommandBuffer commandBuffer, AccelerationStructures& structures)
 {
-	const auto& scene = GetScene();
+	const auto& scene = *structures.Scene;
 	const auto& debugUtils = Device().DebugUtils();
 
 	// Top level acceleration structure
 	std::vector<VkAccelerationStructureInstanceKHR> instances;
 
-	// Hit group 0: triangles
-	// Hit group 1: procedurals
-	uint32_t instanceId = 0;
-
-	for (const auto& model : scene.Models())
+	// Each instance has its own hit group record, that of its geometry type and material model (see CreateHitGroups()).
+	for (uint32_t instanceId = 0; instanceId != scene.Models().size(); ++instanceId)
 	{
 		instances.push_back(TopLevelAccelerationStructure::CreateInstance(
-			bottomAs_[instanceId], glm::mat4(1), instanceId, model.Procedural() ? 1 : 0));
-		instanceId++;
+			structures.BottomAs[instanceId], glm::mat4(1), instanceId, instanceId));
 	}
 
-	// Create and copy instances buffer (do it in a separate one-time synchronous command buffer).
-	BufferUtil::CreateDeviceBuffer(CommandPool(), "TLAS Instances", VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, instances, instancesBuffer_, instancesBufferMemory_);
+	// Create and copy instances buffer (as part of the build command buffer).
+	BufferUtil::CreateDeviceBuffer(ComputeQueue(), commandBuffer, "TLAS Instances", VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, instances, structures.InstancesBuffer, structures.InstancesBufferMemory);
 
-	// Memory barrier for the bottom level acceleration structure builds.
+	// Memory barriers for the instances copy and the bottom level acceleration structure builds.
+	VkMemoryBarrier copyBarrier = {};
+	copyBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	copyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	copyBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &copyBarrier, 0, nullptr, 0, nullptr);
 	AccelerationStructure::MemoryBarrier(commandBuffer);
 	
-	topAs_.emplace_back(*deviceProcedures_, *rayTracingProperties_, instancesBuffer_->GetDeviceAddress(), static_cast<uint32_t>(instances.size()));
+	structures.TopAs.emplace_back(*deviceProcedures_, *rayTracingProperties_, structures.InstancesBuffer->GetDeviceAddress(), static_cast<uint32_t>(instances.size()));
 
 	// Allocate the structure memory.
-	const auto total = GetTotalRequirements(topAs_);
+	const auto total = GetTotalRequirements(structures.TopAs);
 
-	topBuffer_.reset(new Buffer(Device(), total.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR));
-	topBufferMemory_.reset(new DeviceMemory(topBuffer_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+	structures.TopBuffer.reset(new Buffer(Device(), total.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR));
+	structures.TopBufferMemory.reset(new DeviceMemory(structures.TopBuffer->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 
-	topScratchBuffer_.reset(new Buffer(Device(), total.buildScratchSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
-	topScratchBufferMemory_.reset(new DeviceMemory(topScratchBuffer_->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+	structures.TopScratchBuffer.reset(new Buffer(Device(), total.buildScratchSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+	structures.TopScratchBufferMemory.reset(new DeviceMemory(structures.TopScratchBuffer->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 
 	
-	debugUtils.SetObjectName(topBuffer_->Handle(), "TLAS Buffer");
-	debugUtils.SetObjectName(topBufferMemory_->Handle(), "TLAS Memory");
-	debugUtils.SetObjectName(topScratchBuffer_->Handle(), "TLAS Scratch Buffer");
-	debugUtils.SetObjectName(topScratchBufferMemory_->Handle(), "TLAS Scratch Memory");
-	debugUtils.SetObjectName(instancesBuffer_->Handle(), "TLAS Instances Buffer");
-	debugUtils.SetObjectName(instancesBufferMemory_->Handle(), "TLAS Instances Memory");
+	debugUtils.SetObjectName(structures.TopBuffer->Handle(), "TLAS Buffer");
+	debugUtils.SetObjectName(structures.TopBufferMemory->Handle(), "TLAS Memory");
+	debugUtils.SetObjectName(structures.TopScratchBuffer->Handle(), "TLAS Scratch Buffer");
+	debugUtils.SetObjectName(structures.TopScratchBufferMemory->Handle(), "TLAS Scratch Memory");
+	debugUtils.SetObjectName(structures.InstancesBuffer->Handle(), "TLAS Instances Buffer");
+	debugUtils.SetObjectName(structures.InstancesBufferMemory->Handle(), "TLAS Instances Memory");
 
 	// Generate the structures.
-	topAs_[0].Generate(commandBuffer, *topScratchBuffer_, 0, *topBuffer_, 0);
+	structures.TopAs[0].Generate(commandBuffer, *structures.TopScratchBuffer, 0, *structures.TopBuffer, 0);
 
-	debugUtils.SetObjectName(topAs_[0].Handle(), "TLAS");
+	debugUtils.SetObjectName(structures.TopAs[0].Handle(), "TLAS");
+}
+
+void Application::CreateRayTracingPipeline()
+{
+	Utilities::Tracer::Zone zone("CreateRayTracingPipeline");
+
+	// One cost bucket per material model, followed by one per instance.
+	costBuckets_.assign(Assets::Material::NumberOfModels + GetScene().Models().size(), {});
+	costCounters_.reset(new ShaderCounters(Device(), costBuckets_.size() * sizeof(CostBucket), FramesInFlight()));
+	hasCostBuckets_ = false;
+
+	AddSceneToHeap();
+
+	shaderBindingTables_.clear();
+	rayTracingPipeline_.reset(new RayTracingPipeline(*deviceProcedures_, PipelineCache(), accelerationStructures_->TopAs[0], *accumulationImageView_, *outputImageView_,
+		*historyImageViews_[0], *historyImageViews_[1], UniformBuffers(), *rayCounters_, *costCounters_, *bindlessHeap_));
 }
 
 void Application::CreateOutputImage()
 {
-	const auto extent = SwapChain().Extent();
+	// Large enough for both the ray tracing launch and the copy to the swap chain.
+	const auto traceExtent = GetTraceExtent();
+	const auto swapChainExtent = SwapChain().Extent();
+	const VkExtent2D extent = { std::max(traceExtent.width, swapChainExtent.width), std::max(traceExtent.height, swapChainExtent.height) };
 	const auto format = SwapChain().Format();
 	const auto tiling = VK_IMAGE_TILING_OPTIMAL;
 
-	accumulationImage_.reset(new Image(Device(), extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT));
+	accumulationImage_.reset(new Image(Device(), extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
 	accumulationImageMemory_.reset(new DeviceMemory(accumulationImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 	accumulationImageView_.reset(new ImageView(Device(), accumulationImage_->Handle(), VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT));
 
-	outputImage_.reset(new Image(Device(), extent, format, tiling, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
+	outputImage_.reset(new Image(Device(), extent, format, tiling, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
 	outputImageMemory_.reset(new DeviceMemory(outputImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 	outputImageView_.reset(new ImageView(Device(), outputImage_->Handle(), format, VK_IMAGE_ASPECT_COLOR_BIT));
 
+	// Half precision is plenty for reprojecting the colour and validating the hit distance.
+	for (size_t i = 0; i != historyImages_.size(); ++i)
+	{
+		historyImages_[i].reset(new Image(Device(), extent, VK_FORMAT_R16G16B16A16_SFLOAT, tiling, VK_IMAGE_USAGE_STORAGE_BIT));
+		historyImageMemories_[i].reset(new DeviceMemory(historyImages_[i]->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+		historyImageViews_[i].reset(new ImageView(Device(), historyImages_[i]->Handle(), VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT));
+	}
+
 	const auto& debugUtils = Device().DebugUtils();
 	
 	debugUtils.SetObjectName(accumulationImage_->Handle(), "Accumulation Image");
@@ -367,6 +787,141 @@ void Application::CreateOutputImage()
 	debugUtils.SetObjectName(outputImageMemory_->Handle(), "Output Image Memory");
 	debugUtils.SetObjectName(outputImageView_->Handle(), "Output ImageView");
 
+	for (size_t i = 0; i != historyImages_.size(); ++i)
+	{
+		debugUtils.SetObjectName(historyImages_[i]->Handle(), ("History Image #" + std::to_string(i)).c_str());
+		debugUtils.SetObjectName(historyImageMemories_[i]->Handle(), ("History Image Memory #" + std::to_string(i)).c_str());
+		debugUtils.SetObjectName(historyImageViews_[i]->Handle(), ("History ImageView #" + std::to_string(i)).c_str());
+	}
+
+}
+
+void Application::CreateRenderGraph()
+{
+	typedef RenderGraph::Usage Usage;
+
+	renderGraph_.reset(new RenderGraph(Device()));
+	auto& graph = *renderGraph_;
+
+	accumulationResource_ = graph.ImportImage("Accumulation", accumulationImage_->Handle());
+	outputResource_ = graph.ImportImage("Output", outputImage_->Handle());
+
+	for (size_t i = 0; i != historyImages_.size(); ++i)
+	{
+		historyResources_[i] = graph.ImportImage(("History #" + std::to_string(i)).c_str(), historyImages_[i]->Handle());
+	}
+
+	// Set to the acquired image every frame.
+	swapChainResource_ = graph.ImportImage("Swap Chain", nullptr);
+
+	// The upscaled output always matches the swap chain.
+	upscaledResource_ = graph.CreateImage("Upscaled", SwapChain().Extent(), SwapChain().Format(), VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+
+	const auto isUpscaled = [this]() { return GetRenderScale() < 1; };
+	const auto isCopied = [this]() { return GetRenderScale() >= 1; };
+
+	// Once converged, the output image still holds the last trace.
+	graph.AddPass("Trace", VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+		{
+			{ accumulationResource_, Usage::StorageReadWrite },
+			{ outputResource_, Usage::StorageWrite },
+			{ historyResources_[0], Usage::StorageReadWrite },
+			{ historyResources_[1], Usage::StorageReadWrite }
+		},
+		[this]() { return !IsConverged(); },
+		[this](VkCommandBuffer commandBuffer, const uint32_t frameIndex)
+		{
+			RecordTrace(commandBuffer, frameIndex, GetTraceExtent());
+		});
+
+	// Upscale the output image, then copy the result into the swap-chain image.
+	graph.AddPass("Upscale", VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		{ { outputResource_, Usage::Sampled }, { upscaledResource_, Usage::StorageWrite } },
+		isUpscaled,
+		[this](VkCommandBuffer commandBuffer, uint32_t)
+		{
+			upscalePipeline_->Record(commandBuffer, GetTraceExtent(), SwapChain().Extent(), UpscaleSharpness);
+		});
+
+	graph.AddPass("Copy Upscaled", VK_PIPELINE_STAGE_TRANSFER_BIT,
+		{ { upscaledResource_, Usage::TransferSrc }, { swapChainResource_, Usage::TransferDst } },
+		isUpscaled,
+		[this](VkCommandBuffer commandBuffer, uint32_t)
+		{
+			CopyImage(commandBuffer, renderGraph_->GetImage(upscaledResource_), renderGraph_->GetImage(swapChainResource_), SwapChain().Extent());
+		});
+
+	// Clear whatever part of the swap-chain image the launch does not cover.
+	graph.AddPass("Clear", VK_PIPELINE_STAGE_TRANSFER_BIT,
+		{ { swapChainResource_, Usage::TransferDst } },
+		[this]()
+		{
+			const auto extent = GetTraceExtent();
+			const auto swapChainExtent = SwapChain().Extent();
+			return GetRenderScale() >= 1 && (extent.width < swapChainExtent.width || extent.height < swapChainExtent.height);
+		},
+		[this](VkCommandBuffer commandBuffer, uint32_t)
+		{
+			VkImageSubresourceRange subresourceRange = {};
+			subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			subresourceRange.baseMipLevel = 0;
+			subresourceRange.levelCount = 1;
+			subresourceRange.baseArrayLayer = 0;
+			subresourceRange.layerCount = 1;
+
+			const VkClearColorValue clearColor = { {0.0f, 0.0f, 0.0f, 1.0f} };
+
+			vkCmdClearColorImage(commandBuffer, renderGraph_->GetImage(swapChainResource_), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor, 1, &subresourceRange);
+		});
+
+	// Copy output image into swap-chain image.
+	graph.AddPass("Copy", VK_PIPELINE_STAGE_TRANSFER_BIT,
+		{ { outputResource_, Usage::TransferSrc }, { swapChainResource_, Usage::TransferDst } },
+		isCopied,
+		[this](VkCommandBuffer commandBuffer, uint32_t)
+		{
+			const auto extent = GetTraceExtent();
+			const auto swapChainExtent = SwapChain().Extent();
+
+			CopyImage(commandBuffer, outputImage_->Handle(), renderGraph_->GetImage(swapChainResource_),
+				{ std::min(extent.width, swapChainExtent.width), std::min(extent.height, swapChainExtent.height) });
+		});
+
+	graph.AddPass("Present", VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		{ { swapChainResource_, Usage::Present } },
+		nullptr,
+		nullptr);
+
+	graph.Compile();
+}
+
+void Application::AddSceneToHeap()
+{
+	const auto& scene = GetScene();
+
+	textureStreamer_.reset(new Assets::TextureStreamer(TransferQueue(), GraphicsQueue(), *bindlessHeap_, scene, FramesInFlight(), TextureStreamingBudget));
+
+	finestLevelsRequested_ = false;
+
+	sceneSlots_.TextureResidencyBuffer = textureStreamer_->ResidencyBuffer();
+	sceneSlots_.TextureFeedbackBuffer = textureStreamer_->FeedbackBuffer();
+
+	// The geometry is reached through the hit group records, only the models with several materials need the scene ones.
+	sceneSlots_.MaterialBuffer = bindlessHeap_->AddBuffer(scene.MaterialBuffer().Handle());
+	sceneBufferSlots_ = { sceneSlots_.MaterialBuffer };
+}
+
+void Application::RemoveSceneFromHeap()
+{
+	textureStreamer_.reset();
+
+	for (const auto slot : sceneBufferSlots_)
+	{
+		bindlessHeap_->RemoveBuffer(slot);
+	}
+
+	sceneSlots_ = {};
+	sceneBufferSlots_.clear();
 }
 
 }
@@ -1,10 +1,23 @@
 #pragma once
 
 #include "Vulkan/Application.hpp"
+#include "Vulkan/RenderGraph.hpp"
+#include "RayTracingPipeline.hpp"
 #include "RayTracingProperties.hpp"
+#include "ShaderCounters.hpp"
+#include "ShaderVariant.hpp"
+#include <array>
+#include <map>
+#include <vector>
+
+namespace Assets
+{
+	class TextureStreamer;
+}
 
 namespace Vulkan
 {
+	class BindlessHeap;
 	class CommandBuffers;
 	class Buffer;
 	class DeviceMemory;
@@ -22,7 +35,7 @@ namespace Vulkan::RayTracing
 
 	protected:
 
-		Application(const WindowConfig& windowConfig, VkPresentModeKHR presentMode, bool enableValidationLayers);
+		Application(const WindowConfig& windowConfig, VkPresentModeKHR presentMode, uint32_t framesInFlight, bool enableValidationLayers);
 		~Application();
 
 		void SetPhysicalDevice(VkPhysicalDevice physicalDevice,
@@ -30,34 +43,81 @@ namespace Vulkan::RayTracing
 			VkPhysicalDeviceFeatures& deviceFeatures,
 			void* nextDeviceFeatures) override;
 		
+		virtual ShaderVariant GetShaderVariant() const = 0;
+
+		// The size of the ray tracing launch, which can differ from the swap chain when rendering a larger image tile by tile.
+		// By default, the swap chain extent scaled by the render scale.
+		virtual VkExtent2D GetTraceExtent() const;
+
+		// The per axis render scale, the launch is then upscaled onto the swap chain rather than copied as is.
+		virtual float GetRenderScale() const { return 1.0f; }
+
+		// The accumulation already holds all its samples: the trace is skipped and its last output presented again.
+		virtual bool IsConverged() const { return false; }
+
 		void OnDeviceSet() override;
-		void CreateAccelerationStructures();
+
+		// Build the acceleration structures of the next scene on the compute queue once its geometry is uploaded, without
+		// waiting for them: the current scene keeps being traced meanwhile. Only one build at a time.
+		void BuildAccelerationStructures(const Assets::Scene& scene);
+		bool IsBuildingAccelerationStructures() const { return static_cast<bool>(nextAccelerationStructures_); }
+		bool AreAccelerationStructuresBuilt();
+
+		// Hand the next scene over to the graphics queue and trace its structures from the next frame on, blocking until
+		// they are built if need be. The previous structures are retired (see Vulkan::Application::Retire()), and so must
+		// the previous scene be. The pipelines are then to be recreated (see RecreatePipelines()).
+		void SwitchAccelerationStructures();
 		void DeleteAccelerationStructures();
+
 		void CreateSwapChain() override;
 		void DeleteSwapChain() override;
-		void Render(VkCommandBuffer commandBuffer, uint32_t imageIndex) override;
+		void DeletePipelines() override;
+		void RecreatePipelines() override;
+		void Render(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex) override;
+
+		// Rasterize the scene (see Vulkan::Application::Render()) with the streamed textures. Without any shader feedback,
+		// the finest levels of all the textures are requested once when switching to rasterization, as far as the streaming
+		// budget allows.
+		void Rasterize(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex);
+
+		// Blocking readback of the RGBA accumulation image (i.e. the sum of all the samples).
+		void ReadAccumulationImage(VkExtent2D extent, std::vector<float>& accumulatedColors);
+
+		// Record the copy of the accumulation and output images into host-visible buffers, following Render().
+		void RecordImageReadback(VkCommandBuffer commandBuffer, const Buffer& accumulationBuffer, const Buffer& outputBuffer);
+
+		// Counting the rays requires subgroup arithmetic in the ray generation and intersection shaders (see ShaderVariant::CountRays).
+		bool SupportsRayCounters() const;
+
+		// The ray counts of the previous use of the current frame slot (i.e. frames in flight ago), false when it did not count them.
+		bool HasRayStatistics() const { return hasRayStatistics_; }
+		const RayStatistics& LastRayStatistics() const { return rayStatistics_; }
+
+		// The per material model then per instance shader costs of the previous use of the current frame slot
+		// (see ShaderVariant::ProfileCosts), false when it did not profile them.
+		bool HasCostBuckets() const { return hasCostBuckets_; }
+		const std::vector<CostBucket>& LastCostBuckets() const { return costBuckets_; }
 			   
 	private:
 
-		void CreateBottomLevelStructures(VkCommandBuffer commandBuffer);
-		void CreateTopLevelStructures(VkCommandBuffer commandBuffer);
+		struct AccelerationStructures;
+
+		void CreateBottomLevelStructures(VkCommandBuffer commandBuffer, AccelerationStructures& structures);
+		void CreateTopLevelStructures(VkCommandBuffer commandBuffer, AccelerationStructures& structures);
+		void CreateRayTracingPipeline();
 		void CreateOutputImage();
+		void CreateRenderGraph();
+		void AddSceneToHeap();
+		void RemoveSceneFromHeap();
+		void RecordTrace(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkExtent2D extent);
+		static void CopyImage(VkCommandBuffer commandBuffer, VkImage source, VkImage swapChainImage, VkExtent2D extent);
 
 		std::unique_ptr<class DeviceProcedures> deviceProcedures_;
 		std::unique_ptr<class RayTracingProperties> rayTracingProperties_;
 
-		std::vector<class BottomLevelAccelerationStructure> bottomAs_;
-		std::unique_ptr<Buffer> bottomBuffer_;
-		std::unique_ptr<DeviceMemory> bottomBufferMemory_;
-		std::unique_ptr<Buffer> bottomScratchBuffer_;
-		std::unique_ptr<DeviceMemory> bottomScratchBufferMemory_;
-		std::vector<class TopLevelAccelerationStructure> topAs_;
-		std::unique_ptr<Buffer> topBuffer_;
-		std::unique_ptr<DeviceMemory> topBufferMemory_;
-		std::unique_ptr<Buffer> topScratchBuffer_;
-		std::unique_ptr<DeviceMemory> topScratchBufferMemory_;
-		std::unique_ptr<Buffer> instancesBuffer_;
-		std::unique_ptr<DeviceMemory> instancesBufferMemory_;
+		// The structures of the traced scene, and those of the next one while they are being built.
+		std::unique_ptr<AccelerationStructures> accelerationStructures_;
+		std::unique_ptr<AccelerationStructures> nextAccelerationStructures_;
 
 		std::unique_ptr<Image> accumulationImage_;
 		std::unique_ptr<DeviceMemory> accumulationImageMemory_;
@@ -66,9 +126,40 @@ namespace Vulkan::RayTracing
 		std::unique_ptr<Image> outputImage_;
 		std::unique_ptr<DeviceMemory> outputImageMemory_;
 		std::unique_ptr<ImageView> outputImageView_;
+
+		// Colour and primary hit distance of the previous frames, alternately written and read by the ray generation shader.
+		std::array<std::unique_ptr<Image>, 2> historyImages_;
+		std::array<std::unique_ptr<DeviceMemory>, 2> historyImageMemories_;
+		std::array<std::unique_ptr<ImageView>, 2> historyImageViews_;
+
+		std::unique_ptr<class UpscalePipeline> upscalePipeline_;
+
+		// The frame passes, from the trace to the present, and their images (the upscaled one being transient).
+		std::unique_ptr<RenderGraph> renderGraph_;
+		RenderGraph::ResourceId accumulationResource_{};
+		RenderGraph::ResourceId outputResource_{};
+		std::array<RenderGraph::ResourceId, 2> historyResources_{};
+		RenderGraph::ResourceId upscaledResource_{};
+		RenderGraph::ResourceId swapChainResource_{};
 		
-		std::unique_ptr<class RayTracingPipeline> rayTracingPipeline_;
-		std::unique_ptr<class ShaderBindingTable> shaderBindingTable_;
+		std::unique_ptr<ShaderCounters> rayCounters_;
+		RayStatistics rayStatistics_{};
+		bool hasRayStatistics_{};
+
+		std::unique_ptr<ShaderCounters> costCounters_;
+		std::vector<CostBucket> costBuckets_;
+		bool hasCostBuckets_{};
+
+		// The scene textures and buffers are added to the heap along with the pipeline, and removed with it.
+		// The textures are streamed, one copy per frame in flight.
+		std::unique_ptr<BindlessHeap> bindlessHeap_;
+		std::unique_ptr<Assets::TextureStreamer> textureStreamer_;
+		RayTracingPipeline::SceneSlots sceneSlots_{};
+		std::vector<uint32_t> sceneBufferSlots_;
+		bool finestLevelsRequested_{};
+
+		std::unique_ptr<RayTracingPipeline> rayTracingPipeline_;
+		std::map<ShaderVariant, std::unique_ptr<class ShaderBindingTable>> shaderBindingTables_;
 	};
 
 }
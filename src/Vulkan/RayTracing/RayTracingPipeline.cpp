@@ -1,33 +1,66 @@
 #include "RayTracingPipeline.hpp"
 #include "DeviceProcedures.hpp"
+#include "ShaderCounters.hpp"
 #include "TopLevelAccelerationStructure.hpp"
-#include "Assets/Scene.hpp"
 #include "Assets/UniformBuffer.hpp"
 #include "Utilities/Exception.hpp"
+#include "Utilities/Tracer.hpp"
+#include "Vulkan/BindlessHeap.hpp"
 #include "Vulkan/Buffer.hpp"
 #include "Vulkan/Device.hpp"
 #include "Vulkan/DescriptorBinding.hpp"
 #include "Vulkan/DescriptorSetManager.hpp"
 #include "Vulkan/DescriptorSets.hpp"
 #include "Vulkan/ImageView.hpp"
+#include "Vulkan/PipelineCache.hpp"
 #include "Vulkan/PipelineLayout.hpp"
 #include "Vulkan/ShaderModule.hpp"
-#include "Vulkan/SwapChain.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
 
 namespace Vulkan::RayTracing {
 
+namespace
+{
+	VkRayTracingShaderGroupCreateInfoKHR CreateShaderGroup(
+		const VkRayTracingShaderGroupTypeKHR type, const uint32_t generalShader, const uint32_t closestHitShader, const uint32_t intersectionShader)
+	{
+		VkRayTracingShaderGroupCreateInfoKHR groupInfo = {};
+		groupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
+		groupInfo.pNext = nullptr;
+		groupInfo.type = type;
+		groupInfo.generalShader = generalShader;
+		groupInfo.closestHitShader = closestHitShader;
+		groupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
+		groupInfo.intersectionShader = intersectionShader;
+
+		return groupInfo;
+	}
+
+	// The HitGroupMaterialModel specialization constant value for any material model (see Specialization.glsl).
+	const uint32_t MaterialModelAny = 0xffffffff;
+}
+
 RayTracingPipeline::RayTracingPipeline(
 	const DeviceProcedures& deviceProcedures,
-	const SwapChain& swapChain,
+	const PipelineCache& pipelineCache,
 	const TopLevelAccelerationStructure& accelerationStructure,
 	const ImageView& accumulationImageView,
 	const ImageView& outputImageView,
+	const ImageView& historyImageView0,
+	const ImageView& historyImageView1,
 	const std::vector<Assets::UniformBuffer>& uniformBuffers,
-	const Assets::Scene& scene) :
-	swapChain_(swapChain)
+	const ShaderCounters& rayCounters,
+	const ShaderCounters& costCounters,
+	const BindlessHeap& bindlessHeap) :
+	deviceProcedures_(deviceProcedures),
+	pipelineCache_(pipelineCache),
+	device_(deviceProcedures.Device())
 {
 	// Create descriptor pool/sets.
-	const auto& device = swapChain.Device();
+	const auto& device = deviceProcedures.Device();
 	const std::vector<DescriptorBinding> descriptorBindings =
 	{
 		// Top level acceleration structure.
@@ -38,26 +71,26 @@ RayTracingPipeline::RayTracingPipeline(
 		{2, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
 
 		// Camera information & co
-		{3, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR},
+		{3, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+
+		// The scene buffers and textures come from the bindless heap (set 1).
 
-		// Vertex buffer, Index buffer, Material buffer, Offset buffer
-		{4, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
-		{5, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
-		{6, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
-		{7, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+		// Ray counters
+		{10, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR},
 
-		// Textures and image samplers
-		{8, static_cast<uint32_t>(scene.TextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+		// Cost counters
+		{11, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR},
 
-		// The Procedural buffer.
-		{9, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR}
+		// History images (interleaved tracing)
+		{12, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+		{13, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR}
 	};
 
 	descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
 
 	auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
-	for (uint32_t i = 0; i != swapChain.Images().size(); ++i)
+	for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
 	{
 		// Top level acceleration structure.
 		const auto accelerationStructureHandle = accelerationStructure.Handle();
@@ -67,147 +100,177 @@ RayTracingPipeline::RayTracingPipeline(
 		structureInfo.accelerationStructureCount = 1;
 		structureInfo.pAccelerationStructures = &accelerationStructureHandle;
 
-		// Accumulation image
-		VkDescriptorImageInfo accumulationImageInfo = {};
-		accumulationImageInfo.imageView = accumulationImageView.Handle();
-		accumulationImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-
-		// Output image
-		VkDescriptorImageInfo outputImageInfo = {};
-		outputImageInfo.imageView = outputImageView.Handle();
-		outputImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-
 		// Uniform buffer
 		VkDescriptorBufferInfo uniformBufferInfo = {};
 		uniformBufferInfo.buffer = uniformBuffers[i].Buffer().Handle();
 		uniformBufferInfo.range = VK_WHOLE_SIZE;
 
-		// Vertex buffer
-		VkDescriptorBufferInfo vertexBufferInfo = {};
-		vertexBufferInfo.buffer = scene.VertexBuffer().Handle();
-		vertexBufferInfo.range = VK_WHOLE_SIZE;
-
-		// Index buffer
-		VkDescriptorBufferInfo indexBufferInfo = {};
-		indexBufferInfo.buffer = scene.IndexBuffer().Handle();
-		indexBufferInfo.range = VK_WHOLE_SIZE;
+		// Ray counters buffer
+		VkDescriptorBufferInfo rayCountersBufferInfo = {};
+		rayCountersBufferInfo.buffer = rayCounters.Buffer().Handle();
+		rayCountersBufferInfo.range = VK_WHOLE_SIZE;
 
-		// Material buffer
-		VkDescriptorBufferInfo materialBufferInfo = {};
-		materialBufferInfo.buffer = scene.MaterialBuffer().Handle();
-		materialBufferInfo.range = VK_WHOLE_SIZE;
+		// Cost counters buffer
+		VkDescriptorBufferInfo costCountersBufferInfo = {};
+		costCountersBufferInfo.buffer = costCounters.Buffer().Handle();
+		costCountersBufferInfo.range = VK_WHOLE_SIZE;
 
-		// Offsets buffer
-		VkDescriptorBufferInfo offsetsBufferInfo = {};
-		offsetsBufferInfo.buffer = scene.OffsetsBuffer().Handle();
-		offsetsBufferInfo.range = VK_WHOLE_SIZE;
-
-		// Image and texture samplers.
-		std::vector<VkDescriptorImageInfo> imageInfos(scene.TextureSamplers().size());
-
-		for (size_t t = 0; t != imageInfos.size(); ++t)
-		{
-			auto& imageInfo = imageInfos[t];
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = scene.TextureImageViews()[t];
-			imageInfo.sampler = scene.TextureSamplers()[t];
-		}
-
-		std::vector<VkWriteDescriptorSet> descriptorWrites =
+		const std::vector<VkWriteDescriptorSet> descriptorWrites =
 		{
 			descriptorSets.Bind(i, 0, structureInfo),
-			descriptorSets.Bind(i, 1, accumulationImageInfo),
-			descriptorSets.Bind(i, 2, outputImageInfo),
 			descriptorSets.Bind(i, 3, uniformBufferInfo),
-			descriptorSets.Bind(i, 4, vertexBufferInfo),
-			descriptorSets.Bind(i, 5, indexBufferInfo),
-			descriptorSets.Bind(i, 6, materialBufferInfo),
-			descriptorSets.Bind(i, 7, offsetsBufferInfo),
-			descriptorSets.Bind(i, 8, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size()))
+			descriptorSets.Bind(i, 10, rayCountersBufferInfo),
+			descriptorSets.Bind(i, 11, costCountersBufferInfo)
 		};
 
-		// Procedural buffer (optional)
-		VkDescriptorBufferInfo proceduralBufferInfo = {};
-		
-		if (scene.HasProcedurals())
-		{
-			proceduralBufferInfo.buffer = scene.ProceduralBuffer().Handle();
-			proceduralBufferInfo.range = VK_WHOLE_SIZE;
+		descriptorSets.UpdateDescriptors(i, descriptorWrites);
+	}
 
-			descriptorWrites.push_back(descriptorSets.Bind(i, 9, proceduralBufferInfo));
-		}
+	// The output images are recreated along with the swap chain.
+	UpdateDescriptorSets(accumulationImageView, outputImageView, historyImageView0, historyImageView1);
 
-		descriptorSets.UpdateDescriptors(i, descriptorWrites);
+	const VkPushConstantRange sceneSlotsRange = { SceneSlotsStages, 0, sizeof(SceneSlots) };
+
+	pipelineLayout_.reset(new class PipelineLayout(device, { &descriptorSetManager_->DescriptorSetLayout(), &bindlessHeap.DescriptorSetLayout() }, { sceneSlotsRange }));
+
+	// Load shaders. The pipelines themselves are only created when a variant is first requested.
+	rayGenShader_.reset(new ShaderModule(device, "../assets/shaders/RayTracing.rgen.spv"));
+	missShader_.reset(new ShaderModule(device, "../assets/shaders/RayTracing.rmiss.spv"));
+	closestHitShader_.reset(new ShaderModule(device, "../assets/shaders/RayTracing.rchit.spv"));
+	proceduralClosestHitShader_.reset(new ShaderModule(device, "../assets/shaders/RayTracing.Procedural.rchit.spv"));
+	proceduralIntersectionShader_.reset(new ShaderModule(device, "../assets/shaders/RayTracing.Procedural.rint.spv"));
+
+	// Shader groups: ray generation, miss, then the triangle and procedural hit groups (see HitGroupsPerGeometry).
+	// The groups themselves are created along with each pipeline variant, as their shader stages depend on it.
+	rayGenIndex_ = 0;
+	missIndex_ = 1;
+	triangleHitGroupIndex_ = 2;
+	proceduralHitGroupIndex_ = triangleHitGroupIndex_ + HitGroupsPerGeometry;
+}
+
+RayTracingPipeline::~RayTracingPipeline()
+{
+	for (auto& pipeline : pipelines_)
+	{
+		vkDestroyPipeline(device_.Handle(), pipeline.second, nullptr);
 	}
 
-	pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
+	pipelines_.clear();
 
-	// Load shaders.
-	const ShaderModule rayGenShader(device, "../assets/shaders/RayTracing.rgen.spv");
-	const ShaderModule missShader(device, "../assets/shaders/RayTracing.rmiss.spv");
-	const ShaderModule closestHitShader(device, "../assets/shaders/RayTracing.rchit.spv");
-	const ShaderModule proceduralClosestHitShader(device, "../assets/shaders/RayTracing.Procedural.rchit.spv");
-	const ShaderModule proceduralIntersectionShader(device, "../assets/shaders/RayTracing.Procedural.rint.spv");
+	proceduralIntersectionShader_.reset();
+	proceduralClosestHitShader_.reset();
+	closestHitShader_.reset();
+	missShader_.reset();
+	rayGenShader_.reset();
+	pipelineLayout_.reset();
+	descriptorSetManager_.reset();
+}
 
-	std::vector<VkPipelineShaderStageCreateInfo> shaderStages =
+VkPipeline RayTracingPipeline::Handle(const ShaderVariant& variant)
+{
+	const auto cached = pipelines_.find(variant);
+
+	if (cached != pipelines_.end())
 	{
-		rayGenShader.CreateShaderStage(VK_SHADER_STAGE_RAYGEN_BIT_KHR),
-		missShader.CreateShaderStage(VK_SHADER_STAGE_MISS_BIT_KHR),
-		closestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR),
-		proceduralClosestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR),
-		proceduralIntersectionShader.CreateShaderStage(VK_SHADER_STAGE_INTERSECTION_BIT_KHR)
+		return cached->second;
+	}
+
+	Utilities::Tracer::Zone zone("CompileRayTracingPipeline");
+
+	std::cout << "- compiling ray tracing pipeline variant (heatmap: " << variant.ShowHeatmap << ", sky: " << variant.HasSky;
+	std::cout << ", textures: " << variant.HasTextures << ", bounces: " << variant.NumberOfBounces << ", ray counters: " << variant.CountRays << ", costs: " << variant.ProfileCosts;
+	std::cout << ", material hit groups: " << variant.MaterialHitGroups << ")... " << std::flush;
+	const auto timer = std::chrono::high_resolution_clock::now();
+
+	// Specialization constants (see Specialization.glsl), the same for all stages but for the material model of the
+	// closest-hit shaders. The last one, for any material model, is also used by the other stages.
+	struct SpecializationData
+	{
+		VkBool32 ShowHeatmap;
+		VkBool32 HasSky;
+		VkBool32 HasTextures;
+		uint32_t NumberOfBounces;
+		VkBool32 CountRays;
+		VkBool32 ProfileCosts;
+		uint32_t HitGroupMaterialModel;
 	};
 
-	// Shader groups
-	VkRayTracingShaderGroupCreateInfoKHR rayGenGroupInfo = {};
-	rayGenGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
-	rayGenGroupInfo.pNext = nullptr;
-	rayGenGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
-	rayGenGroupInfo.generalShader = 0;
-	rayGenGroupInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
-	rayGenGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-	rayGenGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-	rayGenIndex_ = 0;
+	const std::array<VkSpecializationMapEntry, 7> specializationEntries =
+	{{
+		{0, offsetof(SpecializationData, ShowHeatmap), sizeof(VkBool32)},
+		{1, offsetof(SpecializationData, HasSky), sizeof(VkBool32)},
+		{2, offsetof(SpecializationData, HasTextures), sizeof(VkBool32)},
+		{3, offsetof(SpecializationData, NumberOfBounces), sizeof(uint32_t)},
+		{4, offsetof(SpecializationData, CountRays), sizeof(VkBool32)},
+		{5, offsetof(SpecializationData, ProfileCosts), sizeof(VkBool32)},
+		{6, offsetof(SpecializationData, HitGroupMaterialModel), sizeof(uint32_t)}
+	}};
+
+	std::array<SpecializationData, HitGroupsPerGeometry> specializationData = {};
+	std::array<VkSpecializationInfo, HitGroupsPerGeometry> specializationInfos = {};
+
+	for (uint32_t i = 0; i != HitGroupsPerGeometry; ++i)
+	{
+		specializationData[i] =
+		{
+			variant.ShowHeatmap,
+			variant.HasSky,
+			variant.HasTextures,
+			variant.NumberOfBounces,
+			variant.CountRays,
+			variant.ProfileCosts,
+			i != AnyMaterialModel ? i : MaterialModelAny
+		};
 
-	VkRayTracingShaderGroupCreateInfoKHR missGroupInfo = {};
-	missGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
-	missGroupInfo.pNext = nullptr;
-	missGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
-	missGroupInfo.generalShader = 1;
-	missGroupInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
-	missGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-	missGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-	missIndex_ = 1;
+		specializationInfos[i].mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+		specializationInfos[i].pMapEntries = specializationEntries.data();
+		specializationInfos[i].dataSize = sizeof(SpecializationData);
+		specializationInfos[i].pData = &specializationData[i];
+	}
 
-	VkRayTracingShaderGroupCreateInfoKHR triangleHitGroupInfo = {};
-	triangleHitGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
-	triangleHitGroupInfo.pNext = nullptr;
-	triangleHitGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR;
-	triangleHitGroupInfo.generalShader = VK_SHADER_UNUSED_KHR;
-	triangleHitGroupInfo.closestHitShader = 2;
-	triangleHitGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-	triangleHitGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-	triangleHitGroupIndex_ = 2;
+	std::vector<VkPipelineShaderStageCreateInfo> shaderStages =
+	{
+		rayGenShader_->CreateShaderStage(VK_SHADER_STAGE_RAYGEN_BIT_KHR),
+		missShader_->CreateShaderStage(VK_SHADER_STAGE_MISS_BIT_KHR),
+		proceduralIntersectionShader_->CreateShaderStage(VK_SHADER_STAGE_INTERSECTION_BIT_KHR)
+	};
+
+	for (auto& shaderStage : shaderStages)
+	{
+		shaderStage.pSpecializationInfo = &specializationInfos[AnyMaterialModel];
+	}
 
-	VkRayTracingShaderGroupCreateInfoKHR proceduralHitGroupInfo = {};
-	proceduralHitGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
-	proceduralHitGroupInfo.pNext = nullptr;
-	proceduralHitGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_PROCEDURAL_HIT_GROUP_KHR;
-	proceduralHitGroupInfo.generalShader = VK_SHADER_UNUSED_KHR;
-	proceduralHitGroupInfo.closestHitShader = 3;
-	proceduralHitGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-	proceduralHitGroupInfo.intersectionShader = 4;
-	proceduralHitGroupIndex_ = 3;
+	const uint32_t intersectionStage = 2;
 
 	std::vector<VkRayTracingShaderGroupCreateInfoKHR> groups =
 	{
-		rayGenGroupInfo, 
-		missGroupInfo, 
-		triangleHitGroupInfo, 
-		proceduralHitGroupInfo,
+		CreateShaderGroup(VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR, 0, VK_SHADER_UNUSED_KHR, VK_SHADER_UNUSED_KHR),
+		CreateShaderGroup(VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR, 1, VK_SHADER_UNUSED_KHR, VK_SHADER_UNUSED_KHR)
+	};
+
+	// A closest-hit stage specialized per material model, or a single one switching on the material (the megashader).
+	const auto addHitGroups = [&](const ShaderModule& closestHitShader, const VkRayTracingShaderGroupTypeKHR type, const uint32_t intersectionShader)
+	{
+		const auto firstStage = static_cast<uint32_t>(shaderStages.size());
+		const uint32_t stageCount = variant.MaterialHitGroups ? HitGroupsPerGeometry : 1;
+
+		for (uint32_t i = 0; i != stageCount; ++i)
+		{
+			auto shaderStage = closestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR);
+			shaderStage.pSpecializationInfo = &specializationInfos[variant.MaterialHitGroups ? i : AnyMaterialModel];
+			shaderStages.push_back(shaderStage);
+		}
+
+		for (uint32_t i = 0; i != HitGroupsPerGeometry; ++i)
+		{
+			groups.push_back(CreateShaderGroup(type, VK_SHADER_UNUSED_KHR, firstStage + (variant.MaterialHitGroups ? i : 0), intersectionShader));
+		}
 	};
 
-	// Create graphic pipeline
+	addHitGroups(*closestHitShader_, VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR, VK_SHADER_UNUSED_KHR);
+	addHitGroups(*proceduralClosestHitShader_, VK_RAY_TRACING_SHADER_GROUP_TYPE_PROCEDURAL_HIT_GROUP_KHR, intersectionStage);
+
+	// Create ray tracing pipeline
 	VkRayTracingPipelineCreateInfoKHR pipelineInfo = {};
 	pipelineInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR;
 	pipelineInfo.pNext = nullptr;
@@ -221,20 +284,58 @@ RayTracingPipeline::RayTracingPipeline(
 	pipelineInfo.basePipelineHandle = nullptr;
 	pipelineInfo.basePipelineIndex = 0;
 
-	Check(deviceProcedures.vkCreateRayTracingPipelinesKHR(device.Handle(), nullptr, nullptr, 1, &pipelineInfo, nullptr, &pipeline_), 
+	VkPipeline pipeline = nullptr;
+
+	Check(deviceProcedures_.vkCreateRayTracingPipelinesKHR(device_.Handle(), nullptr, pipelineCache_.Handle(), 1, &pipelineInfo, nullptr, &pipeline), 
 		"create ray tracing pipeline");
+
+	pipelines_.emplace(variant, pipeline);
+
+	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+	std::cout << elapsed << "s" << std::endl;
+
+	return pipeline;
 }
 
-RayTracingPipeline::~RayTracingPipeline()
+void RayTracingPipeline::UpdateDescriptorSets(
+	const ImageView& accumulationImageView,
+	const ImageView& outputImageView,
+	const ImageView& historyImageView0,
+	const ImageView& historyImageView1)
 {
-	if (pipeline_ != nullptr)
+	auto& descriptorSets = descriptorSetManager_->DescriptorSets();
+
+	for (uint32_t i = 0; i != descriptorSets.Size(); ++i)
 	{
-		vkDestroyPipeline(swapChain_.Device().Handle(), pipeline_, nullptr);
-		pipeline_ = nullptr;
-	}
+		// Accumulation image
+		VkDescriptorImageInfo accumulationImageInfo = {};
+		accumulationImageInfo.imageView = accumulationImageView.Handle();
+		accumulationImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
 
-	pipelineLayout_.reset();
-	descriptorSetManager_.reset();
+		// Output image
+		VkDescriptorImageInfo outputImageInfo = {};
+		outputImageInfo.imageView = outputImageView.Handle();
+		outputImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+		// History images
+		VkDescriptorImageInfo historyImageInfo0 = {};
+		historyImageInfo0.imageView = historyImageView0.Handle();
+		historyImageInfo0.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+		VkDescriptorImageInfo historyImageInfo1 = {};
+		historyImageInfo1.imageView = historyImageView1.Handle();
+		historyImageInfo1.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+		const std::vector<VkWriteDescriptorSet> descriptorWrites =
+		{
+			descriptorSets.Bind(i, 1, accumulationImageInfo),
+			descriptorSets.Bind(i, 2, outputImageInfo),
+			descriptorSets.Bind(i, 12, historyImageInfo0),
+			descriptorSets.Bind(i, 13, historyImageInfo1)
+		};
+
+		descriptorSets.UpdateDescriptors(i, descriptorWrites);
+	}
 }
 
 VkDescriptorSet RayTracingPipeline::DescriptorSet(const uint32_t index) const
@@ -1,26 +1,32 @@
 #pragma once
 
+#include "ShaderVariant.hpp"
+#include "Assets/Material.hpp"
 #include "Vulkan/Vulkan.hpp"
+#include <map>
 #include <memory>
 #include <vector>
 
 namespace Assets
 {
-	class Scene;
 	class UniformBuffer;
 }
 
 namespace Vulkan
 {
+	class BindlessHeap;
 	class DescriptorSetManager;
+	class Device;
 	class ImageView;
+	class PipelineCache;
 	class PipelineLayout;
-	class SwapChain;
+	class ShaderModule;
 }
 
 namespace Vulkan::RayTracing
 {
 	class DeviceProcedures;
+	class ShaderCounters;
 	class TopLevelAccelerationStructure;
 
 	class RayTracingPipeline final
@@ -29,33 +35,85 @@ namespace Vulkan::RayTracing
 
 		VULKAN_NON_COPIABLE(RayTracingPipeline)
 
+		// The bindless heap slots of the scene resources, pushed to the hit and intersection shaders (see Bindless.glsl).
+		struct SceneSlots final
+		{
+			uint32_t TextureBase;
+			uint32_t MaterialBuffer;
+
+			// Texture streaming (see Assets::TextureStreamer), TextureBase being that of the frame copy.
+			uint32_t TextureFrameOffset;
+			uint32_t TextureResidencyBuffer;
+			uint32_t TextureFeedbackBuffer;
+		};
+
+		// The inline data of the hit group record of each instance, read by the hit and intersection shaders (see HitRecord.glsl).
+		// Models with several materials still index the scene materials through their vertices.
+		struct HitRecord final
+		{
+			Assets::Material ModelMaterial;
+			VkDeviceAddress Vertices;
+			VkDeviceAddress Indices;
+			glm::vec4 Sphere;
+			uint32_t PerVertexMaterials;
+		};
+
+		// Each geometry type has one hit group per material model, followed by one for any material model (as needed
+		// by the models with several materials). Without ShaderVariant::MaterialHitGroups, they all use the latter shaders.
+		static constexpr uint32_t AnyMaterialModel = Assets::Material::NumberOfModels;
+		static constexpr uint32_t HitGroupsPerGeometry = AnyMaterialModel + 1;
+
+		static const VkShaderStageFlags SceneSlotsStages = VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR;
+
 		RayTracingPipeline(
 			const DeviceProcedures& deviceProcedures,
-			const SwapChain& swapChain,
+			const PipelineCache& pipelineCache,
 			const TopLevelAccelerationStructure& accelerationStructure,
 			const ImageView& accumulationImageView,
 			const ImageView& outputImageView,
+			const ImageView& historyImageView0,
+			const ImageView& historyImageView1,
 			const std::vector<Assets::UniformBuffer>& uniformBuffers,
-			const Assets::Scene& scene);
+			const ShaderCounters& rayCounters,
+			const ShaderCounters& costCounters,
+			const BindlessHeap& bindlessHeap);
 		~RayTracingPipeline();
 
+		// Only the size dependent descriptors need updating when the swap chain is recreated.
+		void UpdateDescriptorSets(
+			const ImageView& accumulationImageView,
+			const ImageView& outputImageView,
+			const ImageView& historyImageView0,
+			const ImageView& historyImageView1);
+
 		uint32_t RayGenShaderIndex() const { return rayGenIndex_; }
 		uint32_t MissShaderIndex() const { return missIndex_; }
-		uint32_t TriangleHitGroupIndex() const { return triangleHitGroupIndex_; }
-		uint32_t ProceduralHitGroupIndex() const { return proceduralHitGroupIndex_; }
+		uint32_t TriangleHitGroupIndex(uint32_t materialModel) const { return triangleHitGroupIndex_ + materialModel; }
+		uint32_t ProceduralHitGroupIndex(uint32_t materialModel) const { return proceduralHitGroupIndex_ + materialModel; }
+
+		// Get the pipeline for the given shader variant, compiling it on first use.
+		VkPipeline Handle(const ShaderVariant& variant);
 
 		VkDescriptorSet DescriptorSet(uint32_t index) const;
 		const class PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 
 	private:
 
-		const SwapChain& swapChain_;
+		const DeviceProcedures& deviceProcedures_;
+		const PipelineCache& pipelineCache_;
+		const class Device& device_;
 
-		VULKAN_HANDLE(VkPipeline, pipeline_)
+		std::map<ShaderVariant, VkPipeline> pipelines_;
 
 		std::unique_ptr<DescriptorSetManager> descriptorSetManager_;
 		std::unique_ptr<class PipelineLayout> pipelineLayout_;
 
+		std::unique_ptr<ShaderModule> rayGenShader_;
+		std::unique_ptr<ShaderModule> missShader_;
+		std::unique_ptr<ShaderModule> closestHitShader_;
+		std::unique_ptr<ShaderModule> proceduralClosestHitShader_;
+		std::unique_ptr<ShaderModule> proceduralIntersectionShader_;
+
 		uint32_t rayGenIndex_;
 		uint32_t missIndex_;
 		uint32_t triangleHitGroupIndex_;
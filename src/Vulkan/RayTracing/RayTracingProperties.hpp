@@ -27,11 +27,19 @@ namespace Vulkan
 			uint32_t ShaderGroupHandleCaptureReplaySize() const { return pipelineProps_.shaderGroupHandleCaptureReplaySize; }
 			uint32_t ShaderGroupHandleSize() const { return pipelineProps_.shaderGroupHandleSize; }
 
+			bool SupportsSubgroupOperations(VkSubgroupFeatureFlags operations, VkShaderStageFlags stages) const
+			{
+				return
+					(subgroupProps_.supportedOperations & operations) == operations &&
+					(subgroupProps_.supportedStages & stages) == stages;
+			}
+
 		private:
 
 			const class Device& device_;
 			VkPhysicalDeviceAccelerationStructurePropertiesKHR accelProps_{};
 			VkPhysicalDeviceRayTracingPipelinePropertiesKHR pipelineProps_{};
+			VkPhysicalDeviceSubgroupProperties subgroupProps_{};
 		};
 	}
 }
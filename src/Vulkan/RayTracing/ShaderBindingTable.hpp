@@ -16,7 +16,6 @@ namespace Vulkan
 namespace Vulkan::RayTracing
 {
 	class DeviceProcedures;
-	class RayTracingPipeline;
 	class RayTracingProperties;
 	
 	class ShaderBindingTable final
@@ -33,7 +32,7 @@ namespace Vulkan::RayTracing
 
 		ShaderBindingTable(
 			const DeviceProcedures& deviceProcedures,
-			const RayTracingPipeline& rayTracingPipeline,
+			VkPipeline pipeline,
 			const RayTracingProperties& rayTracingProperties,
 			const std::vector<Entry>& rayGenPrograms,
 			const std::vector<Entry>& missPrograms,
@@ -0,0 +1,90 @@
+#include "ShaderCounters.hpp"
+#include "Vulkan/Buffer.hpp"
+
+namespace Vulkan::RayTracing {
+
+ShaderCounters::ShaderCounters(const Device& device, const size_t size, const uint32_t framesInFlight) :
+	size_(size)
+{
+	// Device-local, the atomics would otherwise cross the bus.
+	buffer_.reset(new class Buffer(device, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT));
+	bufferMemory_.reset(new DeviceMemory(buffer_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+
+	for (uint32_t i = 0; i != framesInFlight; ++i)
+	{
+		readbackBuffers_.emplace_back(new class Buffer(device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT));
+		readbackBufferMemories_.emplace_back(new DeviceMemory(readbackBuffers_.back()->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+		readbackData_.push_back(readbackBufferMemories_.back()->Map(0, size));
+	}
+
+	readbackWritten_.assign(framesInFlight, false);
+}
+
+ShaderCounters::~ShaderCounters()
+{
+	for (auto& memory : readbackBufferMemories_)
+	{
+		memory->Unmap();
+	}
+
+	readbackData_.clear();
+	readbackBuffers_.clear();
+	readbackBufferMemories_.clear(); // release memory after bound buffer has been destroyed
+	buffer_.reset();
+	bufferMemory_.reset();
+}
+
+void ShaderCounters::RecordReset(VkCommandBuffer commandBuffer)
+{
+	// The buffer is shared by the frames in flight, wait for the previous frame trace and copy to complete.
+	VkMemoryBarrier memoryBarrier = {};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+	vkCmdFillBuffer(commandBuffer, buffer_->Handle(), 0, VK_WHOLE_SIZE, 0);
+
+	memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+}
+
+void ShaderCounters::RecordReadback(VkCommandBuffer commandBuffer, const uint32_t frameIndex)
+{
+	VkMemoryBarrier memoryBarrier = {};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+	VkBufferCopy region = {};
+	region.size = size_;
+
+	vkCmdCopyBuffer(commandBuffer, buffer_->Handle(), readbackBuffers_[frameIndex]->Handle(), 1, &region);
+
+	// Make the copy visible to the host once the frame fence is signaled.
+	memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+	readbackWritten_[frameIndex] = true;
+}
+
+const void* ShaderCounters::Read(const uint32_t frameIndex)
+{
+	if (!readbackWritten_[frameIndex])
+	{
+		return nullptr;
+	}
+
+	readbackWritten_[frameIndex] = false;
+
+	return readbackData_[frameIndex];
+}
+
+}
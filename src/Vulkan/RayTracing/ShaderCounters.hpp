@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Vulkan/Vulkan.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Vulkan
+{
+	class Buffer;
+	class Device;
+	class DeviceMemory;
+}
+
+namespace Vulkan::RayTracing
+{
+	// Per frame totals counted by the ray tracing shaders, laid out as in RayCounters.glsl
+	// (where each counter is a pair of low and high 32-bit words, i.e. a little-endian 64-bit integer).
+	struct RayStatistics final
+	{
+		uint64_t PrimaryRays;
+		uint64_t SecondaryRays;
+		uint64_t Intersections; // Procedural intersection shader invocations.
+
+		// Path terminations by reason.
+		uint64_t Misses;
+		uint64_t Emissions;
+		uint64_t Absorptions;
+		uint64_t BounceLimits;
+
+		uint64_t TracedRays() const { return PrimaryRays + SecondaryRays; }
+	};
+
+	// Per frame cost of the hit and intersection shaders, laid out as in CostCounters.glsl.
+	// The buffer holds one bucket per material model followed by one bucket per instance.
+	// The clocks are split in two words as the shaders only use 32-bit atomics (no shaderBufferInt64Atomics).
+	struct CostBucket final
+	{
+		uint32_t ClocksLow;
+		uint32_t ClocksHigh;
+		uint32_t Hits;
+		uint32_t Intersections;
+
+		uint64_t Clocks() const { return static_cast<uint64_t>(ClocksHigh) << 32 | ClocksLow; }
+	};
+
+	// A small device-local storage buffer the shaders add to atomically, copied after each trace into
+	// a host-visible buffer per frame in flight. The totals are read once the frame fence has been signaled,
+	// which never stalls the CPU.
+	class ShaderCounters final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(ShaderCounters)
+
+		ShaderCounters(const Device& device, size_t size, uint32_t framesInFlight);
+		~ShaderCounters();
+
+		const class Buffer& Buffer() const { return *buffer_; }
+
+		// Clear the counters before the trace.
+		void RecordReset(VkCommandBuffer commandBuffer);
+
+		// Copy the counters for the host after the trace.
+		void RecordReadback(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+		// The counters of the previous use of the frame slot, nullptr if it did not record them.
+		// Only valid once the frame fence has been signaled.
+		const void* Read(uint32_t frameIndex);
+
+	private:
+
+		const size_t size_;
+
+		std::unique_ptr<class Buffer> buffer_;
+		std::unique_ptr<DeviceMemory> bufferMemory_;
+
+		std::vector<std::unique_ptr<class Buffer>> readbackBuffers_;
+		std::vector<std::unique_ptr<DeviceMemory>> readbackBufferMemories_;
+		std::vector<const void*> readbackData_; // Persistently mapped, host coherent.
+		std::vector<bool> readbackWritten_;
+	};
+
+}
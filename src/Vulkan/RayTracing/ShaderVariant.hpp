@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+
+namespace Vulkan::RayTracing
+{
+	// Features baked into the ray tracing shaders as specialization constants (see Specialization.glsl).
+	// Each combination results in a separate pipeline, compiled on first use.
+	struct ShaderVariant final
+	{
+		bool ShowHeatmap;
+		bool HasSky;
+		bool HasTextures;
+		uint32_t NumberOfBounces;
+		bool CountRays;
+		bool ProfileCosts;
+		bool MaterialHitGroups; // One closest-hit shader per material model, rather than a single switching one.
+
+		bool operator < (const ShaderVariant& other) const
+		{
+			return 
+				std::tie(ShowHeatmap, HasSky, HasTextures, NumberOfBounces, CountRays, ProfileCosts, MaterialHitGroups) < 
+				std::tie(other.ShowHeatmap, other.HasSky, other.HasTextures, other.NumberOfBounces, other.CountRays, other.ProfileCosts, other.MaterialHitGroups);
+		}
+	};
+
+}
@@ -0,0 +1,120 @@
+#include "UpscalePipeline.hpp"
+#include "Vulkan/Device.hpp"
+#include "Vulkan/DescriptorBinding.hpp"
+#include "Vulkan/DescriptorSetManager.hpp"
+#include "Vulkan/DescriptorSets.hpp"
+#include "Vulkan/ImageView.hpp"
+#include "Vulkan/PipelineCache.hpp"
+#include "Vulkan/PipelineLayout.hpp"
+#include "Vulkan/Sampler.hpp"
+#include "Vulkan/ShaderModule.hpp"
+
+namespace Vulkan::RayTracing {
+
+namespace
+{
+	// Must match the push constants of Upscale.comp.
+	struct UpscaleParameters
+	{
+		uint32_t InputWidth;
+		uint32_t InputHeight;
+		uint32_t OutputWidth;
+		uint32_t OutputHeight;
+		float Sharpness;
+	};
+
+	// Must match the workgroup size of Upscale.comp.
+	const uint32_t GroupSize = 8;
+}
+
+UpscalePipeline::UpscalePipeline(const PipelineCache& pipelineCache, const ImageView& inputImageView, const ImageView& outputImageView) :
+	device_(pipelineCache.Device())
+{
+	const std::vector<DescriptorBinding> descriptorBindings =
+	{
+		// Ray traced output image & upscaled image
+		{0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT},
+		{1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT}
+	};
+
+	descriptorSetManager_.reset(new DescriptorSetManager(device_, descriptorBindings, 1));
+
+	// The shader fetches the texels directly, the sampler is only there to complete the descriptor.
+	SamplerConfig samplerConfig;
+	samplerConfig.MagFilter = VK_FILTER_NEAREST;
+	samplerConfig.MinFilter = VK_FILTER_NEAREST;
+	samplerConfig.AnisotropyEnable = false;
+	samplerConfig.MaxAnisotropy = 1;
+	samplerConfig.MipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+
+	sampler_.reset(new Sampler(device_, samplerConfig));
+
+	UpdateDescriptorSets(inputImageView, outputImageView);
+
+	VkPushConstantRange pushConstantRange = {};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(UpscaleParameters);
+
+	pipelineLayout_.reset(new class PipelineLayout(device_, descriptorSetManager_->DescriptorSetLayout(), { pushConstantRange }));
+
+	const ShaderModule computeShader(device_, "../assets/shaders/Upscale.comp.spv");
+
+	VkComputePipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage = computeShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT);
+	pipelineInfo.layout = pipelineLayout_->Handle();
+	pipelineInfo.basePipelineHandle = nullptr;
+	pipelineInfo.basePipelineIndex = -1;
+
+	Check(vkCreateComputePipelines(device_.Handle(), pipelineCache.Handle(), 1, &pipelineInfo, nullptr, &pipeline_),
+		"create upscale pipeline");
+}
+
+UpscalePipeline::~UpscalePipeline()
+{
+	if (pipeline_ != nullptr)
+	{
+		vkDestroyPipeline(device_.Handle(), pipeline_, nullptr);
+		pipeline_ = nullptr;
+	}
+
+	pipelineLayout_.reset();
+	sampler_.reset();
+	descriptorSetManager_.reset();
+}
+
+void UpscalePipeline::UpdateDescriptorSets(const ImageView& inputImageView, const ImageView& outputImageView)
+{
+	auto& descriptorSets = descriptorSetManager_->DescriptorSets();
+
+	VkDescriptorImageInfo inputImageInfo = {};
+	inputImageInfo.imageView = inputImageView.Handle();
+	inputImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	inputImageInfo.sampler = sampler_->Handle();
+
+	VkDescriptorImageInfo outputImageInfo = {};
+	outputImageInfo.imageView = outputImageView.Handle();
+	outputImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+	const std::vector<VkWriteDescriptorSet> descriptorWrites =
+	{
+		descriptorSets.Bind(0, 0, inputImageInfo),
+		descriptorSets.Bind(0, 1, outputImageInfo)
+	};
+
+	descriptorSets.UpdateDescriptors(0, descriptorWrites);
+}
+
+void UpscalePipeline::Record(VkCommandBuffer commandBuffer, const VkExtent2D inputExtent, const VkExtent2D outputExtent, const float sharpness) const
+{
+	const UpscaleParameters parameters = { inputExtent.width, inputExtent.height, outputExtent.width, outputExtent.height, sharpness };
+	VkDescriptorSet descriptorSets[] = { descriptorSetManager_->DescriptorSets().Handle(0) };
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout_->Handle(), 0, 1, descriptorSets, 0, nullptr);
+	vkCmdPushConstants(commandBuffer, pipelineLayout_->Handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(parameters), &parameters);
+	vkCmdDispatch(commandBuffer, (outputExtent.width + GroupSize - 1) / GroupSize, (outputExtent.height + GroupSize - 1) / GroupSize, 1);
+}
+
+}
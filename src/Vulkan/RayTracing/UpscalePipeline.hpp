@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Vulkan/Vulkan.hpp"
+#include <memory>
+
+namespace Vulkan
+{
+	class DescriptorSetManager;
+	class Device;
+	class ImageView;
+	class PipelineCache;
+	class PipelineLayout;
+	class Sampler;
+}
+
+namespace Vulkan::RayTracing
+{
+	// Compute pass upscaling the ray traced output, rendered at a fraction of the swap chain resolution,
+	// onto a swap chain sized image (see Upscale.comp).
+	class UpscalePipeline final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(UpscalePipeline)
+
+		UpscalePipeline(const PipelineCache& pipelineCache, const ImageView& inputImageView, const ImageView& outputImageView);
+		~UpscalePipeline();
+
+		// Only the size dependent descriptors need updating when the swap chain is recreated.
+		void UpdateDescriptorSets(const ImageView& inputImageView, const ImageView& outputImageView);
+
+		// Upscale the top-left input extent of the input image onto the output extent. The input image must be
+		// in the shader read-only layout, the output image in the general layout.
+		void Record(VkCommandBuffer commandBuffer, VkExtent2D inputExtent, VkExtent2D outputExtent, float sharpness) const;
+
+	private:
+
+		const class Device& device_;
+
+		std::unique_ptr<DescriptorSetManager> descriptorSetManager_;
+		std::unique_ptr<class PipelineLayout> pipelineLayout_;
+		std::unique_ptr<Sampler> sampler_;
+
+		VULKAN_HANDLE(VkPipeline, pipeline_)
+	};
+
+}
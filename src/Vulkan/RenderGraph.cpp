@@ -0,0 +1,347 @@
+#include "RenderGraph.hpp"
+#include "Device.hpp"
+#include "DeviceMemory.hpp"
+#include "Image.hpp"
+#include "ImageView.hpp"
+#include "Utilities/Exception.hpp"
+#include <algorithm>
+
+namespace Vulkan {
+
+namespace
+{
+	const VkAccessFlags WriteAccesses = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+	struct UsageState final
+	{
+		VkImageLayout Layout;
+		VkAccessFlags Access;
+	};
+
+	UsageState GetUsageState(const RenderGraph::Usage usage)
+	{
+		switch (usage)
+		{
+		case RenderGraph::Usage::StorageRead: return { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_READ_BIT };
+		case RenderGraph::Usage::StorageWrite: return { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT };
+		case RenderGraph::Usage::StorageReadWrite: return { VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT };
+		case RenderGraph::Usage::Sampled: return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT };
+		case RenderGraph::Usage::TransferSrc: return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT };
+		case RenderGraph::Usage::TransferDst: return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT };
+		case RenderGraph::Usage::Present: return { VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 0 };
+		}
+
+		Throw(std::invalid_argument("unknown render graph usage"));
+	}
+
+	VkDeviceSize AlignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+RenderGraph::RenderGraph(const class Device& device) :
+	device_(device)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+	// The transient images go before their memory.
+	passes_.clear();
+	resources_.clear();
+	transientMemory_.reset();
+}
+
+RenderGraph::ResourceId RenderGraph::ImportImage(const char* const name, const VkImage image, const VkImageLayout layout)
+{
+	Resource resource;
+	resource.Name = name;
+	resource.Image = image;
+	resource.Layout = layout;
+	resource.Stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+	resources_.push_back(std::move(resource));
+
+	return static_cast<ResourceId>(resources_.size() - 1);
+}
+
+void RenderGraph::SetImage(const ResourceId id, const VkImage image)
+{
+	auto& resource = resources_.at(id);
+
+	if (resource.Transient)
+	{
+		Throw(std::invalid_argument("cannot set the image of transient render graph resource '" + resource.Name + "'"));
+	}
+
+	resource.Image = image;
+	resource.Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	resource.Stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	resource.Accesses = 0;
+}
+
+RenderGraph::ResourceId RenderGraph::CreateImage(const char* const name, const VkExtent2D extent, const VkFormat format, const VkImageUsageFlags usage)
+{
+	Resource resource;
+	resource.Name = name;
+	resource.Transient = true;
+	resource.Extent = extent;
+	resource.Format = format;
+	resource.UsageFlags = usage;
+
+	resources_.push_back(std::move(resource));
+
+	return static_cast<ResourceId>(resources_.size() - 1);
+}
+
+VkImage RenderGraph::GetImage(const ResourceId id) const
+{
+	return resources_.at(id).Image;
+}
+
+const ImageView& RenderGraph::GetImageView(const ResourceId id) const
+{
+	const auto& resource = resources_.at(id);
+
+	if (!resource.View)
+	{
+		Throw(std::invalid_argument("render graph resource '" + resource.Name + "' has no image view (not a compiled transient image)"));
+	}
+
+	return *resource.View;
+}
+
+void RenderGraph::AddPass(
+	const char* const name,
+	const VkPipelineStageFlags stages,
+	const std::vector<ImageUse>& uses,
+	const std::function<bool()>& enabled,
+	const std::function<void(VkCommandBuffer, uint32_t)>& record)
+{
+	for (const auto& use : uses)
+	{
+		if (use.Image >= resources_.size())
+		{
+			Throw(std::invalid_argument(std::string("render graph pass '") + name + "' uses an unknown resource"));
+		}
+	}
+
+	passes_.push_back({ name, stages, uses, enabled, record });
+}
+
+void RenderGraph::Compile()
+{
+	if (transientMemory_)
+	{
+		Throw(std::logic_error("render graph has already been compiled"));
+	}
+
+	struct Allocation final
+	{
+		ResourceId Id;
+		size_t FirstPass;
+		size_t LastPass;
+		VkMemoryRequirements Requirements;
+		VkDeviceSize Offset;
+	};
+
+	std::vector<Allocation> allocations;
+
+	for (ResourceId id = 0; id != resources_.size(); ++id)
+	{
+		auto& resource = resources_[id];
+
+		if (!resource.Transient)
+		{
+			continue;
+		}
+
+		resource.Owned.reset(new class Image(device_, resource.Extent, resource.Format, VK_IMAGE_TILING_OPTIMAL, resource.UsageFlags));
+		resource.Image = resource.Owned->Handle();
+
+		// The passes between the first and last use, whether enabled or not in a given frame.
+		Allocation allocation{ id, passes_.size(), 0, resource.Owned->GetMemoryRequirements(), 0 };
+
+		for (size_t i = 0; i != passes_.size(); ++i)
+		{
+			for (const auto& use : passes_[i].Uses)
+			{
+				if (use.Image == id)
+				{
+					allocation.FirstPass = std::min(allocation.FirstPass, i);
+					allocation.LastPass = std::max(allocation.LastPass, i);
+				}
+			}
+		}
+
+		if (allocation.FirstPass > allocation.LastPass)
+		{
+			allocation.FirstPass = allocation.LastPass = 0;
+		}
+
+		allocations.push_back(allocation);
+	}
+
+	if (allocations.empty())
+	{
+		return;
+	}
+
+	// Largest first, each image goes at the lowest offset not overlapping the images alive during any of its passes.
+	std::sort(allocations.begin(), allocations.end(), [](const Allocation& lhs, const Allocation& rhs)
+	{
+		return lhs.Requirements.size > rhs.Requirements.size;
+	});
+
+	VkDeviceSize memorySize = 0;
+	uint32_t memoryTypeBits = ~0u;
+
+	for (size_t i = 0; i != allocations.size(); ++i)
+	{
+		auto& allocation = allocations[i];
+
+		for (bool moved = true; moved; )
+		{
+			moved = false;
+
+			for (size_t j = 0; j != i; ++j)
+			{
+				const auto& other = allocations[j];
+				const bool alive = allocation.FirstPass <= other.LastPass && other.FirstPass <= allocation.LastPass;
+				const bool overlaps = allocation.Offset < other.Offset + other.Requirements.size && other.Offset < allocation.Offset + allocation.Requirements.size;
+
+				if (alive && overlaps)
+				{
+					allocation.Offset = AlignUp(other.Offset + other.Requirements.size, allocation.Requirements.alignment);
+					moved = true;
+				}
+			}
+		}
+
+		memorySize = std::max(memorySize, allocation.Offset + allocation.Requirements.size);
+		memoryTypeBits &= allocation.Requirements.memoryTypeBits;
+	}
+
+	transientMemory_.reset(new DeviceMemory(device_, memorySize, memoryTypeBits, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+
+	const auto& debugUtils = device_.DebugUtils();
+
+	debugUtils.SetObjectName(transientMemory_->Handle(), "Render Graph Transient Memory");
+
+	for (const auto& allocation : allocations)
+	{
+		auto& resource = resources_[allocation.Id];
+
+		resource.Owned->BindMemory(*transientMemory_, allocation.Offset);
+		resource.View.reset(new ImageView(device_, resource.Image, resource.Format, VK_IMAGE_ASPECT_COLOR_BIT));
+
+		debugUtils.SetObjectName(resource.Image, (resource.Name + " Image").c_str());
+		debugUtils.SetObjectName(resource.View->Handle(), (resource.Name + " ImageView").c_str());
+	}
+}
+
+void RenderGraph::Execute(VkCommandBuffer commandBuffer, const uint32_t frameIndex)
+{
+	// Transient images start undefined every frame, once whatever last used their memory (e.g. the previous frame,
+	// or another image aliasing it) is done with it.
+	for (auto& resource : resources_)
+	{
+		if (resource.Transient)
+		{
+			resource.Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			resource.Stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			resource.Accesses = VK_ACCESS_MEMORY_WRITE_BIT;
+		}
+	}
+
+	std::vector<VkImageMemoryBarrier> barriers;
+
+	for (const auto& pass : passes_)
+	{
+		if (pass.Enabled && !pass.Enabled())
+		{
+			continue;
+		}
+
+		VkPipelineStageFlags srcStages = 0;
+		VkPipelineStageFlags dstStages = 0;
+		barriers.clear();
+
+		for (const auto& use : pass.Uses)
+		{
+			AddBarrier(resources_[use.Image], use.Access, pass.Stages, barriers, srcStages, dstStages);
+		}
+
+		if (!barriers.empty())
+		{
+			vkCmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+		}
+
+		if (pass.Record)
+		{
+			pass.Record(commandBuffer, frameIndex);
+		}
+	}
+}
+
+void RenderGraph::Use(VkCommandBuffer commandBuffer, const ResourceId id, const Usage usage, const VkPipelineStageFlags stages)
+{
+	VkPipelineStageFlags srcStages = 0;
+	VkPipelineStageFlags dstStages = 0;
+	std::vector<VkImageMemoryBarrier> barriers;
+
+	AddBarrier(resources_.at(id), usage, stages, barriers, srcStages, dstStages);
+
+	if (!barriers.empty())
+	{
+		vkCmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+	}
+}
+
+void RenderGraph::AddBarrier(
+	Resource& resource,
+	const Usage usage,
+	const VkPipelineStageFlags stages,
+	std::vector<VkImageMemoryBarrier>& barriers,
+	VkPipelineStageFlags& srcStages,
+	VkPipelineStageFlags& dstStages) const
+{
+	const auto state = GetUsageState(usage);
+	const bool writes = (state.Access & WriteAccesses) != 0;
+	const bool pendingWrites = (resource.Accesses & WriteAccesses) != 0;
+
+	// Reads following reads in the same layout need no barrier, but a later write has to wait for all of them.
+	if (resource.Layout == state.Layout && !writes && !pendingWrites)
+	{
+		resource.Stages |= stages;
+		resource.Accesses |= state.Access;
+		return;
+	}
+
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = resource.Accesses & WriteAccesses;
+	barrier.dstAccessMask = state.Access;
+	barrier.oldLayout = resource.Layout;
+	barrier.newLayout = state.Layout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = resource.Image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	barriers.push_back(barrier);
+
+	srcStages |= resource.Stages != 0 ? resource.Stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+	dstStages |= stages;
+
+	resource.Layout = state.Layout;
+	resource.Stages = stages;
+	resource.Accesses = state.Access;
+}
+
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Vulkan
+{
+	class Device;
+	class DeviceMemory;
+	class Image;
+	class ImageView;
+
+	// The passes of a frame, declared once with the images they read and write. Each image state (layout, last stages
+	// and accesses) is tracked across passes and frames, so that the barriers are derived rather than hand-written:
+	// only where the layout changes or a hazard exists, and batched into a single pipeline barrier per pass.
+	// Imported images are owned elsewhere and keep their content across frames. Transient images are owned by the
+	// graph and only live within a frame; those whose pass lifetimes do not overlap share the same memory.
+	// Passes can be disabled per frame (e.g. the trace once converged), their images then keep their previous state.
+	class RenderGraph final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(RenderGraph)
+
+		typedef uint32_t ResourceId;
+
+		enum class Usage
+		{
+			StorageRead,
+			StorageWrite,
+			StorageReadWrite,
+			Sampled,
+			TransferSrc,
+			TransferDst,
+			Present
+		};
+
+		struct ImageUse final
+		{
+			ResourceId Image;
+			Usage Access;
+		};
+
+		explicit RenderGraph(const Device& device);
+		~RenderGraph();
+
+		const class Device& Device() const { return device_; }
+
+		// An image whose content outlives the frame, tracked from the given layout.
+		ResourceId ImportImage(const char* name, VkImage image, VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+		// Point an imported image to another one (e.g. the acquired swap-chain image), whose content is then undefined.
+		void SetImage(ResourceId id, VkImage image);
+
+		// An image only used within a frame, created by Compile().
+		ResourceId CreateImage(const char* name, VkExtent2D extent, VkFormat format, VkImageUsageFlags usage);
+
+		VkImage GetImage(ResourceId id) const;
+		const ImageView& GetImageView(ResourceId id) const;
+
+		// The stages are those in which the pass accesses its images (e.g. compute shader, transfer).
+		void AddPass(
+			const char* name,
+			VkPipelineStageFlags stages,
+			const std::vector<ImageUse>& uses,
+			const std::function<bool()>& enabled,
+			const std::function<void(VkCommandBuffer, uint32_t)>& record);
+
+		// Allocate the transient images, once all the passes are declared.
+		void Compile();
+
+		// Record the enabled passes, in declaration order, each one preceded by the barriers its images need.
+		void Execute(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+		// Record the barrier needed to access an image outside of the passes (e.g. a readback following Execute()).
+		void Use(VkCommandBuffer commandBuffer, ResourceId id, Usage usage, VkPipelineStageFlags stages);
+
+	private:
+
+		struct Resource final
+		{
+			std::string Name;
+			VkImage Image{};
+
+			// Transient images only.
+			bool Transient{};
+			VkExtent2D Extent{};
+			VkFormat Format{};
+			VkImageUsageFlags UsageFlags{};
+			std::unique_ptr<class Image> Owned;
+			std::unique_ptr<ImageView> View; // Destroyed before its image.
+
+			// The state following the last recorded access.
+			VkImageLayout Layout{};
+			VkPipelineStageFlags Stages{};
+			VkAccessFlags Accesses{};
+		};
+
+		struct Pass final
+		{
+			std::string Name;
+			VkPipelineStageFlags Stages;
+			std::vector<ImageUse> Uses;
+			std::function<bool()> Enabled;
+			std::function<void(VkCommandBuffer, uint32_t)> Record;
+		};
+
+		void AddBarrier(Resource& resource, Usage usage, VkPipelineStageFlags stages,
+			std::vector<VkImageMemoryBarrier>& barriers, VkPipelineStageFlags& srcStages, VkPipelineStageFlags& dstStages) const;
+
+		const class Device& device_;
+
+		std::vector<Resource> resources_;
+		std::vector<Pass> passes_;
+		std::unique_ptr<DeviceMemory> transientMemory_;
+	};
+
+}
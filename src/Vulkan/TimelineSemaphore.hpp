@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+namespace Vulkan
+{
+	class Device;
+
+	// A semaphore holding a monotonically increasing 64-bit value (Vulkan 1.2 core), which queue submissions
+	// signal and wait for. Unlike binary semaphores, the host can also query and wait for its value.
+	class TimelineSemaphore final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(TimelineSemaphore)
+
+		TimelineSemaphore(const Device& device, uint64_t initialValue);
+		~TimelineSemaphore();
+
+		const class Device& Device() const { return device_; }
+
+		// The value of the last completed signal operation.
+		uint64_t Value() const;
+
+		// Block until the semaphore reaches the given value.
+		void Wait(uint64_t value) const;
+
+	private:
+
+		const class Device& device_;
+
+		VULKAN_HANDLE(VkSemaphore, semaphore_)
+	};
+
+}
@@ -166,7 +166,14 @@ void Window::Run()
 
 	while (!glfwWindowShouldClose(window_))
 	{
-		glfwPollEvents();
+		if (IsIdle && IsIdle())
+		{
+			glfwWaitEvents();
+		}
+		else
+		{
+			glfwPollEvents();
+		}
 
 		if (DrawFrame)
 		{
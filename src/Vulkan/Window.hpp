@@ -31,6 +31,7 @@ namespace Vulkan
 
 		// Callbacks
 		std::function<void()> DrawFrame;
+		std::function<bool()> IsIdle; // Wait for the next event rather than polling them before drawing a frame.
 		std::function<void(int key, int scancode, int action, int mods)> OnKey;
 		std::function<void(double xpos, double ypos)> OnCursorPosition;
 		std::function<void(int button, int action, int mods)> OnMouseButton;
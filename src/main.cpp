@@ -5,6 +5,7 @@
 #include "Vulkan/Version.hpp"
 #include "Utilities/Console.hpp"
 #include "Utilities/Exception.hpp"
+#include "Utilities/Tracer.hpp"
 #include "Options.hpp"
 #include "RayTracer.hpp"
 
@@ -28,6 +29,16 @@ int main(int argc, const char* argv[]) noexcept
 	try
 	{
 		const Options options(argc, argv);
+
+		// Keep stdout clean for the raw video frames.
+		if (options.ExportVideo == "-")
+		{
+			std::cout.rdbuf(std::cerr.rdbuf());
+		}
+
+		// Outlives the application, so that its destruction is traced too.
+		const Utilities::Tracer tracer(options.TraceFile);
+
 		const UserSettings userSettings = CreateUserSettings(options);
 		const Vulkan::WindowConfig windowConfig
 		{
@@ -39,7 +50,7 @@ int main(int argc, const char* argv[]) noexcept
 			!options.Fullscreen
 		};
 
-		RayTracer application(userSettings, windowConfig, static_cast<VkPresentModeKHR>(options.PresentMode));
+		RayTracer application(userSettings, windowConfig, static_cast<VkPresentModeKHR>(options.PresentMode), options.FramesInFlight);
 
 		PrintVulkanSdkInformation();
 		PrintVulkanInstanceInformation(application, options.Benchmark);
@@ -94,8 +105,13 @@ namespace
 		UserSettings userSettings{};
 
 		userSettings.Benchmark = options.Benchmark;
+		userSettings.PipelineCache = options.PipelineCache;
 		userSettings.BenchmarkNextScenes = options.BenchmarkNextScenes;
 		userSettings.BenchmarkMaxTime = options.BenchmarkMaxTime;
+		userSettings.BenchmarkFlythrough = options.BenchmarkMode == "flythrough";
+		userSettings.BenchmarkSweep = options.BenchmarkSweep;
+		userSettings.BenchmarkBaseline = options.BenchmarkBaseline;
+		userSettings.BenchmarkResults = options.BenchmarkResults;
 		
 		userSettings.SceneIndex = options.SceneIndex;
 
@@ -104,12 +120,37 @@ namespace
 		userSettings.NumberOfSamples = options.Samples;
 		userSettings.NumberOfBounces = options.Bounces;
 		userSettings.MaxNumberOfSamples = options.MaxSamples;
-
-		userSettings.ShowSettings = !options.Benchmark;
+		userSettings.RenderScale = options.RenderScale;
+		userSettings.AdaptiveSamples = options.TargetFrameTime > 0;
+		userSettings.TargetFrameTime = options.TargetFrameTime > 0 ? options.TargetFrameTime : 16.6f;
+		userSettings.InterleavedTracing = options.Interleave == "checkerboard" ? 1 : options.Interleave == "2x2" ? 2 : 0;
+
+		userSettings.RenderOutput = options.RenderOutput;
+		userSettings.RenderWidth = options.RenderWidth;
+		userSettings.RenderHeight = options.RenderHeight;
+		userSettings.TileSize = options.TileSize;
+
+		userSettings.CaptureAtSamples = options.CaptureAtSamples;
+		userSettings.CaptureEvery = options.CaptureEvery;
+		userSettings.CapturePrefix = options.CapturePrefix;
+
+		userSettings.CameraPath = options.CameraPath;
+		userSettings.ExportVideo = options.ExportVideo;
+		userSettings.ExportFramesPerSecond = options.ExportFramesPerSecond;
+
+		userSettings.RegressionTest = options.RegressionTest;
+		userSettings.RegressionUpdate = options.RegressionUpdate;
+		userSettings.RegressionSamples = options.RegressionSamples;
+		userSettings.RegressionWidth = options.RegressionWidth;
+		userSettings.RegressionHeight = options.RegressionHeight;
+
+		userSettings.ShowSettings = !options.Benchmark && options.RegressionTest.empty() && options.RenderOutput.empty() && options.CameraPath.empty();
 		userSettings.ShowOverlay = true;
 
 		userSettings.ShowHeatmap = false;
 		userSettings.HeatmapScale = 1.5f;
+		userSettings.ProfileCosts = options.ProfileCosts;
+		userSettings.MaterialHitGroups = !options.Megashader;
 
 		return userSettings;
 	}